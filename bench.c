@@ -0,0 +1,261 @@
+/**
+ * Benchmark driver for C Long Arithmetic Library
+ * Times each operation over a range of operand sizes and, where Linux perf counters
+ * are available, reports cycles, instructions, branch misses and cache misses per limb
+ *
+ * Usage: bench [operation...]   (default: all operations)
+ */
+
+#define _GNU_SOURCE
+
+#include "superlong.h"
+#include "superlong-series.h"
+#include "superlong-mod.h"
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Hardware counters, each opened on its own so a missing one does not disable the rest
+enum { CTR_CYCLES, CTR_INSTRUCTIONS, CTR_BRANCH_MISSES, CTR_L1D_MISSES, CTR_LLC_MISSES, CTR_COUNT };
+
+static const char* const counter_names[CTR_COUNT] = {"cycles", "instr", "br-miss", "L1d-miss", "LLC-miss"};
+
+static int counter_fds[CTR_COUNT];
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static int counters_open(void) {
+    const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const uint64_t llc_read_miss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    counter_fds[CTR_CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    counter_fds[CTR_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    counter_fds[CTR_BRANCH_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    counter_fds[CTR_L1D_MISSES] = open_counter(PERF_TYPE_HW_CACHE, l1d_read_miss);
+    counter_fds[CTR_LLC_MISSES] = open_counter(PERF_TYPE_HW_CACHE, llc_read_miss);
+
+    int available = 0;
+    for (int i = 0; i < CTR_COUNT; i++)
+        available += (counter_fds[i] >= 0);
+    return available;
+}
+
+static void counters_close(void) {
+    for (int i = 0; i < CTR_COUNT; i++)
+        if (counter_fds[i] >= 0)
+            close(counter_fds[i]);
+}
+
+static void counters_start(void) {
+    for (int i = 0; i < CTR_COUNT; i++) {
+        if (counter_fds[i] >= 0) {
+            ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+// unavailable counters read as -1
+static void counters_stop(int64_t values[CTR_COUNT]) {
+    for (int i = 0; i < CTR_COUNT; i++) {
+        uint64_t value;
+        values[i] = -1;
+        if (counter_fds[i] < 0)
+            continue;
+        ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter_fds[i], &value, sizeof(value)) == sizeof(value))
+            values[i] = (int64_t) value;
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// Operands
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// random number of exactly limbs digits
+static void random_superlong(superlong* res, size_t limbs) {
+    n256* buf = malloc(limbs);
+    for (size_t i = 0; i < limbs; i++)
+        buf[i] = (n256) rng_next();
+    buf[limbs - 1] |= 0x80;
+    superlong_import(res, limbs, -1, 1, 0, buf);
+    free(buf);
+}
+
+typedef struct {
+    superlong a, b, res;
+    char* str;
+    size_t limbs;
+} bench_state;
+
+static void run_add(bench_state* s) { superlong_add(&s->a, &s->b, &s->res); }
+static void run_mul(bench_state* s) { superlong_mul(&s->a, &s->b, &s->res); }
+static void run_sqr(bench_state* s) { superlong_mul(&s->a, &s->a, &s->res); }
+static void run_div(bench_state* s) { superlong_div(&s->res, &s->a, &s->b); }
+static void run_div_uint(bench_state* s) { superlong_div_uint(&s->a, 1000000007u, &s->res); }
+static void run_to_dec(bench_state* s) { free(superlong_to_str(&s->a, 10)); }
+static void run_to_hex(bench_state* s) { free(superlong_to_str(&s->a, 16)); }
+static void run_from_dec(bench_state* s) { superlong_from_str(&s->res, s->str, 10); }
+
+// end-to-end workloads: a result of `limbs` digits, about 2.4 decimal digits each, printed in decimal
+static void run_pi(bench_state* s) {
+    superlong_const_pi(s->limbs * 12 / 5, &s->res);
+    free(superlong_to_str(&s->res, 10));
+}
+static void run_e(bench_state* s) {
+    superlong_const_e(s->limbs * 12 / 5, &s->res);
+    free(superlong_to_str(&s->res, 10));
+}
+
+// b^b mod a for an odd a, and the next prime after a (a sieved window plus Baillie-PSW per survivor)
+static void run_powmod(bench_state* s) { superlong_powmod(&s->b, &s->b, &s->a, &s->res); }
+static void run_nextprime(bench_state* s) { superlong_nextprime(&s->a, &s->res); }
+
+typedef struct {
+    const char* name;
+    void (*run)(bench_state*);
+    size_t max_limbs; // quadratic kernels stop early
+} bench_op;
+
+static const bench_op ops[] = {
+    {"add", run_add, 1 << 20},
+    {"mul", run_mul, 4096},
+    {"sqr", run_sqr, 4096},
+    {"div", run_div, 512},
+    {"div_uint", run_div_uint, 1 << 20},
+    {"to_str10", run_to_dec, 4096},
+    {"to_str16", run_to_hex, 1 << 20},
+    {"from_str10", run_from_dec, 4096},
+    {"pi", run_pi, 4096},
+    {"e", run_e, 4096},
+    {"powmod", run_powmod, 512},
+    {"nextprime", run_nextprime, 64},
+};
+
+static const size_t tiers[] = {8, 64, 512, 4096, 32768, 1 << 20};
+
+static void bench_prepare(bench_state* s, const bench_op* op, size_t limbs) {
+    superlong_init(&s->a);
+    superlong_init(&s->b);
+    superlong_init(&s->res);
+    random_superlong(&s->a, limbs);
+    random_superlong(&s->b, limbs);
+    s->str = NULL;
+    s->limbs = limbs;
+    if (op->run == run_div)
+        superlong_mul(&s->a, &s->b, &s->res); // 2n / n
+    if (op->run == run_powmod)
+        s->a.digits.arr[0] |= 1; // Montgomery needs an odd modulus
+    if (op->run == run_from_dec)
+        s->str = superlong_to_str(&s->a, 10);
+}
+
+static void bench_release(bench_state* s) {
+    superlong_deinit(&s->a);
+    superlong_deinit(&s->b);
+    superlong_deinit(&s->res);
+    free(s->str);
+}
+
+static void bench_one(const bench_op* op, size_t limbs, int have_counters) {
+    bench_state s;
+    bench_prepare(&s, op, limbs);
+
+    // grow the repetition count until a run takes long enough to measure
+    size_t reps = 1;
+    double elapsed;
+    for (;;) {
+        double start = now_seconds();
+        for (size_t i = 0; i < reps; i++)
+            op->run(&s);
+        elapsed = now_seconds() - start;
+        if (elapsed > 0.05 || reps >= ((size_t) 1 << 30))
+            break;
+        reps *= (elapsed < 0.005) ? 10 : 2;
+    }
+
+    int64_t values[CTR_COUNT];
+    counters_start();
+    double start = now_seconds();
+    for (size_t i = 0; i < reps; i++)
+        op->run(&s);
+    elapsed = now_seconds() - start;
+    counters_stop(values);
+
+    double per_call = elapsed / (double) reps;
+    double limbs_done = (double) reps * (double) limbs;
+    printf("%-11s %8zu %12.3f %10.3f", op->name, limbs, per_call * 1e6, elapsed * 1e9 / limbs_done);
+    if (have_counters) {
+        for (int i = 0; i < CTR_COUNT; i++) {
+            if (values[i] < 0)
+                printf(" %9s", "-");
+            else
+                printf(" %9.3f", (double) values[i] / limbs_done);
+        }
+    }
+    printf("\n");
+    bench_release(&s);
+}
+
+static int selected(const char* name, int argc, char** argv) {
+    if (argc < 2)
+        return 1;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], name) == 0)
+            return 1;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int have_counters = counters_open() > 0;
+    if (!have_counters)
+        printf("perf counters unavailable (check /proc/sys/kernel/perf_event_paranoid), reporting wall-clock only\n\n");
+
+    printf("%-11s %8s %12s %10s", "operation", "limbs", "us/call", "ns/limb");
+    if (have_counters) {
+        for (int i = 0; i < CTR_COUNT; i++)
+            printf(" %9s", counter_names[i]);
+        printf("   (counters per limb)");
+    }
+    printf("\n");
+
+    for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); o++) {
+        if (!selected(ops[o].name, argc, argv))
+            continue;
+        for (size_t t = 0; t < sizeof(tiers) / sizeof(tiers[0]); t++)
+            if (tiers[t] <= ops[o].max_limbs)
+                bench_one(&ops[o], tiers[t], have_counters);
+    }
+    counters_close();
+    return 0;
+}
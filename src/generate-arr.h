@@ -38,7 +38,7 @@
   }                                                                                                                    \
                                                                                                                        \
   void NAME##_deinit(NAME* arr) {                                                                                      \
-    free(arr->arr);                                                                                                    \
+    nc_free(arr->arr);                                                                                                 \
     arr->arr = NULL;                                                                                                   \
     arr->len = 0;                                                                                                      \
     arr->cap = 0;                                                                                                      \
@@ -52,10 +52,12 @@
                                                                                                                        \
   void delete_##NAME(NAME* arr) {                                                                                      \
     NAME##_deinit(arr);                                                                                                \
-    free(arr);                                                                                                         \
+    nc_free(arr);                                                                                                      \
   }                                                                                                                    \
                                                                                                                        \
   void NAME##_ensure_capacity(NAME* arr, size_t required_cap) {                                                        \
+    if (arr->cap == 0)                                                                                                 \
+      arr->cap = DEFAULT_CAP;                                                                                          \
     while (arr->cap < required_cap)                                                                                    \
       arr->cap *= 2;                                                                                                   \
     arr->arr = nc_realloc(arr->arr, arr->cap * sizeof(T));                                                             \
@@ -2,6 +2,74 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef NC_ALLOC_PROFILE
+
+void* nc_malloc(size_t size) {
+  void* result = malloc(size);
+  if (result == NULL) {
+    printf("Out of memory\n");
+    exit(1);
+  }
+  return result;
+}
+
+void* nc_realloc(void* arr, size_t size) {
+  void* result = realloc(arr, size);
+  if (result == NULL) {
+    printf("Out of memory\n");
+    exit(1);
+  }
+  return result;
+}
+
+void nc_free(void* arr) { free(arr); }
+
+void nc_disown(void* arr) { (void) arr; }
+
+int nc_alloc_profile_enabled(void) { return 0; }
+
+void nc_alloc_profile_snapshot(nc_alloc_profile* out) { memset(out, 0, sizeof(*out)); }
+
+void nc_alloc_profile_reset(void) {}
+
+void nc_alloc_profile_dump(FILE* file) { fprintf(file, "allocation profile: not compiled in\n"); }
+
+#else
+
+#include "superlong-internal.h"
+
+#include <malloc.h>
+#include <stdatomic.h>
+
+_Static_assert(NC_ALLOC_TAGS == SUPERLONG_STAT_OP_COUNT + 1, "one allocation tag per operation and one outside any");
+
+// block sizes come from malloc_usable_size, so buffers need no header and stay compatible with free()
+static _Atomic uint64_t nc_allocs, nc_reallocs, nc_frees, nc_bytes_requested, nc_live_bytes, nc_peak_bytes;
+static _Atomic uint64_t nc_tag_allocs[NC_ALLOC_TAGS], nc_tag_bytes[NC_ALLOC_TAGS];
+static atomic_flag nc_dump_registered = ATOMIC_FLAG_INIT;
+
+static void nc_alloc_profile_dump_at_exit(void) { nc_alloc_profile_dump(stderr); }
+
+static void nc_account(size_t requested, size_t grown, size_t shrunk) {
+  if (!atomic_flag_test_and_set_explicit(&nc_dump_registered, memory_order_relaxed)) {
+    const char* env = getenv("NC_ALLOC_PROFILE");
+    if (env && *env)
+      atexit(nc_alloc_profile_dump_at_exit);
+  }
+  int op = superlong_stats_current_op();
+  int tag = (op >= 0) ? op : NC_ALLOC_TAGS - 1;
+  atomic_fetch_add_explicit(&nc_tag_allocs[tag], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&nc_tag_bytes[tag], requested, memory_order_relaxed);
+  atomic_fetch_add_explicit(&nc_bytes_requested, requested, memory_order_relaxed);
+
+  uint64_t live = atomic_fetch_add_explicit(&nc_live_bytes, grown - shrunk, memory_order_relaxed) + grown - shrunk;
+  uint64_t peak = atomic_load_explicit(&nc_peak_bytes, memory_order_relaxed);
+  while (live > peak && !atomic_compare_exchange_weak_explicit(&nc_peak_bytes, &peak, live, memory_order_relaxed,
+                                                               memory_order_relaxed))
+    ;
+}
 
 void* nc_malloc(size_t size) {
   void* result = malloc(size);
@@ -9,14 +77,79 @@ void* nc_malloc(size_t size) {
     printf("Out of memory\n");
     exit(1);
   }
+  atomic_fetch_add_explicit(&nc_allocs, 1, memory_order_relaxed);
+  nc_account(size, malloc_usable_size(result), 0);
   return result;
 }
 
 void* nc_realloc(void* arr, size_t size) {
+  size_t old = arr ? malloc_usable_size(arr) : 0;
   void* result = realloc(arr, size);
   if (result == NULL) {
     printf("Out of memory\n");
     exit(1);
   }
+  atomic_fetch_add_explicit(arr ? &nc_reallocs : &nc_allocs, 1, memory_order_relaxed);
+  nc_account(size, malloc_usable_size(result), old);
   return result;
 }
+
+void nc_free(void* arr) {
+  if (arr == NULL)
+    return;
+  atomic_fetch_add_explicit(&nc_frees, 1, memory_order_relaxed);
+  nc_disown(arr);
+  free(arr);
+}
+
+void nc_disown(void* arr) {
+  if (arr)
+    atomic_fetch_sub_explicit(&nc_live_bytes, malloc_usable_size(arr), memory_order_relaxed);
+}
+
+int nc_alloc_profile_enabled(void) { return 1; }
+
+void nc_alloc_profile_snapshot(nc_alloc_profile* out) {
+  out->allocs = atomic_load_explicit(&nc_allocs, memory_order_relaxed);
+  out->reallocs = atomic_load_explicit(&nc_reallocs, memory_order_relaxed);
+  out->frees = atomic_load_explicit(&nc_frees, memory_order_relaxed);
+  out->bytes_requested = atomic_load_explicit(&nc_bytes_requested, memory_order_relaxed);
+  out->live_bytes = atomic_load_explicit(&nc_live_bytes, memory_order_relaxed);
+  out->peak_bytes = atomic_load_explicit(&nc_peak_bytes, memory_order_relaxed);
+  for (int tag = 0; tag < NC_ALLOC_TAGS; tag++) {
+    out->tag_allocs[tag] = atomic_load_explicit(&nc_tag_allocs[tag], memory_order_relaxed);
+    out->tag_bytes[tag] = atomic_load_explicit(&nc_tag_bytes[tag], memory_order_relaxed);
+  }
+}
+
+void nc_alloc_profile_reset(void) {
+  atomic_store_explicit(&nc_allocs, 0, memory_order_relaxed);
+  atomic_store_explicit(&nc_reallocs, 0, memory_order_relaxed);
+  atomic_store_explicit(&nc_frees, 0, memory_order_relaxed);
+  atomic_store_explicit(&nc_bytes_requested, 0, memory_order_relaxed);
+  atomic_store_explicit(&nc_peak_bytes, atomic_load_explicit(&nc_live_bytes, memory_order_relaxed),
+                        memory_order_relaxed);
+  for (int tag = 0; tag < NC_ALLOC_TAGS; tag++) {
+    atomic_store_explicit(&nc_tag_allocs[tag], 0, memory_order_relaxed);
+    atomic_store_explicit(&nc_tag_bytes[tag], 0, memory_order_relaxed);
+  }
+}
+
+void nc_alloc_profile_dump(FILE* file) {
+  nc_alloc_profile p;
+  nc_alloc_profile_snapshot(&p);
+  fprintf(file, "allocation profile: %llu allocs, %llu reallocs, %llu frees, %llu bytes requested\n",
+          (unsigned long long) p.allocs, (unsigned long long) p.reallocs, (unsigned long long) p.frees,
+          (unsigned long long) p.bytes_requested);
+  fprintf(file, "  live %llu bytes, peak %llu bytes\n", (unsigned long long) p.live_bytes,
+          (unsigned long long) p.peak_bytes);
+  for (int tag = 0; tag < NC_ALLOC_TAGS; tag++) {
+    if (p.tag_allocs[tag] == 0)
+      continue;
+    const char* name = (tag < SUPERLONG_STAT_OP_COUNT) ? superlong_stats_name(tag) : "other";
+    fprintf(file, "  %-16s %12llu allocs %16llu bytes\n", name, (unsigned long long) p.tag_allocs[tag],
+            (unsigned long long) p.tag_bytes[tag]);
+  }
+}
+
+#endif
@@ -1,9 +1,46 @@
 #ifndef SAFE_ALLOC_H
 #define SAFE_ALLOC_H
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void* nc_malloc(size_t size);
 void* nc_realloc(void* arr, size_t size);
+void nc_free(void* arr);
+
+// hands a buffer to the caller, who may release it with plain free()
+void nc_disown(void* arr);
+
+// Allocation profile, collected only when built with NC_ALLOC_PROFILE (make ALLOC_PROFILE=1).
+// Live and peak bytes count usable block sizes; allocations are attributed to the innermost
+// running operation, indexed by enum superlong_stat_op, or to the last slot outside any.
+// Setting the NC_ALLOC_PROFILE environment variable dumps the profile to stderr at exit.
+#define NC_ALLOC_TAGS 20
+
+typedef struct {
+  uint64_t allocs;
+  uint64_t reallocs;
+  uint64_t frees;
+  uint64_t bytes_requested;
+  uint64_t live_bytes;
+  uint64_t peak_bytes;
+  uint64_t tag_allocs[NC_ALLOC_TAGS]; // nc_malloc and nc_realloc calls
+  uint64_t tag_bytes[NC_ALLOC_TAGS];
+} nc_alloc_profile;
+
+int nc_alloc_profile_enabled(void);
+void nc_alloc_profile_snapshot(nc_alloc_profile* out);
+// clears the counters; the peak restarts from the current live bytes
+void nc_alloc_profile_reset(void);
+void nc_alloc_profile_dump(FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
 
-#endif
\ No newline at end of file
+#endif
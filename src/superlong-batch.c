@@ -0,0 +1,241 @@
+#include "superlong-batch.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SUPERLONG_BATCH_AVX2
+#endif
+
+// lanes processed together; per-lane carries and partial products of a block stay in cache
+#define SUPERLONG_BATCH_BLOCK 64
+
+void superlong_batch_init(superlong_batch* batch, size_t count, size_t bits) {
+  batch->count = count;
+  batch->width = (bits + 31) / 32;
+  if (batch->width == 0)
+    batch->width = 1;
+  size_t size = batch->width * count * sizeof(uint32_t);
+  batch->limbs = nc_malloc(size > 0 ? size : 1);
+  memset(batch->limbs, 0, size);
+}
+
+void superlong_batch_deinit(superlong_batch* batch) {
+  nc_free(batch->limbs);
+  batch->limbs = NULL;
+  batch->count = 0;
+  batch->width = 0;
+}
+
+void superlong_batch_set(superlong_batch* batch, size_t lane, const superlong* num) {
+  size_t len = superlong_is_zero(num) ? 0 : num->digits.len;
+  uint64_t borrow = (num->sign < 0) ? 1 : 0;
+  for (size_t j = 0; j < batch->width; j++) {
+    uint32_t limb = 0;
+    for (size_t b = 0; b < 4 && 4 * j + b < len; b++)
+      limb |= (uint32_t) num->digits.arr[4 * j + b] << (8 * b);
+    if (num->sign < 0) {
+      // two's complement: invert and add one, rippling through the limbs
+      uint64_t t = (uint64_t) (uint32_t) ~limb + borrow;
+      limb = (uint32_t) t;
+      borrow = t >> 32;
+    }
+    batch->limbs[j * batch->count + lane] = limb;
+  }
+}
+
+void superlong_batch_get(const superlong_batch* batch, size_t lane, superlong* res) {
+  uint32_t* limbs = nc_malloc(batch->width * sizeof(uint32_t));
+  for (size_t j = 0; j < batch->width; j++)
+    limbs[j] = batch->limbs[j * batch->count + lane];
+  superlong_import(res, batch->width, -1, sizeof(uint32_t), 0, limbs);
+  nc_free(limbs);
+}
+
+static void superlong_batch_check(const superlong_batch* a, const superlong_batch* b) {
+  if (a->count != b->count || a->width != b->width) {
+    fprintf(stderr, "superlong_batch: mismatched batch shapes\n");
+    exit(1);
+  }
+}
+
+// lane kernels: m lanes of one limb position, with per-lane 64-bit carries
+
+typedef struct {
+  void (*add)(uint32_t* r, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m);
+  void (*mul_row)(uint64_t* t, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m);
+  void (*mod_step)(uint64_t* rem, const uint32_t* cur, const uint32_t* next, size_t m, const superlong_preinv* inv);
+} superlong_batch_kernels;
+
+static void batch_add_scalar(uint32_t* r, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m) {
+  for (size_t l = 0; l < m; l++) {
+    uint64_t s = (uint64_t) x[l] + y[l] + carry[l];
+    r[l] = (uint32_t) s;
+    carry[l] = s >> 32;
+  }
+}
+
+// t += x * y with carries; x * y + t + carry never exceeds 64 bits
+static void batch_mul_row_scalar(uint64_t* t, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m) {
+  for (size_t l = 0; l < m; l++) {
+    uint64_t p = (uint64_t) x[l] * y[l] + t[l] + carry[l];
+    t[l] = (uint32_t) p;
+    carry[l] = p >> 32;
+  }
+}
+
+// rem = (rem * 2^32 + next limb, shifted by the divisor normalization) mod d, branch-free
+static void batch_mod_step_scalar(uint64_t* rem, const uint32_t* cur, const uint32_t* next, size_t m, const superlong_preinv* inv) {
+  unsigned s = inv->shift;
+  uint32_t d = inv->norm;
+  for (size_t l = 0; l < m; l++) {
+    uint32_t nh = (uint32_t) rem[l];
+    uint32_t nl = (cur[l] << s) | (next ? next[l] >> (32 - s) : 0);
+    uint64_t p = (uint64_t) inv->inv * nh + (((uint64_t) nh << 32) | nl);
+    uint32_t q = (uint32_t) (p >> 32) + 1;
+    uint32_t r = nl - q * d;
+    r += (r > (uint32_t) p) ? d : 0;
+    r -= (r >= d) ? d : 0;
+    rem[l] = r;
+  }
+}
+
+#ifdef SUPERLONG_BATCH_AVX2
+
+// four lanes per vector, each widened to 64 bits so carries have room
+
+__attribute__((target("avx2"))) static __m256i batch_load4(const uint32_t* p) {
+  return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*) p));
+}
+
+__attribute__((target("avx2"))) static void batch_store4(uint32_t* p, __m256i v) {
+  const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  _mm_storeu_si128((__m128i*) p, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, even)));
+}
+
+__attribute__((target("avx2"))) static void batch_add_avx2(uint32_t* r, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m) {
+  size_t l = 0;
+  for (; l + 4 <= m; l += 4) {
+    __m256i s = _mm256_add_epi64(_mm256_add_epi64(batch_load4(x + l), batch_load4(y + l)),
+                                 _mm256_loadu_si256((const __m256i*) (carry + l)));
+    batch_store4(r + l, s);
+    _mm256_storeu_si256((__m256i*) (carry + l), _mm256_srli_epi64(s, 32));
+  }
+  batch_add_scalar(r + l, carry + l, x + l, y + l, m - l);
+}
+
+__attribute__((target("avx2"))) static void batch_mul_row_avx2(uint64_t* t, uint64_t* carry, const uint32_t* x, const uint32_t* y, size_t m) {
+  const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+  size_t l = 0;
+  for (; l + 4 <= m; l += 4) {
+    __m256i p = _mm256_mul_epu32(batch_load4(x + l), batch_load4(y + l));
+    p = _mm256_add_epi64(p, _mm256_loadu_si256((const __m256i*) (t + l)));
+    p = _mm256_add_epi64(p, _mm256_loadu_si256((const __m256i*) (carry + l)));
+    _mm256_storeu_si256((__m256i*) (t + l), _mm256_and_si256(p, low));
+    _mm256_storeu_si256((__m256i*) (carry + l), _mm256_srli_epi64(p, 32));
+  }
+  batch_mul_row_scalar(t + l, carry + l, x + l, y + l, m - l);
+}
+
+__attribute__((target("avx2"))) static void batch_mod_step_avx2(uint64_t* rem, const uint32_t* cur, const uint32_t* next, size_t m, const superlong_preinv* inv) {
+  const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+  const __m256i d = _mm256_set1_epi64x(inv->norm);
+  const __m256i v = _mm256_set1_epi64x(inv->inv);
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m128i s = _mm_cvtsi32_si128((int) inv->shift);
+  const __m128i back = _mm_cvtsi32_si128((int) (32 - inv->shift));
+  size_t l = 0;
+  for (; l + 4 <= m; l += 4) {
+    __m256i nh = _mm256_loadu_si256((const __m256i*) (rem + l));
+    __m256i nl = _mm256_and_si256(_mm256_sll_epi64(batch_load4(cur + l), s), low);
+    if (next)
+      nl = _mm256_or_si256(nl, _mm256_srl_epi64(batch_load4(next + l), back));
+    __m256i p = _mm256_add_epi64(_mm256_mul_epu32(v, nh), _mm256_or_si256(_mm256_slli_epi64(nh, 32), nl));
+    __m256i q = _mm256_add_epi64(_mm256_srli_epi64(p, 32), one);
+    __m256i r = _mm256_and_si256(_mm256_sub_epi64(nl, _mm256_mul_epu32(q, d)), low);
+    __m256i fix = _mm256_cmpgt_epi64(r, _mm256_and_si256(p, low));
+    r = _mm256_and_si256(_mm256_add_epi64(r, _mm256_and_si256(fix, d)), low);
+    r = _mm256_sub_epi64(r, _mm256_andnot_si256(_mm256_cmpgt_epi64(d, r), d));
+    _mm256_storeu_si256((__m256i*) (rem + l), r);
+  }
+  batch_mod_step_scalar(rem + l, cur + l, next ? next + l : NULL, m - l, inv);
+}
+
+#endif
+
+static superlong_batch_kernels superlong_batch_select(void) {
+#ifdef SUPERLONG_BATCH_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    superlong_batch_kernels k = {batch_add_avx2, batch_mul_row_avx2, batch_mod_step_avx2};
+    return k;
+  }
+#endif
+  superlong_batch_kernels k = {batch_add_scalar, batch_mul_row_scalar, batch_mod_step_scalar};
+  return k;
+}
+
+void superlong_batch_add(const superlong_batch* a, const superlong_batch* b, superlong_batch* res) {
+  superlong_batch_check(a, b);
+  superlong_batch_check(a, res);
+  superlong_batch_kernels k = superlong_batch_select();
+  size_t n = a->count;
+  uint64_t carry[SUPERLONG_BATCH_BLOCK];
+  for (size_t l0 = 0; l0 < n; l0 += SUPERLONG_BATCH_BLOCK) {
+    size_t m = (n - l0 < SUPERLONG_BATCH_BLOCK) ? n - l0 : SUPERLONG_BATCH_BLOCK;
+    memset(carry, 0, sizeof(carry));
+    for (size_t j = 0; j < a->width; j++)
+      k.add(res->limbs + j * n + l0, carry, a->limbs + j * n + l0, b->limbs + j * n + l0, m);
+  }
+}
+
+// truncated schoolbook product: only limbs below the width are formed
+void superlong_batch_mul(const superlong_batch* a, const superlong_batch* b, superlong_batch* res) {
+  superlong_batch_check(a, b);
+  superlong_batch_check(a, res);
+  superlong_batch_kernels k = superlong_batch_select();
+  size_t n = a->count, w = a->width;
+  uint64_t* t = nc_malloc(w * SUPERLONG_BATCH_BLOCK * sizeof(uint64_t));
+  uint64_t carry[SUPERLONG_BATCH_BLOCK];
+  for (size_t l0 = 0; l0 < n; l0 += SUPERLONG_BATCH_BLOCK) {
+    size_t m = (n - l0 < SUPERLONG_BATCH_BLOCK) ? n - l0 : SUPERLONG_BATCH_BLOCK;
+    memset(t, 0, w * m * sizeof(uint64_t));
+    for (size_t i = 0; i < w; i++) {
+      memset(carry, 0, sizeof(carry));
+      for (size_t j = 0; i + j < w; j++)
+        k.mul_row(t + (i + j) * m, carry, a->limbs + i * n + l0, b->limbs + j * n + l0, m);
+    }
+    // the operands of this block are fully read, so res may alias them
+    for (size_t j = 0; j < w; j++)
+      for (size_t l = 0; l < m; l++)
+        res->limbs[j * n + l0 + l] = (uint32_t) t[j * m + l];
+  }
+  nc_free(t);
+}
+
+void superlong_batch_mod_ui(const superlong_batch* a, uint32_t d, uint32_t* out) {
+  superlong_preinv inv;
+  superlong_preinv_init(&inv, d);
+  superlong_batch_kernels k = superlong_batch_select();
+  size_t n = a->count, w = a->width;
+  unsigned s = inv.shift;
+  uint64_t rem[SUPERLONG_BATCH_BLOCK];
+  for (size_t l0 = 0; l0 < n; l0 += SUPERLONG_BATCH_BLOCK) {
+    size_t m = (n - l0 < SUPERLONG_BATCH_BLOCK) ? n - l0 : SUPERLONG_BATCH_BLOCK;
+    // Horner from the top limb, the dividend shifted left by s on the fly
+    const uint32_t* top = a->limbs + (w - 1) * n + l0;
+    for (size_t l = 0; l < m; l++)
+      rem[l] = (s != 0) ? top[l] >> (32 - s) : 0;
+    for (size_t j = w; j-- > 0;) {
+      const uint32_t* next = (s != 0 && j > 0) ? a->limbs + (j - 1) * n + l0 : NULL;
+      k.mod_step(rem, a->limbs + j * n + l0, next, m, &inv);
+    }
+    for (size_t l = 0; l < m; l++)
+      out[l0 + l] = (uint32_t) (rem[l] >> s);
+  }
+}
@@ -0,0 +1,39 @@
+#ifndef SUPERLONG_BATCH_H
+#define SUPERLONG_BATCH_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// count unsigned numbers of width 32-bit limbs each, stored structure-of-arrays:
+// limb j of lane i lives at limbs[j * count + i], so one limb of every lane is contiguous.
+// Arithmetic wraps modulo 2^(32 * width) like fixed-width integers.
+typedef struct {
+  uint32_t* limbs;
+  size_t count;
+  size_t width;
+} superlong_batch;
+
+// bits is rounded up to a whole number of limbs; all lanes start at zero
+void superlong_batch_init(superlong_batch*, size_t count, size_t bits);
+void superlong_batch_deinit(superlong_batch*);
+
+// negative values are stored in two's complement, the lane keeps num mod 2^(32 * width)
+void superlong_batch_set(superlong_batch*, size_t lane, const superlong* num);
+void superlong_batch_get(const superlong_batch*, size_t lane, superlong* res);
+
+// lane-wise operations over batches of the same shape; res may alias either operand
+void superlong_batch_add(const superlong_batch* a, const superlong_batch* b, superlong_batch* res);
+void superlong_batch_mul(const superlong_batch* a, const superlong_batch* b, superlong_batch* res);
+void superlong_batch_mod_ui(const superlong_batch* a, uint32_t d, uint32_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
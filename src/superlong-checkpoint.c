@@ -0,0 +1,547 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "superlong-checkpoint.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+// checkpoint file: 40-byte header followed by count entries, each a uint32 LE tag and a
+// superlong in the superlong_fwrite format
+//   0  "SLCK"      magic
+//   4  uint8       format version
+//   5  uint8       task kind
+//   6  uint16      reserved, zero
+//   8  uint64 LE   task parameter: n, the exponent or the end of the series range
+//   16 uint64 LE   fingerprint of the task operand (the base or the series), zero when there is none
+//   24 uint64 LE   progress: next factor, exponent bits done or next series term
+//   32 uint32 LE   entry count
+//   36 uint32      reserved, zero
+
+#define SUPERLONG_CKPT_HEADER_SIZE 40
+#define SUPERLONG_CKPT_VERSION 1
+#define SUPERLONG_CKPT_MAX_ENTRIES 64
+
+// factors per leaf of the checkpointed product tree: n / 32 within these bounds
+#define SUPERLONG_CKPT_SLICE_MIN 256
+#define SUPERLONG_CKPT_SLICE_MAX 4096
+
+// terms per leaf of the checkpointed series: a 32nd of the range within these bounds, and no
+// more than 2^20 leaves, so the counter of (P, Q, T) triples stays within the entries
+#define SUPERLONG_CKPT_SERIES_SLICE_MIN 16
+#define SUPERLONG_CKPT_SERIES_SLICE_MAX 4096
+#define SUPERLONG_CKPT_SERIES_MAX_SLICES ((uint64_t) 1 << 20)
+
+enum { SUPERLONG_CKPT_FACTORIAL = 1, SUPERLONG_CKPT_POW = 2, SUPERLONG_CKPT_SERIES = 3 };
+
+typedef struct {
+  int kind;
+  uint64_t param;
+  uint64_t check;
+  uint64_t progress;
+  size_t count;
+  superlong nums[SUPERLONG_CKPT_MAX_ENTRIES];
+  uint32_t tags[SUPERLONG_CKPT_MAX_ENTRIES];
+} superlong_ckpt_state;
+
+static void superlong_ckpt_state_init(superlong_ckpt_state* st, int kind, uint64_t param, uint64_t check) {
+  st->kind = kind;
+  st->param = param;
+  st->check = check;
+  st->progress = 0;
+  st->count = 0;
+  for (size_t i = 0; i < SUPERLONG_CKPT_MAX_ENTRIES; i++)
+    superlong_init(&st->nums[i]);
+}
+
+static void superlong_ckpt_state_deinit(superlong_ckpt_state* st) {
+  for (size_t i = 0; i < SUPERLONG_CKPT_MAX_ENTRIES; i++)
+    superlong_deinit(&st->nums[i]);
+}
+
+static void superlong_ckpt_state_copy(const superlong_ckpt_state* src, superlong_ckpt_state* dst) {
+  dst->kind = src->kind;
+  dst->param = src->param;
+  dst->check = src->check;
+  dst->progress = src->progress;
+  dst->count = src->count;
+  for (size_t i = 0; i < src->count; i++) {
+    superlong_copy(&src->nums[i], &dst->nums[i]);
+    dst->tags[i] = src->tags[i];
+  }
+}
+
+// takes over the digits of num
+static void superlong_ckpt_state_push(superlong_ckpt_state* st, uint32_t tag, superlong* num) {
+  superlong_deinit(&st->nums[st->count]);
+  st->nums[st->count] = *num;
+  st->tags[st->count] = tag;
+  st->count++;
+  superlong_init(num);
+}
+
+static void superlong_ckpt_state_replace(superlong_ckpt_state* st, size_t i, superlong* num) {
+  superlong_deinit(&st->nums[i]);
+  st->nums[i] = *num;
+  superlong_init(num);
+}
+
+static int superlong_ckpt_write(const char* path, const char* tmp_path, const superlong_ckpt_state* st) {
+  n256 header[SUPERLONG_CKPT_HEADER_SIZE] = {0};
+  memcpy(header, "SLCK", 4);
+  header[4] = SUPERLONG_CKPT_VERSION;
+  header[5] = (n256) st->kind;
+  superlong_store_le64(header + 8, st->param);
+  superlong_store_le64(header + 16, st->check);
+  superlong_store_le64(header + 24, st->progress);
+  superlong_store_le64(header + 32, st->count); // with the reserved word
+
+  FILE* file = fopen(tmp_path, "wb");
+  if (file == NULL)
+    return -1;
+  int ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+  for (size_t i = 0; ok && i < st->count; i++) {
+    n256 tag[8];
+    superlong_store_le64(tag, st->tags[i]);
+    ok = fwrite(tag, 1, 4, file) == 4 && superlong_fwrite(file, &st->nums[i]) == 0;
+  }
+  // the data must be on disk before the rename publishes it
+  ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+  if (fclose(file) != 0)
+    ok = 0;
+  if (!ok || rename(tmp_path, path) != 0) {
+    remove(tmp_path);
+    return -1;
+  }
+  return 0;
+}
+
+// 1 when a checkpoint of the task in st was loaded, 0 when there is none, -1 when it is unusable
+static int superlong_ckpt_read(const char* path, superlong_ckpt_state* st) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL)
+    return (errno == ENOENT) ? 0 : -1;
+
+  n256 header[SUPERLONG_CKPT_HEADER_SIZE];
+  int ok = fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, "SLCK", 4) == 0 &&
+           header[4] == SUPERLONG_CKPT_VERSION && header[5] == st->kind &&
+           superlong_load_le64(header + 8) == st->param && superlong_load_le64(header + 16) == st->check;
+  uint64_t count = ok ? superlong_load_le64(header + 32) : 0;
+  ok = ok && count <= SUPERLONG_CKPT_MAX_ENTRIES;
+  for (size_t i = 0; ok && i < count; i++) {
+    n256 tag[8] = {0};
+    ok = fread(tag, 1, 4, file) == 4 && superlong_fread(file, &st->nums[i]) == 0;
+    st->tags[i] = (uint32_t) superlong_load_le64(tag);
+  }
+  fclose(file);
+  if (!ok)
+    return -1;
+  st->progress = superlong_load_le64(header + 24);
+  st->count = (size_t) count;
+  return 1;
+}
+
+// background writer: the driver hands over copies of its state and continues, the thread
+// writes the most recent one; states submitted while a write is running replace each other
+typedef struct {
+  const char* path;
+  char* tmp_path;
+  superlong_ckpt_state pending;
+  superlong_ckpt_state writing;
+  int has_pending;
+  int stop;
+  int failed;
+#ifndef __STDC_NO_THREADS__
+  int threaded;
+  mtx_t lock;
+  cnd_t wake;
+  thrd_t thread;
+#endif
+} superlong_ckpt_writer;
+
+#ifndef __STDC_NO_THREADS__
+static int superlong_ckpt_thread(void* arg) {
+  superlong_ckpt_writer* w = arg;
+  mtx_lock(&w->lock);
+  for (;;) {
+    while (!w->has_pending && !w->stop)
+      cnd_wait(&w->wake, &w->lock);
+    if (!w->has_pending)
+      break;
+    // swapping hands the pending buffers to this thread without copying digits under the lock
+    superlong_ckpt_state swap = w->writing;
+    w->writing = w->pending;
+    w->pending = swap;
+    w->has_pending = 0;
+    mtx_unlock(&w->lock);
+    int failed = superlong_ckpt_write(w->path, w->tmp_path, &w->writing) != 0;
+    mtx_lock(&w->lock);
+    w->failed |= failed;
+  }
+  mtx_unlock(&w->lock);
+  return 0;
+}
+#endif
+
+static void superlong_ckpt_writer_start(superlong_ckpt_writer* w, const char* path, const superlong_ckpt_state* st) {
+  w->path = path;
+  w->tmp_path = nc_malloc(strlen(path) + 5);
+  strcpy(w->tmp_path, path);
+  strcat(w->tmp_path, ".tmp");
+  superlong_ckpt_state_init(&w->pending, st->kind, st->param, st->check);
+  superlong_ckpt_state_init(&w->writing, st->kind, st->param, st->check);
+  w->has_pending = 0;
+  w->stop = 0;
+  w->failed = 0;
+#ifndef __STDC_NO_THREADS__
+  w->threaded = 0;
+  if (mtx_init(&w->lock, mtx_plain) == thrd_success) {
+    if (cnd_init(&w->wake) == thrd_success) {
+      if (thrd_create(&w->thread, superlong_ckpt_thread, w) == thrd_success) {
+        w->threaded = 1;
+        return;
+      }
+      cnd_destroy(&w->wake);
+    }
+    mtx_destroy(&w->lock);
+  }
+#endif
+}
+
+static void superlong_ckpt_writer_submit(superlong_ckpt_writer* w, const superlong_ckpt_state* st) {
+#ifndef __STDC_NO_THREADS__
+  if (w->threaded) {
+    mtx_lock(&w->lock);
+    superlong_ckpt_state_copy(st, &w->pending);
+    w->has_pending = 1;
+    cnd_signal(&w->wake);
+    mtx_unlock(&w->lock);
+    return;
+  }
+#endif
+  // no writer thread: write in place
+  w->failed |= superlong_ckpt_write(w->path, w->tmp_path, st) != 0;
+}
+
+// waits for the last submitted state to be written, returns -1 if any write failed
+static int superlong_ckpt_writer_stop(superlong_ckpt_writer* w) {
+#ifndef __STDC_NO_THREADS__
+  if (w->threaded) {
+    mtx_lock(&w->lock);
+    w->stop = 1;
+    cnd_signal(&w->wake);
+    mtx_unlock(&w->lock);
+    thrd_join(w->thread, NULL);
+    cnd_destroy(&w->wake);
+    mtx_destroy(&w->lock);
+  }
+#endif
+  superlong_ckpt_state_deinit(&w->pending);
+  superlong_ckpt_state_deinit(&w->writing);
+  nc_free(w->tmp_path);
+  return w->failed ? -1 : 0;
+}
+
+static double superlong_ckpt_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// shared tail of the drivers: saves the state of a cancelled run, or moves the result
+// (the first `results` entries) into res and drops the checkpoint file
+static int superlong_ckpt_finish(superlong_exec* exec, superlong_exec* saved, superlong_ckpt_writer* w,
+                                 superlong_ckpt_state* st, superlong* const* res, size_t results) {
+  int cancelled = superlong_exec_finish(exec, saved) != 0;
+  if (cancelled)
+    superlong_ckpt_writer_submit(w, st);
+  int failed = superlong_ckpt_writer_stop(w) != 0;
+  if (!cancelled) {
+    for (size_t i = 0; i < results; i++) {
+      superlong_deinit(res[i]);
+      *res[i] = st->nums[i];
+      superlong_init(&st->nums[i]);
+    }
+    remove(w->path);
+  }
+  superlong_ckpt_state_deinit(st);
+  return (cancelled || failed) ? -1 : 0;
+}
+
+// a factorial state is the next factor and a binary counter of slice products whose levels
+// strictly decrease; no products only before the first slice
+static int superlong_ckpt_factorial_valid(const superlong_ckpt_state* st, uint32_t n) {
+  if (st->progress < 2 || (st->progress > (uint64_t) n + 1 && st->progress > 2))
+    return 0;
+  if ((st->count == 0) != (st->progress == 2))
+    return 0;
+  for (size_t i = 1; i < st->count; i++)
+    if (st->tags[i] >= st->tags[i - 1])
+      return 0;
+  return 1;
+}
+
+int superlong_factorial_checkpoint(superlong_exec* exec, uint32_t n, const char* path, double interval,
+                                   superlong* res) {
+  superlong_exec local;
+  if (exec == NULL) {
+    superlong_exec_init(&local, NULL, NULL);
+    exec = &local;
+  }
+  superlong_ckpt_state st;
+  superlong_ckpt_state_init(&st, SUPERLONG_CKPT_FACTORIAL, n, 0);
+  st.progress = 2;
+  int loaded = superlong_ckpt_read(path, &st);
+  if (loaded < 0 || (loaded && !superlong_ckpt_factorial_valid(&st, n))) {
+    superlong_ckpt_state_deinit(&st);
+    return -1;
+  }
+
+  // the slices form a binary counter: equal levels are merged at once, which keeps the
+  // products balanced like superlong_factorial's tree with at most log2(n) partial products
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_FACTORIAL, (n < 2) ? 0 : n - 1);
+  exec->done = st.progress - 2;
+  superlong_ckpt_writer writer;
+  superlong_ckpt_writer_start(&writer, path, &st);
+  double last = superlong_ckpt_now();
+  superlong prod;
+  superlong_init(&prod);
+  uint64_t slice = n / 32;
+  slice = (slice < SUPERLONG_CKPT_SLICE_MIN) ? SUPERLONG_CKPT_SLICE_MIN : slice;
+  slice = (slice > SUPERLONG_CKPT_SLICE_MAX) ? SUPERLONG_CKPT_SLICE_MAX : slice;
+
+  while (st.progress <= n && !superlong_exec_cancelled(exec)) {
+    uint64_t count = (uint64_t) n - st.progress + 1;
+    if (count > slice)
+      count = slice;
+    superlong_prod_range((uint32_t) st.progress, (size_t) count, &prod);
+    if (superlong_exec_cancelled(exec))
+      break;
+
+    // the new slice absorbs the equal levels before it is pushed, so the state only changes
+    // once every merge is done and a cancelled merge leaves it as it was
+    size_t top = st.count;
+    uint32_t tag = 0;
+    while (top > 0 && st.tags[top - 1] == tag) {
+      superlong_mul(&st.nums[top - 1], &prod, &prod);
+      if (superlong_exec_cancelled(exec))
+        break;
+      top--;
+      tag++;
+    }
+    if (superlong_exec_cancelled(exec))
+      break;
+    st.count = top;
+    superlong_ckpt_state_push(&st, tag, &prod);
+    st.progress += count;
+    if (superlong_ckpt_now() - last >= interval) {
+      superlong_ckpt_writer_submit(&writer, &st);
+      last = superlong_ckpt_now();
+    }
+  }
+  // fold what is left, smallest products first
+  while (st.count >= 2 && !superlong_exec_cancelled(exec)) {
+    superlong_mul(&st.nums[st.count - 2], &st.nums[st.count - 1], &prod);
+    if (superlong_exec_cancelled(exec))
+      break;
+    superlong_ckpt_state_replace(&st, st.count - 2, &prod);
+    st.count--;
+  }
+  if (st.count == 0)
+    superlong_from_uint(&st.nums[0], 1);
+  superlong_deinit(&prod);
+  return superlong_ckpt_finish(exec, saved, &writer, &st, &res, 1);
+}
+
+int superlong_pow_ui_checkpoint(superlong_exec* exec, const superlong* base, uint64_t exp, const char* path,
+                                double interval, superlong* res) {
+  superlong_exec local;
+  if (exec == NULL) {
+    superlong_exec_init(&local, NULL, NULL);
+    exec = &local;
+  }
+  // the base is identified by its digits and sign
+  size_t base_len = superlong_is_zero(base) ? 0 : base->digits.len;
+  uint64_t check = superlong_checksum(base->digits.arr, base_len) ^ (base->sign < 0);
+  unsigned bits = exp ? 64u - (unsigned) __builtin_clzll(exp) : 0;
+
+  superlong_ckpt_state st;
+  superlong_ckpt_state_init(&st, SUPERLONG_CKPT_POW, exp, check);
+  int loaded = superlong_ckpt_read(path, &st);
+  if (loaded < 0 || (loaded && (st.count != 1 || st.progress > bits))) {
+    superlong_ckpt_state_deinit(&st);
+    return -1;
+  }
+  if (!loaded) {
+    superlong_from_uint(&st.nums[0], 1);
+    st.count = 1;
+  }
+
+  // left-to-right binary powering like superlong_pow_ui, one exponent bit per step
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_POW, bits);
+  exec->done = st.progress;
+  superlong_ckpt_writer writer;
+  superlong_ckpt_writer_start(&writer, path, &st);
+  double last = superlong_ckpt_now();
+  superlong next;
+  superlong_init(&next);
+
+  while (st.progress < bits && !superlong_exec_cancelled(exec)) {
+    unsigned bit = bits - 1 - (unsigned) st.progress;
+    superlong_mul(&st.nums[0], &st.nums[0], &next);
+    if ((exp >> bit) & 1)
+      superlong_mul(&next, base, &next);
+    if (superlong_exec_cancelled(exec))
+      break;
+    superlong_ckpt_state_replace(&st, 0, &next);
+    st.progress++;
+    superlong_exec_poll(SUPERLONG_STAT_POW, 1);
+    if (superlong_ckpt_now() - last >= interval) {
+      superlong_ckpt_writer_submit(&writer, &st);
+      last = superlong_ckpt_now();
+    }
+  }
+  superlong_deinit(&next);
+  return superlong_ckpt_finish(exec, saved, &writer, &st, &res, 1);
+}
+
+// a series state is the next term and a binary counter of the (P, Q, T) triples of consecutive
+// slices, three entries per triple sharing its level; levels strictly decrease
+static int superlong_ckpt_series_valid(const superlong_ckpt_state* st, uint64_t lo, uint64_t hi) {
+  if (st->progress < lo || st->progress > hi || st->count % 3 != 0)
+    return 0;
+  if ((st->count == 0) != (st->progress == lo))
+    return 0;
+  for (size_t i = 1; i < st->count; i++)
+    if ((i % 3 == 0) ? st->tags[i] >= st->tags[i - 1] : st->tags[i] != st->tags[i - 1])
+      return 0;
+  return 1;
+}
+
+// the series is identified by its range and its first term
+static uint64_t superlong_ckpt_series_check(superlong_series_term term, void* ctx, uint64_t lo, uint64_t hi) {
+  uint64_t check = lo;
+  if (hi > lo) {
+    superlong_series first;
+    superlong_series_init(&first);
+    term(ctx, lo, &first.p, &first.q, &first.t);
+    const superlong* parts[3] = {&first.p, &first.q, &first.t};
+    for (int i = 0; i < 3; i++) {
+      size_t len = superlong_is_zero(parts[i]) ? 0 : parts[i]->digits.len;
+      check = check * 1099511628211u ^ superlong_checksum(parts[i]->digits.arr, len) ^ (parts[i]->sign < 0);
+    }
+    superlong_series_deinit(&first);
+  }
+  return check;
+}
+
+// the (P, Q, T) of [a, c) from the triple l of [a, b) and r of [b, c):
+// T = T_l Q_r + P_l T_r, Q = Q_l Q_r, P = P_l P_r
+static void superlong_ckpt_series_merge(const superlong* l, const superlong_series* r, superlong_series* out) {
+  superlong_mul(&l[2], &r->q, &out->t);
+  superlong_addmul(&l[0], &r->t, &out->t);
+  superlong_mul(&l[1], &r->q, &out->q);
+  superlong_mul(&l[0], &r->p, &out->p);
+}
+
+int superlong_series_eval_checkpoint(superlong_exec* exec, superlong_series_term term, void* ctx, uint64_t lo,
+                                     uint64_t hi, const char* path, double interval, superlong_series* res) {
+  superlong_exec local;
+  if (exec == NULL) {
+    superlong_exec_init(&local, NULL, NULL);
+    exec = &local;
+  }
+  hi = (hi < lo) ? lo : hi;
+  superlong_ckpt_state st;
+  superlong_ckpt_state_init(&st, SUPERLONG_CKPT_SERIES, hi, superlong_ckpt_series_check(term, ctx, lo, hi));
+  st.progress = lo;
+  int loaded = superlong_ckpt_read(path, &st);
+  if (loaded < 0 || (loaded && !superlong_ckpt_series_valid(&st, lo, hi))) {
+    superlong_ckpt_state_deinit(&st);
+    return -1;
+  }
+
+  // slices of terms are evaluated in memory by superlong_series_eval and kept as a binary
+  // counter like the factorial's, merging equal levels left to right
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_SERIES, hi - lo);
+  exec->done = st.progress - lo;
+  superlong_ckpt_writer writer;
+  superlong_ckpt_writer_start(&writer, path, &st);
+  double last = superlong_ckpt_now();
+  superlong_series cur, next;
+  superlong_series_init(&cur);
+  superlong_series_init(&next);
+  uint64_t slice = (hi - lo) / 32;
+  slice = (slice < SUPERLONG_CKPT_SERIES_SLICE_MIN) ? SUPERLONG_CKPT_SERIES_SLICE_MIN : slice;
+  slice = (slice > SUPERLONG_CKPT_SERIES_SLICE_MAX) ? SUPERLONG_CKPT_SERIES_SLICE_MAX : slice;
+  while ((hi - lo) / slice >= SUPERLONG_CKPT_SERIES_MAX_SLICES)
+    slice *= 2;
+
+  while (st.progress < hi && !superlong_exec_cancelled(exec)) {
+    uint64_t count = hi - st.progress;
+    if (count > slice)
+      count = slice;
+    superlong_series_eval(term, ctx, st.progress, st.progress + count, &cur);
+    if (superlong_exec_cancelled(exec))
+      break;
+
+    // as for the factorial, the state only changes once every merge is done
+    size_t top = st.count;
+    uint32_t tag = 0;
+    while (top > 0 && st.tags[top - 1] == tag) {
+      superlong_ckpt_series_merge(&st.nums[top - 3], &cur, &next);
+      if (superlong_exec_cancelled(exec))
+        break;
+      superlong_series swap = cur;
+      cur = next;
+      next = swap;
+      top -= 3;
+      tag++;
+    }
+    if (superlong_exec_cancelled(exec))
+      break;
+    st.count = top;
+    superlong_ckpt_state_push(&st, tag, &cur.p);
+    superlong_ckpt_state_push(&st, tag, &cur.q);
+    superlong_ckpt_state_push(&st, tag, &cur.t);
+    st.progress += count;
+    superlong_exec_poll(SUPERLONG_STAT_SERIES, count);
+    if (superlong_ckpt_now() - last >= interval) {
+      superlong_ckpt_writer_submit(&writer, &st);
+      last = superlong_ckpt_now();
+    }
+  }
+  // fold what is left, the latest slices first
+  while (st.count >= 6 && !superlong_exec_cancelled(exec)) {
+    size_t i = st.count - 6;
+    // the right triple is only read, its digits stay with the state
+    superlong_series right = {st.nums[i + 3], st.nums[i + 4], st.nums[i + 5]};
+    superlong_ckpt_series_merge(&st.nums[i], &right, &next);
+    if (superlong_exec_cancelled(exec))
+      break;
+    superlong_ckpt_state_replace(&st, i, &next.p);
+    superlong_ckpt_state_replace(&st, i + 1, &next.q);
+    superlong_ckpt_state_replace(&st, i + 2, &next.t);
+    st.count -= 3;
+  }
+  if (st.count == 0) {
+    superlong_from_uint(&st.nums[0], 1);
+    superlong_from_uint(&st.nums[1], 1);
+    superlong_from_uint(&st.nums[2], 0);
+  }
+  superlong_series_deinit(&cur);
+  superlong_series_deinit(&next);
+  superlong* results[3] = {&res->p, &res->q, &res->t};
+  return superlong_ckpt_finish(exec, saved, &writer, &st, results, 3);
+}
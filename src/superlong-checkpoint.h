@@ -0,0 +1,35 @@
+#ifndef SUPERLONG_CHECKPOINT_H
+#define SUPERLONG_CHECKPOINT_H
+
+#include "superlong.h"
+#include "superlong-series.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Long-running drivers that save their partial results to path at least every interval
+// seconds and resume from it when called again with the same task. A background thread writes
+// each checkpoint to path.tmp and renames it over path, so the file always holds a complete
+// state; it is removed once the result is computed.
+//
+// exec may be NULL; if it gets cancelled, the current state is saved before returning -1.
+// Also -1 when path holds a checkpoint of another task or a damaged one (it is left alone),
+// and when a checkpoint could not be written, in which case res still receives the result.
+int superlong_factorial_checkpoint(superlong_exec* exec, uint32_t n, const char* path, double interval,
+                                   superlong* res);
+int superlong_pow_ui_checkpoint(superlong_exec* exec, const superlong* base, uint64_t exp, const char* path,
+                                double interval, superlong* res);
+
+// superlong_series_eval over [lo, hi) in slices whose (P, Q, T) are kept and saved as they
+// complete; a checkpoint only resumes the same range of a series with the same first term
+int superlong_series_eval_checkpoint(superlong_exec* exec, superlong_series_term term, void* ctx, uint64_t lo,
+                                     uint64_t hi, const char* path, double interval, superlong_series* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+#include "superlong-fixed.h"
+
+#include "superlong-internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void superlong_fixed_load(uint32_t* w, size_t n, const superlong* num) {
+  size_t len = superlong_is_zero(num) ? 0 : num->digits.len;
+  uint64_t borrow = (num->sign < 0) ? 1 : 0;
+  for (size_t j = 0; j < n; j++) {
+    uint32_t word = 0;
+    for (size_t b = 0; b < 4 && 4 * j + b < len; b++)
+      word |= (uint32_t) num->digits.arr[4 * j + b] << (8 * b);
+    if (num->sign < 0) {
+      // two's complement: invert and add one, rippling through the words
+      uint64_t t = (uint64_t) (uint32_t) ~word + borrow;
+      word = (uint32_t) t;
+      borrow = t >> 32;
+    }
+    w[j] = word;
+  }
+}
+
+// divides through the library's word-level long division; un is n + 1 words of scratch
+void superlong_fixed_divmod_words(uint32_t* q, uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n,
+                                  uint32_t* un) {
+  size_t m = n, nb = n;
+  while (nb > 0 && b[nb - 1] == 0)
+    nb--;
+  if (nb == 0) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  while (m > 0 && a[m - 1] == 0)
+    m--;
+  memset(q, 0, n * sizeof(uint32_t));
+  memset(r, 0, n * sizeof(uint32_t));
+  if (m < nb) {
+    memcpy(r, a, m * sizeof(uint32_t));
+    return;
+  }
+
+  // remainder in un[0..nb), quotient in un[nb..m]
+  memcpy(un, a, m * sizeof(uint32_t));
+  un[m] = 0;
+  superlong_words_divrem(un, m, b, nb);
+  memcpy(r, un, nb * sizeof(uint32_t));
+  memcpy(q, un + nb, (m - nb + 1) * sizeof(uint32_t));
+}
+
+DEFINE_SUPERLONG_FIXED(256)
+DEFINE_SUPERLONG_FIXED(512)
+DEFINE_SUPERLONG_FIXED(1024)
+DEFINE_SUPERLONG_FIXED(4096)
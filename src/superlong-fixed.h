@@ -0,0 +1,141 @@
+#ifndef SUPERLONG_FIXED_H
+#define SUPERLONG_FIXED_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// fixed-width unsigned integers: BITS (a multiple of 32, at least 64) in 32-bit words, least significant first.
+// They never allocate and wrap modulo 2^BITS. add/sub return the carry/borrow out, mul keeps the low half of
+// the product, divmod takes NULL for a part it should not store. from_superlong stores negatives in two's complement.
+
+// helpers shared by the generated functions
+void superlong_fixed_load(uint32_t* w, size_t n, const superlong* num);
+void superlong_fixed_divmod_words(uint32_t* q, uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n,
+                                  uint32_t* un);
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define SUPERLONG_FIXED_UNROLL _Pragma("GCC unroll 16")
+#else
+#define SUPERLONG_FIXED_UNROLL
+#endif
+
+#define DECLARE_SUPERLONG_FIXED(BITS)                                                                                  \
+  typedef struct {                                                                                                     \
+    uint32_t w[(BITS) / 32];                                                                                           \
+  } superlong_fixed##BITS;                                                                                             \
+                                                                                                                       \
+  void superlong_fixed##BITS##_from_uint64(superlong_fixed##BITS* res, uint64_t n);                                    \
+  void superlong_fixed##BITS##_from_superlong(superlong_fixed##BITS* res, const superlong* num);                       \
+  void superlong_fixed##BITS##_to_superlong(const superlong_fixed##BITS* a, superlong* res);                           \
+  int superlong_fixed##BITS##_is_zero(const superlong_fixed##BITS* a);                                                 \
+  int superlong_fixed##BITS##_compare(const superlong_fixed##BITS* a, const superlong_fixed##BITS* b);                 \
+  unsigned superlong_fixed##BITS##_add(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                     \
+                                       const superlong_fixed##BITS* b);                                                \
+  unsigned superlong_fixed##BITS##_sub(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                     \
+                                       const superlong_fixed##BITS* b);                                                \
+  void superlong_fixed##BITS##_mul(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                         \
+                                   const superlong_fixed##BITS* b);                                                    \
+  void superlong_fixed##BITS##_divmod(superlong_fixed##BITS* q, superlong_fixed##BITS* r, const superlong_fixed##BITS* a,\
+                                      const superlong_fixed##BITS* b);
+
+
+#define DEFINE_SUPERLONG_FIXED(BITS)                                                                                   \
+                                                                                                                       \
+  void superlong_fixed##BITS##_from_uint64(superlong_fixed##BITS* res, uint64_t n) {                                   \
+    memset(res->w, 0, sizeof(res->w));                                                                                 \
+    res->w[0] = (uint32_t) n;                                                                                          \
+    res->w[1] = (uint32_t) (n >> 32);                                                                                  \
+  }                                                                                                                    \
+                                                                                                                       \
+  void superlong_fixed##BITS##_from_superlong(superlong_fixed##BITS* res, const superlong* num) {                      \
+    superlong_fixed_load(res->w, (BITS) / 32, num);                                                                    \
+  }                                                                                                                    \
+                                                                                                                       \
+  void superlong_fixed##BITS##_to_superlong(const superlong_fixed##BITS* a, superlong* res) {                          \
+    superlong_import(res, (BITS) / 32, -1, sizeof(uint32_t), 0, a->w);                                                 \
+  }                                                                                                                    \
+                                                                                                                       \
+  int superlong_fixed##BITS##_is_zero(const superlong_fixed##BITS* a) {                                                \
+    uint32_t any = 0;                                                                                                  \
+    SUPERLONG_FIXED_UNROLL                                                                                             \
+    for (size_t i = 0; i < (BITS) / 32; i++)                                                                           \
+      any |= a->w[i];                                                                                                  \
+    return any == 0;                                                                                                   \
+  }                                                                                                                    \
+                                                                                                                       \
+  int superlong_fixed##BITS##_compare(const superlong_fixed##BITS* a, const superlong_fixed##BITS* b) {                \
+    for (size_t i = (BITS) / 32; i-- > 0;)                                                                             \
+      if (a->w[i] != b->w[i])                                                                                          \
+        return (a->w[i] < b->w[i]) ? -1 : 1;                                                                           \
+    return 0;                                                                                                          \
+  }                                                                                                                    \
+                                                                                                                       \
+  unsigned superlong_fixed##BITS##_add(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                     \
+                                       const superlong_fixed##BITS* b) {                                               \
+    uint64_t c = 0;                                                                                                    \
+    SUPERLONG_FIXED_UNROLL                                                                                             \
+    for (size_t i = 0; i < (BITS) / 32; i++) {                                                                         \
+      c += (uint64_t) a->w[i] + b->w[i];                                                                               \
+      res->w[i] = (uint32_t) c;                                                                                        \
+      c >>= 32;                                                                                                        \
+    }                                                                                                                  \
+    return (unsigned) c;                                                                                               \
+  }                                                                                                                    \
+                                                                                                                       \
+  unsigned superlong_fixed##BITS##_sub(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                     \
+                                       const superlong_fixed##BITS* b) {                                               \
+    uint64_t borrow = 0;                                                                                               \
+    SUPERLONG_FIXED_UNROLL                                                                                             \
+    for (size_t i = 0; i < (BITS) / 32; i++) {                                                                         \
+      uint64_t t = (uint64_t) a->w[i] - b->w[i] - borrow;                                                              \
+      res->w[i] = (uint32_t) t;                                                                                        \
+      borrow = t >> 63;                                                                                                \
+    }                                                                                                                  \
+    return (unsigned) borrow;                                                                                          \
+  }                                                                                                                    \
+                                                                                                                       \
+  void superlong_fixed##BITS##_mul(superlong_fixed##BITS* res, const superlong_fixed##BITS* a,                         \
+                                   const superlong_fixed##BITS* b) {                                                   \
+    superlong_fixed##BITS t;                                                                                           \
+    memset(t.w, 0, sizeof(t.w));                                                                                       \
+    for (size_t i = 0; i < (BITS) / 32; i++) {                                                                         \
+      uint64_t c = 0;                                                                                                  \
+      SUPERLONG_FIXED_UNROLL                                                                                           \
+      for (size_t j = 0; j < (BITS) / 32 - i; j++) {                                                                   \
+        c += (uint64_t) a->w[i] * b->w[j] + t.w[i + j];                                                                \
+        t.w[i + j] = (uint32_t) c;                                                                                     \
+        c >>= 32;                                                                                                      \
+      }                                                                                                                \
+    }                                                                                                                  \
+    *res = t;                                                                                                          \
+  }                                                                                                                    \
+                                                                                                                       \
+  void superlong_fixed##BITS##_divmod(superlong_fixed##BITS* q, superlong_fixed##BITS* r, const superlong_fixed##BITS* a,\
+                                      const superlong_fixed##BITS* b) {                                                \
+    superlong_fixed##BITS tq, tr;                                                                                      \
+    uint32_t un[(BITS) / 32 + 1];                                                                                      \
+    superlong_fixed_divmod_words(tq.w, tr.w, a->w, b->w, (BITS) / 32, un);                                             \
+    if (q)                                                                                                             \
+      *q = tq;                                                                                                         \
+    if (r)                                                                                                             \
+      *r = tr;                                                                                                         \
+  }
+
+
+DECLARE_SUPERLONG_FIXED(256)
+DECLARE_SUPERLONG_FIXED(512)
+DECLARE_SUPERLONG_FIXED(1024)
+DECLARE_SUPERLONG_FIXED(4096)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
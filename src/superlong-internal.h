@@ -0,0 +1,66 @@
+#ifndef SUPERLONG_INTERNAL_H
+#define SUPERLONG_INTERNAL_H
+
+#include "superlong.h"
+#include "superlong-stats.h"
+
+// helpers shared by the library's translation units, not part of the public API
+
+#define SLDIGITS_ARR_PTR(NUM) (&(NUM)->digits)
+
+void superlong_clean(superlong*);
+void superlong_normalize(superlong*);
+
+// product of the consecutive run first, first + 1, ..., first + count - 1 (1 when empty)
+void superlong_prod_range(uint32_t first, size_t count, superlong* res);
+
+// sieve of the odd numbers up to limit, bit i set when 2i + 1 is composite; free with nc_free
+uint8_t* superlong_sieve(uint64_t limit);
+int superlong_sieve_is_prime(const uint8_t* composite, uint64_t p);
+
+// the largest power of base that fits in 32 bits, as base^*digits
+uint32_t superlong_radix_chunk(int base, unsigned* digits);
+
+// Knuth's algorithm D on the 32-bit words u[0..n], whose top word u[n] is zero, by v[0..m) with
+// v[m - 1] != 0 and m <= n: the remainder replaces u[0..m) and the quotient u[m..n]. The one
+// word-level long division, behind radix output, out-of-core output and the fixed-width types
+void superlong_words_divrem(uint32_t* u, size_t n, const uint32_t* v, size_t m);
+
+uint64_t superlong_load_le64(const n256*);
+void superlong_store_le64(n256*, uint64_t);
+
+// execution contexts: begin installs exec on this thread for an operation of kind op
+// (a superlong_stat_op) expecting total units; finish restores the previous context,
+// reports completion and returns -1 if the operation was cancelled
+superlong_exec* superlong_exec_begin(superlong_exec*, int op, uint64_t total);
+int superlong_exec_finish(superlong_exec*, superlong_exec* saved);
+// counts units towards the running operation of kind op and returns 1 once it is cancelled
+int superlong_exec_poll(int op, uint64_t units);
+
+// innermost operation running on this thread, -1 outside any or without SUPERLONG_STATS and
+// NC_ALLOC_PROFILE
+int superlong_stats_current_op(void);
+
+// SUPERLONG_STAT_SCOPE(op, size) marks the rest of the enclosing block as running op; with
+// SUPERLONG_STATS it also counts the call and times it, NC_ALLOC_PROFILE alone only attributes
+// allocations to it
+#if defined(SUPERLONG_STATS) || defined(NC_ALLOC_PROFILE)
+typedef struct {
+  int op;
+  int prev;
+  uint64_t start;
+} superlong_stat_scope;
+
+superlong_stat_scope superlong_stats_enter(enum superlong_stat_op, size_t size);
+void superlong_stats_leave(superlong_stat_scope*);
+
+#define SUPERLONG_STAT_CONCAT_(A, B) A##B
+#define SUPERLONG_STAT_CONCAT(A, B) SUPERLONG_STAT_CONCAT_(A, B)
+#define SUPERLONG_STAT_SCOPE(OP, SIZE)                                                                                 \
+  superlong_stat_scope SUPERLONG_STAT_CONCAT(superlong_stat_scope_, __LINE__)                                          \
+      __attribute__((cleanup(superlong_stats_leave))) = superlong_stats_enter(OP, SIZE)
+#else
+#define SUPERLONG_STAT_SCOPE(OP, SIZE) ((void) 0)
+#endif
+
+#endif
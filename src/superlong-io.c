@@ -0,0 +1,356 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "superlong.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// raw word import/export
+
+static int superlong_native_endian(void) {
+  const uint16_t probe = 1;
+  return (*(const uint8_t*) &probe == 1) ? -1 : 1;
+}
+
+void* superlong_export(void* out, size_t* countp, int order, size_t size, int endian, const superlong* num) {
+  size_t len = superlong_is_zero(num) ? 0 : num->digits.len;
+  size_t count = (len + size - 1) / size;
+  if (countp)
+    *countp = count;
+  if (count == 0)
+    return out;
+  if (out == NULL) {
+    out = nc_malloc(count * size);
+    nc_disown(out);
+  }
+  if (endian == 0)
+    endian = superlong_native_endian();
+
+  n256* dst = out;
+  if (order < 0 && (endian < 0 || size == 1)) {
+    // least significant word first, little-endian words: the digit array itself
+    memcpy(dst, num->digits.arr, len);
+    memset(dst + len, 0, count * size - len);
+    return out;
+  }
+  for (size_t w = 0; w < count; w++) {
+    n256* word = dst + ((order < 0) ? w : count - 1 - w) * size;
+    for (size_t b = 0; b < size; b++) {
+      size_t src = w * size + b;
+      word[(endian < 0) ? b : size - 1 - b] = (src < len) ? num->digits.arr[src] : 0;
+    }
+  }
+  return out;
+}
+
+void superlong_import(superlong* res, size_t count, int order, size_t size, int endian, const void* data) {
+  size_t len = count * size;
+  superlong_clean(res);
+  sldigits_ensure_capacity(SLDIGITS_ARR_PTR(res), len > 0 ? len : 1);
+  if (endian == 0)
+    endian = superlong_native_endian();
+
+  const n256* src = data;
+  if (order < 0 && (endian < 0 || size == 1)) {
+    if (len > 0)
+      memcpy(res->digits.arr, src, len);
+  } else {
+    for (size_t w = 0; w < count; w++) {
+      const n256* word = src + ((order < 0) ? w : count - 1 - w) * size;
+      for (size_t b = 0; b < size; b++)
+        res->digits.arr[w * size + b] = word[(endian < 0) ? b : size - 1 - b];
+    }
+  }
+  res->digits.len = len;
+  res->sign = 1;
+  superlong_normalize(res);
+}
+
+// binary file format: 24-byte header followed by the little-endian digits
+//   0  "SLNG"      magic
+//   4  uint8       format version
+//   5  int8        sign
+//   6  uint16      reserved, zero
+//   8  uint64 LE   digit count
+//   16 uint64 LE   checksum of the digits
+
+#define SUPERLONG_FILE_VERSION 1
+
+void superlong_store_le64(n256* p, uint64_t v) {
+  for (int i = 0; i < 8; i++)
+    p[i] = (n256) (v >> (8 * i));
+}
+
+uint64_t superlong_load_le64(const n256* p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++)
+    v |= (uint64_t) p[i] << (8 * i);
+  return v;
+}
+
+// multiply-rotate hash over 64-bit words
+uint64_t superlong_checksum(const void* data, size_t len) {
+  const n256* p = data;
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t w;
+    memcpy(&w, p + i, sizeof(w));
+    h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 29;
+  }
+  uint64_t tail = 0;
+  for (size_t j = 0; i + j < len; j++)
+    tail |= (uint64_t) p[i + j] << (8 * j);
+  h = (h ^ tail) * 0xC4CEB9FE1A85EC53ULL;
+  return h ^ (h >> 32);
+}
+
+static size_t superlong_file_header(const superlong* num, n256 header[SUPERLONG_FILE_HEADER_SIZE]) {
+  size_t len = superlong_is_zero(num) ? 0 : num->digits.len;
+  memcpy(header, "SLNG", 4);
+  header[4] = SUPERLONG_FILE_VERSION;
+  header[5] = (n256) (int8_t) ((len > 0) ? num->sign : 0);
+  header[6] = 0;
+  header[7] = 0;
+  superlong_store_le64(header + 8, len);
+  superlong_store_le64(header + 16, superlong_checksum(num->digits.arr, len));
+  return len;
+}
+
+// validates the header, returns the digit count or -1
+static int64_t superlong_file_parse_header(const n256 header[SUPERLONG_FILE_HEADER_SIZE], int* sign, uint64_t* checksum) {
+  if (memcmp(header, "SLNG", 4) != 0 || header[4] != SUPERLONG_FILE_VERSION)
+    return -1;
+  *sign = (int8_t) header[5];
+  *checksum = superlong_load_le64(header + 16);
+  uint64_t len = superlong_load_le64(header + 8);
+  if (*sign < -1 || *sign > 1 || len > (uint64_t) INT64_MAX || ((len == 0) != (*sign == 0)))
+    return -1;
+  return (int64_t) len;
+}
+
+static int superlong_file_finish(superlong* res, size_t len, int sign, uint64_t checksum) {
+  res->digits.len = len;
+  res->sign = sign;
+  if (superlong_checksum(res->digits.arr, len) != checksum) {
+    superlong_clean(res);
+    return -1;
+  }
+  if (len == 0)
+    sldigits_add_tail(SLDIGITS_ARR_PTR(res), 0);
+  superlong_normalize(res);
+  return 0;
+}
+
+// the digits arrive in chunks no larger than what has already arrived (and at least
+// SUPERLONG_FILE_CHUNK), so a header claiming more digits than the stream holds ends in a short
+// read instead of an allocation of the claimed size
+#define SUPERLONG_FILE_CHUNK ((size_t) 1 << 20)
+
+static int superlong_file_read_digits(superlong* res, size_t len, int (*read_chunk)(void*, void*, size_t), void* src) {
+  superlong_clean(res);
+  size_t got = 0;
+  while (got < len) {
+    size_t chunk = (got > SUPERLONG_FILE_CHUNK) ? got : SUPERLONG_FILE_CHUNK;
+    if (chunk > len - got)
+      chunk = len - got;
+    sldigits_ensure_capacity(SLDIGITS_ARR_PTR(res), got + chunk);
+    if (read_chunk(src, res->digits.arr + got, chunk) != 0) {
+      superlong_clean(res);
+      return -1;
+    }
+    got += chunk;
+  }
+  return 0;
+}
+
+static int superlong_file_fread(void* file, void* buf, size_t len) {
+  return (fread(buf, 1, len, file) == len) ? 0 : -1;
+}
+
+int superlong_fwrite(FILE* file, const superlong* num) {
+  n256 header[SUPERLONG_FILE_HEADER_SIZE];
+  size_t len = superlong_file_header(num, header);
+  if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+    return -1;
+  if (len > 0 && fwrite(num->digits.arr, 1, len, file) != len)
+    return -1;
+  return 0;
+}
+
+int superlong_fread(FILE* file, superlong* res) {
+  n256 header[SUPERLONG_FILE_HEADER_SIZE];
+  int sign;
+  uint64_t checksum;
+  if (fread(header, 1, sizeof(header), file) != sizeof(header))
+    return -1;
+  int64_t len = superlong_file_parse_header(header, &sign, &checksum);
+  if (len < 0)
+    return -1;
+
+  if (superlong_file_read_digits(res, (size_t) len, superlong_file_fread, file) != 0)
+    return -1;
+  return superlong_file_finish(res, (size_t) len, sign, checksum);
+}
+
+int superlong_write_fd(int fd, const superlong* num) {
+  n256 header[SUPERLONG_FILE_HEADER_SIZE];
+  size_t len = superlong_file_header(num, header);
+
+  // header and digits leave in one writev, resumed after short writes
+  struct iovec iov[2] = {{header, sizeof(header)}, {num->digits.arr, len}};
+  struct iovec* cur = iov;
+  int iovcnt = (len > 0) ? 2 : 1;
+  while (iovcnt > 0) {
+    ssize_t written = writev(fd, cur, iovcnt);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    while (iovcnt > 0 && (size_t) written >= cur->iov_len) {
+      written -= (ssize_t) cur->iov_len;
+      cur++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      cur->iov_base = (n256*) cur->iov_base + written;
+      cur->iov_len -= (size_t) written;
+    }
+  }
+  return 0;
+}
+
+static int read_full(int fd, void* buf, size_t len) {
+  n256* p = buf;
+  while (len > 0) {
+    ssize_t got = read(fd, p, len);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return -1;
+    p += got;
+    len -= (size_t) got;
+  }
+  return 0;
+}
+
+static int superlong_file_read_fd(void* fd, void* buf, size_t len) {
+  return read_full(*(int*) fd, buf, len);
+}
+
+int superlong_read_fd(int fd, superlong* res) {
+  n256 header[SUPERLONG_FILE_HEADER_SIZE];
+  int sign;
+  uint64_t checksum;
+  if (read_full(fd, header, sizeof(header)) != 0)
+    return -1;
+  int64_t len = superlong_file_parse_header(header, &sign, &checksum);
+  if (len < 0)
+    return -1;
+
+  if (superlong_file_read_digits(res, (size_t) len, superlong_file_read_fd, &fd) != 0)
+    return -1;
+  return superlong_file_finish(res, (size_t) len, sign, checksum);
+}
+
+// zero-copy views
+
+superlong_view superlong_view_of(const superlong* num) {
+  return superlong_view_from_buffer(num->digits.arr, superlong_is_zero(num) ? 0 : num->digits.len, num->sign);
+}
+
+superlong_view superlong_view_from_buffer(const void* digits, size_t len, int sign) {
+  const n256* p = digits;
+  while (len > 0 && p[len - 1] == 0)
+    len--;
+  superlong_view view = {p, len, (len > 0) ? sign : 0, NULL, 0};
+  return view;
+}
+
+int superlong_view_map_file(const char* path, int verify_checksum, superlong_view* view) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < SUPERLONG_FILE_HEADER_SIZE) {
+    close(fd);
+    return -1;
+  }
+  size_t map_len = (size_t) st.st_size;
+  void* map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return -1;
+
+  int sign;
+  uint64_t checksum;
+  const n256* header = map;
+  int64_t len = superlong_file_parse_header(header, &sign, &checksum);
+  if (len < 0 || (uint64_t) len > map_len - SUPERLONG_FILE_HEADER_SIZE ||
+      (verify_checksum && superlong_checksum(header + SUPERLONG_FILE_HEADER_SIZE, (size_t) len) != checksum)) {
+    munmap(map, map_len);
+    return -1;
+  }
+  *view = superlong_view_from_buffer(header + SUPERLONG_FILE_HEADER_SIZE, (size_t) len, sign);
+  view->map = map;
+  view->map_len = map_len;
+  return 0;
+}
+
+void superlong_view_unmap(superlong_view* view) {
+  if (view->map)
+    munmap(view->map, view->map_len);
+  view->map = NULL;
+  view->map_len = 0;
+  view->digits = NULL;
+  view->len = 0;
+  view->sign = 0;
+}
+
+superlong superlong_view_borrow(superlong_view view) {
+  superlong shell = {{(n256*) view.digits, view.len, view.len}, (view.len > 0) ? view.sign : 0};
+  return shell;
+}
+
+void superlong_add_view(superlong_view a, superlong_view b, superlong* res) {
+  superlong x = superlong_view_borrow(a), y = superlong_view_borrow(b);
+  superlong_add(&x, &y, res);
+}
+
+void superlong_sub_view(superlong_view a, superlong_view b, superlong* res) {
+  superlong x = superlong_view_borrow(a), y = superlong_view_borrow(b);
+  superlong_sub(&x, &y, res);
+}
+
+void superlong_mul_view(superlong_view a, superlong_view b, superlong* res) {
+  superlong x = superlong_view_borrow(a), y = superlong_view_borrow(b);
+  superlong_mul(&x, &y, res);
+}
+
+void superlong_div_view(superlong_view a, superlong_view b, superlong* res) {
+  superlong x = superlong_view_borrow(a), y = superlong_view_borrow(b);
+  superlong_div(&x, &y, res);
+}
+
+int superlong_compare_view(superlong_view a, superlong_view b) {
+  superlong x = superlong_view_borrow(a), y = superlong_view_borrow(b);
+  return superlong_compare(&x, &y);
+}
+
+char* superlong_to_decimal_str_view(superlong_view a) {
+  superlong x = superlong_view_borrow(a);
+  return superlong_to_decimal_str(&x);
+}
@@ -0,0 +1,917 @@
+#include "superlong-mod.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+#include "superlong-series.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+__extension__ typedef unsigned __int128 superlong_u128;
+
+// odd primes below 1000 for trial division
+static const uint16_t superlong_small_primes[] = {
+    3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,  59,  61,  67,  71,  73,  79,
+    83,  89,  97,  101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191,
+    193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311,
+    313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433, 439,
+    443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541, 547, 557, 563, 569, 571, 577,
+    587, 593, 599, 601, 607, 613, 617, 619, 631, 641, 643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709,
+    719, 727, 733, 739, 743, 751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827, 829, 839, 853, 857,
+    859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941, 947, 953, 967, 971, 977, 983, 991, 997};
+
+#define SUPERLONG_SMALL_PRIMES (sizeof(superlong_small_primes) / sizeof(superlong_small_primes[0]))
+
+// numbers below 1009^2 without a factor below 1000 are prime
+#define SUPERLONG_TRIAL_LIMIT 1018081
+
+// nextprime sieves windows of this many odd candidates with the primes below the bound
+#define SUPERLONG_NEXTPRIME_WINDOW 4096
+#define SUPERLONG_NEXTPRIME_SIEVE 65536
+
+// Miller-Rabin rounds already matched by Baillie-PSW, as in GMP
+#define SUPERLONG_BPSW_REPS 24
+
+void superlong_mod_ui_multi(const superlong* a, const uint32_t* d, size_t count, uint32_t* out) {
+  for (size_t i = 0; i < count; i++) {
+    if (d[i] == 0) {
+      perror("Division by zero\n");
+      exit(1);
+    }
+    out[i] = 0;
+  }
+  size_t len = superlong_is_zero(a) ? 0 : a->digits.len;
+  // 32 bits at a time from the top, the inner loop's divisions are independent of each other
+  for (size_t c = (len + 3) / 4; c-- > 0;) {
+    uint32_t chunk = 0;
+    for (size_t b = 0; b < 4 && 4 * c + b < len; b++)
+      chunk |= (uint32_t) a->digits.arr[4 * c + b] << (8 * b);
+    for (size_t i = 0; i < count; i++)
+      out[i] = (uint32_t) ((((uint64_t) out[i] << 32) | chunk) % d[i]);
+  }
+}
+
+// multi-word helpers
+
+static void superlong_words_load(uint64_t* w, size_t n, const superlong* num) {
+  memset(w, 0, n * sizeof(uint64_t));
+  size_t len = superlong_is_zero(num) ? 0 : num->digits.len;
+  for (size_t i = 0; i < len && i < 8 * n; i++)
+    w[i / 8] |= (uint64_t) num->digits.arr[i] << (8 * (i % 8));
+}
+
+static void superlong_words_store(superlong* res, const uint64_t* w, size_t n) {
+  superlong_import(res, n, -1, sizeof(uint64_t), 0, w);
+}
+
+static uint64_t superlong_words_add(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    superlong_u128 t = (superlong_u128) a[i] + b[i] + carry;
+    r[i] = (uint64_t) t;
+    carry = (uint64_t) (t >> 64);
+  }
+  return carry;
+}
+
+static uint64_t superlong_words_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t ai = a[i], bi = b[i];
+    r[i] = ai - bi - borrow;
+    borrow = (ai < bi) || (ai == bi && borrow);
+  }
+  return borrow;
+}
+
+static int superlong_words_compare(const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = n; i-- > 0;)
+    if (a[i] != b[i])
+      return (a[i] > b[i]) ? 1 : -1;
+  return 0;
+}
+
+static int superlong_words_is_zero(const uint64_t* a, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    if (a[i] != 0)
+      return 0;
+  return 1;
+}
+
+static size_t superlong_words_bits(const uint64_t* w, size_t n) {
+  while (n > 0 && w[n - 1] == 0)
+    n--;
+  return (n == 0) ? 0 : 64 * n - (size_t) __builtin_clzll(w[n - 1]);
+}
+
+static int superlong_words_bit(const uint64_t* w, size_t bit) { return (int) ((w[bit / 64] >> (bit % 64)) & 1); }
+
+// a mod |m| in [0, |m|)
+static void superlong_mod_reduce(const superlong* a, const superlong* m, superlong* res) {
+  superlong q, r;
+  superlong_init(&q);
+  superlong_init(&r);
+  superlong_div(a, m, &q);
+  superlong_copy(a, &r);
+  superlong_submul(&q, m, &r);
+  if (r.sign < 0 && !superlong_is_zero(&r)) {
+    if (m->sign < 0)
+      superlong_sub(&r, m, &r);
+    else
+      superlong_add(&r, m, &r);
+  }
+  superlong_deinit(res);
+  *res = r;
+  superlong_deinit(&q);
+}
+
+// Montgomery arithmetic modulo an odd m > 1 of n words, R = 2^(64 n). Values stay in [0, m)
+// and in Montgomery form x R mod m; every product needs n + 2 words of scratch
+
+typedef struct {
+  size_t n;
+  uint64_t minv; // -m^-1 mod 2^64
+  uint64_t* m;
+  uint64_t* one;   // R mod m, the Montgomery form of 1
+  uint64_t* r2;    // R^2 mod m
+  uint64_t* unit;  // plain 1, for leaving Montgomery form
+} superlong_mont;
+
+static void superlong_mont_init(superlong_mont* ctx, const superlong* m) {
+  size_t n = (superlong_bit_length(m) + 63) / 64;
+  ctx->n = n;
+  ctx->m = nc_malloc(4 * n * sizeof(uint64_t));
+  ctx->one = ctx->m + n;
+  ctx->r2 = ctx->m + 2 * n;
+  ctx->unit = ctx->m + 3 * n;
+  superlong_words_load(ctx->m, n, m);
+  memset(ctx->unit, 0, n * sizeof(uint64_t));
+  ctx->unit[0] = 1;
+
+  // Newton's iteration doubles the correct low bits of the inverse, m0 itself is right mod 8
+  uint64_t inv = ctx->m[0];
+  for (int i = 0; i < 5; i++)
+    inv *= 2 - ctx->m[0] * inv;
+  ctx->minv = 0 - inv;
+
+  superlong r, mabs;
+  superlong_init(&r);
+  superlong_init(&mabs);
+  superlong_copy(m, &mabs);
+  mabs.sign = 1;
+  superlong_from_uint(&r, 1);
+  superlong_shl(&r, 64 * n);
+  superlong_mod_reduce(&r, &mabs, &r);
+  superlong_words_load(ctx->one, n, &r);
+  superlong_mul(&r, &r, &r);
+  superlong_mod_reduce(&r, &mabs, &r);
+  superlong_words_load(ctx->r2, n, &r);
+  superlong_deinit(&r);
+  superlong_deinit(&mabs);
+}
+
+static void superlong_mont_deinit(superlong_mont* ctx) { nc_free(ctx->m); }
+
+// r = a b / R mod m by coarsely integrated operand scanning; r may alias a or b
+static void superlong_mont_mul(const superlong_mont* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b,
+                               uint64_t* restrict t) {
+  size_t n = ctx->n;
+  const uint64_t* m = ctx->m;
+  uint64_t minv = ctx->minv;
+  memset(t, 0, (n + 2) * sizeof(uint64_t));
+  for (size_t i = 0; i < n; i++) {
+    uint64_t bi = b[i], carry = 0;
+    for (size_t j = 0; j < n; j++) {
+      superlong_u128 p = (superlong_u128) a[j] * bi + t[j] + carry;
+      t[j] = (uint64_t) p;
+      carry = (uint64_t) (p >> 64);
+    }
+    superlong_u128 s = (superlong_u128) t[n] + carry;
+    t[n] = (uint64_t) s;
+    t[n + 1] = (uint64_t) (s >> 64);
+
+    uint64_t q = t[0] * minv;
+    superlong_u128 p = (superlong_u128) q * m[0] + t[0];
+    carry = (uint64_t) (p >> 64);
+    for (size_t j = 1; j < n; j++) {
+      p = (superlong_u128) q * m[j] + t[j] + carry;
+      t[j - 1] = (uint64_t) p;
+      carry = (uint64_t) (p >> 64);
+    }
+    s = (superlong_u128) t[n] + carry;
+    t[n - 1] = (uint64_t) s;
+    t[n] = t[n + 1] + (uint64_t) (s >> 64);
+  }
+  if (t[n] != 0 || superlong_words_compare(t, m, n) >= 0)
+    superlong_words_sub(r, t, m, n);
+  else
+    memcpy(r, t, n * sizeof(uint64_t));
+}
+
+static void superlong_mont_add(const superlong_mont* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  uint64_t carry = superlong_words_add(r, a, b, ctx->n);
+  if (carry || superlong_words_compare(r, ctx->m, ctx->n) >= 0)
+    superlong_words_sub(r, r, ctx->m, ctx->n);
+}
+
+static void superlong_mont_sub(const superlong_mont* ctx, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+  if (superlong_words_sub(r, a, b, ctx->n))
+    superlong_words_add(r, r, ctx->m, ctx->n);
+}
+
+// r = a / 2 mod m: add m to odd values, then shift the n + 1 bit sum
+static void superlong_mont_half(const superlong_mont* ctx, uint64_t* r, const uint64_t* a) {
+  size_t n = ctx->n;
+  uint64_t top = 0;
+  if (a[0] & 1)
+    top = superlong_words_add(r, a, ctx->m, n);
+  else if (r != a)
+    memcpy(r, a, n * sizeof(uint64_t));
+  for (size_t i = 0; i < n; i++)
+    r[i] = (r[i] >> 1) | ((i + 1 < n ? r[i + 1] : top) << 63);
+}
+
+// Montgomery form of the small signed value v
+static void superlong_mont_from_int(const superlong_mont* ctx, uint64_t* r, int64_t v, uint64_t* t) {
+  memset(r, 0, ctx->n * sizeof(uint64_t));
+  r[0] = (v < 0) ? (uint64_t) -v : (uint64_t) v;
+  superlong_mont_mul(ctx, r, r, ctx->r2, t);
+  if (v < 0 && !superlong_words_is_zero(r, ctx->n))
+    superlong_words_sub(r, ctx->m, r, ctx->n);
+}
+
+// sliding window width for an exponent of ebits bits
+static unsigned superlong_window_bits(size_t ebits) {
+  return (ebits > 671) ? 6 : (ebits > 239) ? 5 : (ebits > 79) ? 4 : (ebits > 23) ? 3 : (ebits > 1) ? 2 : 1;
+}
+
+// r = prod b_i^e_i in Montgomery form, b_i at bases + i n, by interleaved sliding windows (Straus):
+// one chain of squarings for all exponents, and every window multiplies in a tabulated odd power
+// of its base at the bit where it ends
+static void superlong_mont_pow_multi(const superlong_mont* ctx, uint64_t* r, const uint64_t* bases,
+                                     const uint64_t* const* exps, const size_t* ebits, size_t count, uint64_t* t) {
+  size_t n = ctx->n, top = 0, entries = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (ebits[i] > top)
+      top = ebits[i];
+    entries += (size_t) 1 << (superlong_window_bits(ebits[i]) - 1);
+  }
+  if (top == 0) {
+    memcpy(r, ctx->one, n * sizeof(uint64_t));
+    return;
+  }
+  uint64_t* table = nc_malloc((entries + 1) * n * sizeof(uint64_t));
+  uint64_t* sq = table + entries * n;
+  size_t* offset = nc_malloc(count * sizeof(size_t));
+  // window values by the bit where they end, 0 elsewhere
+  uint8_t* digits = nc_malloc(count * top);
+  memset(digits, 0, count * top);
+
+  for (size_t i = 0, next = 0; i < count; i++) {
+    unsigned k = superlong_window_bits(ebits[i]);
+    size_t size = (size_t) 1 << (k - 1);
+    uint64_t* odd = table + next * n;
+    offset[i] = next;
+    next += size;
+    memcpy(odd, bases + i * n, n * sizeof(uint64_t));
+    superlong_mont_mul(ctx, sq, odd, odd, t);
+    for (size_t l = 1; l < size; l++)
+      superlong_mont_mul(ctx, odd + l * n, odd + (l - 1) * n, sq, t);
+
+    const uint64_t* e = exps[i];
+    for (size_t b = ebits[i]; b-- > 0;) {
+      if (!superlong_words_bit(e, b))
+        continue;
+      // the longest window of at most k bits from b down that ends in a set bit
+      size_t j = (b + 1 >= k) ? b + 1 - k : 0;
+      while (!superlong_words_bit(e, j))
+        j++;
+      unsigned value = 0;
+      for (size_t l = b + 1; l-- > j;)
+        value = (value << 1) | (unsigned) superlong_words_bit(e, l);
+      digits[i * top + j] = (uint8_t) value;
+      b = j;
+    }
+  }
+
+  int started = 0;
+  for (size_t b = top; b-- > 0;) {
+    if (started)
+      superlong_mont_mul(ctx, r, r, r, t);
+    for (size_t i = 0; i < count; i++) {
+      unsigned value = digits[i * top + b];
+      if (value == 0)
+        continue;
+      const uint64_t* power = table + (offset[i] + value / 2) * n;
+      if (started)
+        superlong_mont_mul(ctx, r, r, power, t);
+      else
+        memcpy(r, power, n * sizeof(uint64_t));
+      started = 1;
+    }
+  }
+  nc_free(digits);
+  nc_free(offset);
+  nc_free(table);
+}
+
+static void superlong_mont_pow(const superlong_mont* ctx, uint64_t* r, const uint64_t* b, const uint64_t* e,
+                               size_t ebits, uint64_t* t) {
+  superlong_mont_pow_multi(ctx, r, b, &e, &ebits, 1, t);
+}
+
+// b^e mod an odd m > 1, b already reduced
+static void superlong_powmod_odd(const superlong* b, const uint64_t* e, size_t ebits, const superlong* m,
+                                 superlong* res) {
+  superlong_mont ctx;
+  superlong_mont_init(&ctx, m);
+  size_t n = ctx.n;
+  uint64_t* w = nc_malloc((3 * n + 2) * sizeof(uint64_t));
+  uint64_t *x = w, *r = w + n, *t = w + 2 * n;
+  superlong_words_load(x, n, b);
+  superlong_mont_mul(&ctx, x, x, ctx.r2, t);
+  superlong_mont_pow(&ctx, r, x, e, ebits, t);
+  superlong_mont_mul(&ctx, r, r, ctx.unit, t);
+  superlong_words_store(res, r, n);
+  nc_free(w);
+  superlong_mont_deinit(&ctx);
+}
+
+void superlong_powmod(const superlong* base, const superlong* exp, const superlong* mod, superlong* res) {
+  if (superlong_is_zero(mod)) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  if (exp->sign < 0 && !superlong_is_zero(exp)) {
+    perror("Negative exponent\n");
+    exit(1);
+  }
+  superlong m, b;
+  superlong_init(&m);
+  superlong_init(&b);
+  superlong_copy(mod, &m);
+  m.sign = 1;
+  superlong_mod_reduce(base, &m, &b);
+  size_t en = (superlong_bit_length(exp) + 63) / 64;
+  uint64_t* e = nc_malloc((en + 1) * sizeof(uint64_t));
+  superlong_words_load(e, en, exp);
+  size_t ebits = superlong_words_bits(e, en);
+
+  if (superlong_bit_length(&m) == 1) {
+    superlong_from_uint(res, 0);
+  } else if (m.digits.arr[0] & 1) {
+    superlong_powmod_odd(&b, e, ebits, &m, res);
+  } else {
+    // even m = 2^k o: b^e mod 2^k by truncating products, b^e mod o in Montgomery form,
+    // then x = x_o + o ((x_2 - x_o) o^-1 mod 2^k)
+    size_t k = 0;
+    while ((m.digits.arr[k / 8] >> (k % 8) & 1) == 0)
+      k++;
+    superlong mask, odd, x2, xo, inv, t;
+    superlong_init(&mask);
+    superlong_init(&odd);
+    superlong_init(&x2);
+    superlong_init(&xo);
+    superlong_init(&inv);
+    superlong_init(&t);
+    superlong_from_uint(&mask, 1);
+    superlong_shl(&mask, k);
+    superlong_sub_uint(&mask, 1, &mask);
+    superlong_copy(&m, &odd);
+    superlong_shr(&odd, k);
+
+    superlong_and(&b, &mask, &t);
+    superlong_from_uint(&x2, 1);
+    for (size_t i = ebits; i-- > 0 && !superlong_is_zero(&x2);) {
+      superlong_mul(&x2, &x2, &x2);
+      superlong_and(&x2, &mask, &x2);
+      if (superlong_words_bit(e, i)) {
+        superlong_mul(&x2, &t, &x2);
+        superlong_and(&x2, &mask, &x2);
+      }
+    }
+    if (superlong_bit_length(&odd) == 1) {
+      superlong_copy(&x2, res);
+    } else {
+      superlong_mod_reduce(&b, &odd, &xo);
+      superlong_powmod_odd(&xo, e, ebits, &odd, &xo);
+      // Newton's iteration for the inverse of odd modulo 2^k, the masks keep everything in [0, 2^k)
+      superlong_from_uint(&inv, 1);
+      for (size_t bits = 1; bits < k; bits *= 2) {
+        superlong_mul(&odd, &inv, &t);
+        superlong_sub_uint(&t, 2, &t);
+        superlong_mul(&inv, &t, &inv);
+        superlong_negate(&inv);
+        superlong_and(&inv, &mask, &inv);
+      }
+      superlong_sub(&x2, &xo, &t);
+      superlong_and(&t, &mask, &t);
+      superlong_mul(&t, &inv, &t);
+      superlong_and(&t, &mask, &t);
+      superlong_mul(&t, &odd, &t);
+      superlong_add(&t, &xo, res);
+    }
+    superlong_deinit(&mask);
+    superlong_deinit(&odd);
+    superlong_deinit(&x2);
+    superlong_deinit(&xo);
+    superlong_deinit(&inv);
+    superlong_deinit(&t);
+  }
+  nc_free(e);
+  superlong_deinit(&m);
+  superlong_deinit(&b);
+}
+
+void superlong_powmod_multi(const superlong* const* bases, const superlong* const* exps, size_t count,
+                            const superlong* mod, superlong* res) {
+  if (superlong_is_zero(mod)) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (exps[i]->sign < 0 && !superlong_is_zero(exps[i])) {
+      perror("Negative exponent\n");
+      exit(1);
+    }
+  }
+  superlong m, b;
+  superlong_init(&m);
+  superlong_init(&b);
+  superlong_copy(mod, &m);
+  m.sign = 1;
+  if (superlong_bit_length(&m) == 1) {
+    superlong_from_uint(res, 0);
+  } else if (m.digits.arr[0] & 1) {
+    superlong_mont ctx;
+    superlong_mont_init(&ctx, &m);
+    size_t n = ctx.n, words = 0;
+    for (size_t i = 0; i < count; i++)
+      words += (superlong_bit_length(exps[i]) + 63) / 64;
+    uint64_t* w = nc_malloc((count * n + words + 2 * n + 2) * sizeof(uint64_t));
+    uint64_t* x = w;
+    uint64_t *r = w + count * n, *t = r + n, *e = t + n + 2;
+    const uint64_t** e_words = nc_malloc(count * sizeof(uint64_t*));
+    size_t* ebits = nc_malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+      superlong_mod_reduce(bases[i], &m, &b);
+      superlong_words_load(x + i * n, n, &b);
+      superlong_mont_mul(&ctx, x + i * n, x + i * n, ctx.r2, t);
+      size_t en = (superlong_bit_length(exps[i]) + 63) / 64;
+      superlong_words_load(e, en, exps[i]);
+      e_words[i] = e;
+      ebits[i] = superlong_words_bits(e, en);
+      e += en;
+    }
+    superlong_mont_pow_multi(&ctx, r, x, e_words, ebits, count, t);
+    superlong_mont_mul(&ctx, r, r, ctx.unit, t);
+    superlong_words_store(res, r, n);
+    nc_free(ebits);
+    nc_free(e_words);
+    nc_free(w);
+    superlong_mont_deinit(&ctx);
+  } else {
+    // even moduli: separate powers multiplied together
+    superlong acc;
+    superlong_init(&acc);
+    superlong_from_uint(&acc, 1);
+    for (size_t i = 0; i < count; i++) {
+      superlong_powmod(bases[i], exps[i], &m, &b);
+      superlong_mul(&acc, &b, &acc);
+      superlong_mod_reduce(&acc, &m, &acc);
+    }
+    superlong_deinit(res);
+    *res = acc;
+  }
+  superlong_deinit(&m);
+  superlong_deinit(&b);
+}
+
+// fixed-base comb (Lim-Lee): with h teeth spaced a = ceil(bits / h) apart, entry v of the table is
+// prod over the set bits j of v of base^(2^(j a)), so one squaring and at most one multiplication
+// per column take care of h exponent bits at once
+struct superlong_fixed_base_rep {
+  superlong base, mod;
+  size_t bits, spacing;
+  unsigned teeth;
+  int comb; // 0 for even moduli and |mod| = 1, which go to superlong_powmod
+  superlong_mont ctx;
+  uint64_t* table;
+};
+
+void superlong_fixed_base_init(superlong_fixed_base* fb, const superlong* base, const superlong* mod, size_t bits) {
+  if (superlong_is_zero(mod)) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  superlong_fixed_base_rep* rep = nc_malloc(sizeof(superlong_fixed_base_rep));
+  superlong_init(&rep->base);
+  superlong_init(&rep->mod);
+  superlong_copy(mod, &rep->mod);
+  rep->mod.sign = 1;
+  superlong_mod_reduce(base, &rep->mod, &rep->base);
+  rep->bits = (bits > 0) ? bits : 1;
+  rep->teeth = (rep->bits > 2048) ? 8 : (rep->bits > 512) ? 7 : (rep->bits > 128) ? 6 : (rep->bits > 32) ? 5 : 4;
+  rep->spacing = (rep->bits + rep->teeth - 1) / rep->teeth;
+  rep->comb = (rep->mod.digits.arr[0] & 1) && superlong_bit_length(&rep->mod) > 1;
+  rep->table = NULL;
+  fb->rep = rep;
+  if (!rep->comb)
+    return;
+
+  superlong_mont_init(&rep->ctx, &rep->mod);
+  size_t n = rep->ctx.n, entries = (size_t) 1 << rep->teeth;
+  uint64_t* t = nc_malloc((n + 2) * sizeof(uint64_t));
+  uint64_t* table = nc_malloc(entries * n * sizeof(uint64_t));
+  memcpy(table, rep->ctx.one, n * sizeof(uint64_t));
+  superlong_words_load(table + n, n, &rep->base);
+  superlong_mont_mul(&rep->ctx, table + n, table + n, rep->ctx.r2, t);
+  for (unsigned j = 1; j < rep->teeth; j++) {
+    uint64_t* tooth = table + ((size_t) 1 << j) * n;
+    memcpy(tooth, table + ((size_t) 1 << (j - 1)) * n, n * sizeof(uint64_t));
+    for (size_t l = 0; l < rep->spacing; l++)
+      superlong_mont_mul(&rep->ctx, tooth, tooth, tooth, t);
+  }
+  for (size_t v = 3; v < entries; v++) {
+    size_t high = (size_t) 1 << (63 - __builtin_clzll(v));
+    if (v != high)
+      superlong_mont_mul(&rep->ctx, table + v * n, table + (v - high) * n, table + high * n, t);
+  }
+  rep->table = table;
+  nc_free(t);
+}
+
+void superlong_fixed_base_deinit(superlong_fixed_base* fb) {
+  superlong_fixed_base_rep* rep = fb->rep;
+  if (rep == NULL)
+    return;
+  if (rep->comb) {
+    nc_free(rep->table);
+    superlong_mont_deinit(&rep->ctx);
+  }
+  superlong_deinit(&rep->base);
+  superlong_deinit(&rep->mod);
+  nc_free(rep);
+  fb->rep = NULL;
+}
+
+void superlong_fixed_base_powmod(const superlong_fixed_base* fb, const superlong* exp, superlong* res) {
+  const superlong_fixed_base_rep* rep = fb->rep;
+  size_t ebits = superlong_bit_length(exp);
+  if (!rep->comb || ebits > rep->bits || (exp->sign < 0 && !superlong_is_zero(exp))) {
+    superlong_powmod(&rep->base, exp, &rep->mod, res);
+    return;
+  }
+  size_t n = rep->ctx.n, a = rep->spacing;
+  size_t en = (a * rep->teeth + 63) / 64;
+  uint64_t* w = nc_malloc((2 * n + 2 + en) * sizeof(uint64_t));
+  uint64_t *r = w, *t = w + n, *e = w + 2 * n + 2;
+  superlong_words_load(e, en, exp);
+
+  int started = 0;
+  for (size_t i = a; i-- > 0;) {
+    if (started)
+      superlong_mont_mul(&rep->ctx, r, r, r, t);
+    size_t v = 0;
+    for (unsigned j = rep->teeth; j-- > 0;)
+      v = (v << 1) | (size_t) superlong_words_bit(e, j * a + i);
+    if (v == 0)
+      continue;
+    if (started)
+      superlong_mont_mul(&rep->ctx, r, r, rep->table + v * n, t);
+    else
+      memcpy(r, rep->table + v * n, n * sizeof(uint64_t));
+    started = 1;
+  }
+  if (!started)
+    memcpy(r, rep->ctx.one, n * sizeof(uint64_t));
+  superlong_mont_mul(&rep->ctx, r, r, rep->ctx.unit, t);
+  superlong_words_store(res, r, n);
+  nc_free(w);
+}
+
+// primality
+
+// 0 when a small prime divides n, 2 when n is a small prime or has no factor below its square root,
+// 1 when it is still undecided; n is odd and greater than 2
+static int superlong_trial_division(const superlong* n) {
+  uint32_t products[SUPERLONG_SMALL_PRIMES], residues[SUPERLONG_SMALL_PRIMES];
+  size_t ends[SUPERLONG_SMALL_PRIMES];
+  size_t groups = 0;
+  uint64_t product = 1;
+  for (size_t i = 0; i < SUPERLONG_SMALL_PRIMES; i++) {
+    if (product * superlong_small_primes[i] > UINT32_MAX) {
+      products[groups] = (uint32_t) product;
+      ends[groups++] = i;
+      product = 1;
+    }
+    product *= superlong_small_primes[i];
+  }
+  products[groups] = (uint32_t) product;
+  ends[groups++] = SUPERLONG_SMALL_PRIMES;
+  superlong_mod_ui_multi(n, products, groups, residues);
+
+  uint64_t value = (superlong_bit_length(n) <= 62) ? (uint64_t) superlong_get_int64(n) : 0;
+  for (size_t g = 0, i = 0; g < groups; g++) {
+    for (; i < ends[g]; i++)
+      if (residues[g] % superlong_small_primes[i] == 0)
+        return (value == superlong_small_primes[i]) ? 2 : 0;
+  }
+  return (value != 0 && value < SUPERLONG_TRIAL_LIMIT) ? 2 : 1;
+}
+
+static uint64_t superlong_mulmod64(uint64_t a, uint64_t b, uint64_t m) {
+  return (uint64_t) ((superlong_u128) a * b % m);
+}
+
+// Miller-Rabin with the first twelve prime bases is exact below 3.18 * 10^23, past all of uint64_t
+static int superlong_is_prime64(uint64_t n) {
+  static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  uint64_t d = n - 1;
+  int s = __builtin_ctzll(d);
+  d >>= s;
+  for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+    uint64_t x = 1, b = bases[i] % n, e = d;
+    for (; e > 0; e >>= 1, b = superlong_mulmod64(b, b, n))
+      if (e & 1)
+        x = superlong_mulmod64(x, b, n);
+    if (x == 1 || x == n - 1)
+      continue;
+    int r = 1;
+    for (; r < s; r++) {
+      x = superlong_mulmod64(x, x, n);
+      if (x == n - 1)
+        break;
+    }
+    if (r == s)
+      return 0;
+  }
+  return 1;
+}
+
+// strong probable prime test to base b (Montgomery form) with n - 1 = d 2^s
+static int superlong_miller_rabin(const superlong_mont* ctx, const uint64_t* b, const uint64_t* d, size_t dbits,
+                                  size_t s, uint64_t* w) {
+  size_t n = ctx->n;
+  uint64_t *x = w, *minus_one = w + n, *t = w + 2 * n;
+  superlong_words_sub(minus_one, ctx->m, ctx->one, n);
+  superlong_mont_pow(ctx, x, b, d, dbits, t);
+  if (superlong_words_compare(x, ctx->one, n) == 0 || superlong_words_compare(x, minus_one, n) == 0)
+    return 1;
+  for (size_t r = 1; r < s; r++) {
+    superlong_mont_mul(ctx, x, x, x, t);
+    if (superlong_words_compare(x, minus_one, n) == 0)
+      return 1;
+    if (superlong_words_compare(x, ctx->one, n) == 0)
+      return 0;
+  }
+  return 0;
+}
+
+// Jacobi symbol (a / m) for odd m
+static int superlong_jacobi_u32(uint32_t a, uint32_t m) {
+  int result = 1;
+  a %= m;
+  while (a != 0) {
+    while ((a & 1) == 0) {
+      a >>= 1;
+      if ((m & 7) == 3 || (m & 7) == 5)
+        result = -result;
+    }
+    uint32_t tmp = a;
+    a = m;
+    m = tmp;
+    if ((a & 3) == 3 && (m & 3) == 3)
+      result = -result;
+    a %= m;
+  }
+  return (m == 1) ? result : 0;
+}
+
+// (D / n) for a small odd D and odd n > |D| by quadratic reciprocity
+static int superlong_jacobi_small(int64_t D, const superlong* n) {
+  uint32_t d = (uint32_t) ((D < 0) ? -D : D);
+  unsigned n4 = n->digits.arr[0] & 3;
+  int result = (D < 0 && n4 == 3) ? -1 : 1;
+  if ((d & 3) == 3 && n4 == 3)
+    result = -result;
+  return result * superlong_jacobi_u32(superlong_mod_ui(n, d), d);
+}
+
+// strong Lucas probable prime test with Selfridge's parameters: the first D in 5, -7, 9, -11, ...
+// with (D / n) = -1, P = 1 and Q = (1 - D) / 4
+static int superlong_strong_lucas(const superlong_mont* ctx, const superlong* num, uint64_t* w) {
+  int64_t D = 5;
+  for (int tries = 0;; tries++, D = (D > 0) ? -(D + 2) : -D + 2) {
+    int j = superlong_jacobi_small(D, num);
+    if (j == -1)
+      break;
+    if (j == 0)
+      return 0;
+    if (tries == 16) {
+      // squares never reach (D / n) = -1
+      superlong root;
+      superlong_init(&root);
+      superlong_sqrt(num, &root);
+      superlong_mul(&root, &root, &root);
+      int square = superlong_compare(&root, num) == 0;
+      superlong_deinit(&root);
+      if (square)
+        return 0;
+    }
+  }
+  int64_t Q = (1 - D) / 4;
+
+  size_t n = ctx->n;
+  uint64_t *u = w, *v = w + n, *qk = w + 2 * n, *dm = w + 3 * n, *qm = w + 4 * n, *tmp = w + 5 * n;
+  uint64_t *d = w + 6 * n, *t = w + 7 * n + 1;
+  superlong_mont_from_int(ctx, dm, D, t);
+  superlong_mont_from_int(ctx, qm, Q, t);
+
+  // n + 1 = d 2^s
+  memcpy(d, ctx->m, n * sizeof(uint64_t));
+  d[n] = 0;
+  for (size_t i = 0; i <= n && ++d[i] == 0; i++)
+    ;
+  size_t s = 0;
+  while (!superlong_words_bit(d, s))
+    s++;
+  size_t dbits = superlong_words_bits(d, n + 1);
+
+  // U_1 = 1, V_1 = P = 1, then double and step along the bits of d
+  memcpy(u, ctx->one, n * sizeof(uint64_t));
+  memcpy(v, ctx->one, n * sizeof(uint64_t));
+  memcpy(qk, qm, n * sizeof(uint64_t));
+  for (size_t i = dbits - 1; i-- > s;) {
+    // U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+    superlong_mont_mul(ctx, u, u, v, t);
+    superlong_mont_mul(ctx, v, v, v, t);
+    superlong_mont_sub(ctx, v, v, qk);
+    superlong_mont_sub(ctx, v, v, qk);
+    superlong_mont_mul(ctx, qk, qk, qk, t);
+    if (superlong_words_bit(d, i)) {
+      // U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+      superlong_mont_mul(ctx, tmp, dm, u, t);
+      superlong_mont_add(ctx, u, u, v);
+      superlong_mont_half(ctx, u, u);
+      superlong_mont_add(ctx, v, v, tmp);
+      superlong_mont_half(ctx, v, v);
+      superlong_mont_mul(ctx, qk, qk, qm, t);
+    }
+  }
+  if (superlong_words_is_zero(u, n) || superlong_words_is_zero(v, n))
+    return 1;
+  for (size_t r = 1; r < s; r++) {
+    superlong_mont_mul(ctx, v, v, v, t);
+    superlong_mont_sub(ctx, v, v, qk);
+    superlong_mont_sub(ctx, v, v, qk);
+    if (superlong_words_is_zero(v, n))
+      return 1;
+    superlong_mont_mul(ctx, qk, qk, qk, t);
+  }
+  return 0;
+}
+
+int superlong_probab_prime_p(const superlong* num, int reps) {
+  superlong a;
+  superlong_init(&a);
+  superlong_copy(num, &a);
+  if (!superlong_is_zero(&a))
+    a.sign = 1;
+  int result;
+  size_t bits = superlong_bit_length(&a);
+  if (bits <= 1)
+    result = 0;
+  else if ((a.digits.arr[0] & 1) == 0)
+    result = (bits == 2 && a.digits.arr[0] == 2) ? 2 : 0;
+  else if ((result = superlong_trial_division(&a)) != 1)
+    ;
+  else if (bits <= 64) {
+    uint64_t value;
+    superlong_words_load(&value, 1, &a);
+    result = superlong_is_prime64(value) ? 2 : 0;
+  } else {
+    superlong_mont ctx;
+    superlong_mont_init(&ctx, &a);
+    size_t n = ctx.n;
+    uint64_t* w = nc_malloc((10 * n + 4) * sizeof(uint64_t));
+    uint64_t *b = w, *d = w + n, *scratch = w + 2 * n;
+
+    // n - 1 = d 2^s
+    memcpy(d, ctx.m, n * sizeof(uint64_t));
+    d[0] ^= 1;
+    size_t s = 0;
+    while (!superlong_words_bit(d, s))
+      s++;
+    size_t dbits = superlong_words_bits(d, n);
+    for (size_t i = 0; i < n; i++)
+      d[i] = (d[i] >> (s % 64)) | ((s % 64 && i + 1 < n) ? d[i + 1] << (64 - s % 64) : 0);
+    for (size_t shift = s / 64; shift > 0; shift--) {
+      memmove(d, d + 1, (n - 1) * sizeof(uint64_t));
+      d[n - 1] = 0;
+    }
+    dbits -= s;
+
+    superlong_mont_add(&ctx, b, ctx.one, ctx.one);
+    result = superlong_miller_rabin(&ctx, b, d, dbits, s, scratch) && superlong_strong_lucas(&ctx, &a, scratch);
+    // further rounds with bases from a generator seeded by n
+    uint64_t state = ctx.m[0] ^ 0x9E3779B97F4A7C15ull;
+    for (int r = SUPERLONG_BPSW_REPS; result && r < reps; r++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      memset(b, 0, n * sizeof(uint64_t));
+      b[0] = state | 2;
+      superlong_mont_mul(&ctx, b, b, ctx.r2, scratch);
+      result = superlong_miller_rabin(&ctx, b, d, dbits, s, scratch);
+    }
+    nc_free(w);
+    superlong_mont_deinit(&ctx);
+  }
+  superlong_deinit(&a);
+  return result;
+}
+
+void superlong_nextprime(const superlong* num, superlong* res) {
+  superlong c;
+  superlong_init(&c);
+  superlong_from_uint(&c, 2);
+  if (superlong_compare(num, &c) < 0) {
+    superlong_deinit(res);
+    *res = c;
+    return;
+  }
+  superlong_add_uint(num, 1, &c);
+  if ((c.digits.arr[0] & 1) == 0)
+    superlong_add_uint(&c, 1, &c);
+  if (superlong_bit_length(&c) <= 32) {
+    // the sieve primes could be candidates themselves
+    while (!superlong_probab_prime_p(&c, SUPERLONG_BPSW_REPS + 1))
+      superlong_add_uint(&c, 2, &c);
+    superlong_deinit(res);
+    *res = c;
+    return;
+  }
+
+  // residues of the window start modulo the sieve primes, from products of a few primes each
+  uint8_t* composite = superlong_sieve(SUPERLONG_NEXTPRIME_SIEVE);
+  size_t count = 0;
+  uint32_t* primes = nc_malloc(SUPERLONG_NEXTPRIME_SIEVE / 2 * sizeof(uint32_t));
+  for (uint32_t p = 3; p < SUPERLONG_NEXTPRIME_SIEVE; p += 2)
+    if (superlong_sieve_is_prime(composite, p))
+      primes[count++] = p;
+  nc_free(composite);
+  uint32_t* residues = nc_malloc(count * sizeof(uint32_t));
+  uint32_t* products = nc_malloc(count * sizeof(uint32_t));
+  size_t* firsts = nc_malloc((count + 1) * sizeof(size_t));
+  size_t groups = 0;
+  for (size_t i = 0; i < count;) {
+    uint64_t product = 1;
+    firsts[groups] = i;
+    while (i < count && product * primes[i] <= UINT32_MAX)
+      product *= primes[i++];
+    products[groups++] = (uint32_t) product;
+  }
+  firsts[groups] = count;
+  superlong_mod_ui_multi(&c, products, groups, residues);
+  // every group holds a prime, so splitting from the last group down runs in place
+  for (size_t g = groups; g-- > 0;) {
+    uint32_t r = residues[g];
+    for (size_t i = firsts[g]; i < firsts[g + 1]; i++)
+      residues[i] = r % primes[i];
+  }
+  nc_free(products);
+  nc_free(firsts);
+
+  // bit i of the window stands for c + 2i
+  uint8_t sieve[SUPERLONG_NEXTPRIME_WINDOW / 8];
+  superlong candidate;
+  superlong_init(&candidate);
+  for (;;) {
+    memset(sieve, 0, sizeof(sieve));
+    for (size_t i = 0; i < count; i++) {
+      // c + 2i = 0 mod p at i = -r / 2 = (p - r) (p + 1) / 2 mod p
+      uint32_t p = primes[i];
+      uint64_t first = (uint64_t) (p - residues[i]) % p * ((p + 1) / 2) % p;
+      for (uint64_t j = first; j < SUPERLONG_NEXTPRIME_WINDOW; j += p)
+        sieve[j / 8] |= (uint8_t) (1u << (j % 8));
+      residues[i] = (uint32_t) ((residues[i] + 2 * SUPERLONG_NEXTPRIME_WINDOW) % p);
+    }
+    for (size_t j = 0; j < SUPERLONG_NEXTPRIME_WINDOW; j++) {
+      if (sieve[j / 8] & (1u << (j % 8)))
+        continue;
+      superlong_add_uint(&c, (uint32_t) (2 * j), &candidate);
+      if (superlong_probab_prime_p(&candidate, SUPERLONG_BPSW_REPS + 1)) {
+        superlong_deinit(res);
+        *res = candidate;
+        superlong_deinit(&c);
+        nc_free(primes);
+        nc_free(residues);
+        return;
+      }
+    }
+    superlong_add_uint(&c, 2 * SUPERLONG_NEXTPRIME_WINDOW, &c);
+  }
+}
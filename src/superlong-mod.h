@@ -0,0 +1,54 @@
+#ifndef SUPERLONG_MOD_H
+#define SUPERLONG_MOD_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Modular arithmetic. Odd moduli run on Montgomery multiplication over 64-bit words, even ones
+// split into a power of two and an odd part joined by the CRT. Results are in [0, |mod|); a zero
+// modulus aborts like division by zero and so does a negative exponent.
+
+// base^exp mod m for one base and many exponents, from a comb table built once by init for
+// exponents of up to bits bits: about 2 bits / h multiplications per call with h = 4..8 teeth,
+// against about 1.2 bits for superlong_powmod. Longer exponents and even moduli fall back to
+// superlong_powmod. The table is only read, so one object may serve several threads
+typedef struct superlong_fixed_base_rep superlong_fixed_base_rep;
+
+typedef struct {
+  superlong_fixed_base_rep* rep;
+} superlong_fixed_base;
+
+// |a| mod each of d[0..count) in one pass over the digits of a
+void superlong_mod_ui_multi(const superlong* a, const uint32_t* d, size_t count, uint32_t* out);
+
+void superlong_powmod(const superlong* base, const superlong* exp, const superlong* mod, superlong* res);
+
+// prod of bases[i]^exps[i] mod m with one chain of squarings shared by all exponents (Straus);
+// even moduli multiply separate powers
+void superlong_powmod_multi(const superlong* const* bases, const superlong* const* exps, size_t n,
+                            const superlong* mod, superlong* res);
+
+void superlong_fixed_base_init(superlong_fixed_base*, const superlong* base, const superlong* mod, size_t bits);
+void superlong_fixed_base_deinit(superlong_fixed_base*);
+void superlong_fixed_base_powmod(const superlong_fixed_base*, const superlong* exp, superlong* res);
+
+// 2 when |n| is certainly prime, 1 when it is probably prime, 0 when it is composite, like GMP.
+// Trial division by the primes below 1000, then a deterministic Miller-Rabin set below 2^64 and
+// Baillie-PSW (a base-2 strong test and a strong Lucas test) above it, followed by reps - 24 more
+// Miller-Rabin rounds when reps exceeds 24
+int superlong_probab_prime_p(const superlong* n, int reps);
+
+// smallest probable prime greater than n, candidates are sieved a window at a time
+void superlong_nextprime(const superlong* n, superlong* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,571 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "superlong-ooc.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t superlong_ooc_budget = (size_t) 64 << 20;
+
+void superlong_ooc_set_budget(size_t bytes) { superlong_ooc_budget = bytes; }
+
+size_t superlong_ooc_get_budget(void) { return superlong_ooc_budget; }
+
+// one of `parts` equal shares of the budget, rounded down to whole pages times `align`
+static size_t superlong_ooc_window(size_t parts, size_t align) {
+  size_t unit = (size_t) sysconf(_SC_PAGESIZE) * align;
+  size_t window = superlong_ooc_budget / parts / unit * unit;
+  return (window > unit) ? window : unit;
+}
+
+typedef struct {
+  void* map;
+  size_t map_len;
+  n256* digits;
+} superlong_ooc_map;
+
+// maps digits [off, off + len) of fd; mmap offsets must be page aligned, so the map may start earlier
+static int superlong_ooc_map_window(int fd, size_t off, size_t len, int writable, superlong_ooc_map* m) {
+  m->map = NULL;
+  m->map_len = 0;
+  m->digits = NULL;
+  if (len == 0)
+    return 0;
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  size_t start = off / page * page;
+  m->map_len = off + len - start;
+  m->map = mmap(NULL, m->map_len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, (off_t) start);
+  if (m->map == MAP_FAILED) {
+    m->map = NULL;
+    return -1;
+  }
+  m->digits = (n256*) m->map + (off - start);
+  return 0;
+}
+
+static void superlong_ooc_unmap(superlong_ooc_map* m) {
+  if (m->map)
+    munmap(m->map, m->map_len);
+  m->map = NULL;
+}
+
+int superlong_ooc_open(superlong_ooc* num, const char* path, int create) {
+  num->fd = open(path, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+  num->len = 0;
+  num->sign = 0;
+  if (num->fd < 0)
+    return -1;
+  struct stat st;
+  if (fstat(num->fd, &st) != 0) {
+    close(num->fd);
+    num->fd = -1;
+    return -1;
+  }
+  num->len = (size_t) st.st_size;
+  num->sign = (num->len > 0) ? 1 : 0;
+  return 0;
+}
+
+void superlong_ooc_close(superlong_ooc* num) {
+  if (num->fd >= 0)
+    close(num->fd);
+  num->fd = -1;
+  num->len = 0;
+  num->sign = 0;
+}
+
+// drops leading zero digits from the file
+static int superlong_ooc_trim(superlong_ooc* num) {
+  size_t window = superlong_ooc_window(1, 1);
+  while (num->len > 0) {
+    size_t off = (num->len > window) ? num->len - window : 0;
+    superlong_ooc_map m;
+    if (superlong_ooc_map_window(num->fd, off, num->len - off, 0, &m) != 0)
+      return -1;
+    size_t top = num->len - off;
+    while (top > 0 && m.digits[top - 1] == 0)
+      top--;
+    superlong_ooc_unmap(&m);
+    num->len = off + top;
+    if (top > 0)
+      break;
+  }
+  if (num->len == 0)
+    num->sign = 0;
+  return ftruncate(num->fd, (off_t) num->len);
+}
+
+// pread and pwrite of exactly len bytes, resumed after short transfers
+static int superlong_ooc_pread(int fd, void* buf, size_t len, size_t off) {
+  for (size_t done = 0; done < len;) {
+    ssize_t got = pread(fd, (n256*) buf + done, len - done, (off_t) (off + done));
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return -1;
+    done += (size_t) got;
+  }
+  return 0;
+}
+
+static int superlong_ooc_pwrite(int fd, const void* buf, size_t len, size_t off) {
+  for (size_t done = 0; done < len;) {
+    ssize_t written = pwrite(fd, (const n256*) buf + done, len - done, (off_t) (off + done));
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return -1;
+    done += (size_t) written;
+  }
+  return 0;
+}
+
+// an unlinked scratch file of len zero digits under $TMPDIR, closed by the caller
+static int superlong_ooc_scratch(size_t len) {
+  const char* dir = getenv("TMPDIR");
+  if (dir == NULL || *dir == '\0')
+    dir = "/tmp";
+  char* path = nc_malloc(strlen(dir) + sizeof("/superlong-ooc-XXXXXX"));
+  strcpy(path, dir);
+  strcat(path, "/superlong-ooc-XXXXXX");
+  int fd = mkstemp(path);
+  if (fd >= 0)
+    unlink(path);
+  nc_free(path);
+  if (fd >= 0 && ftruncate(fd, (off_t) len) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int superlong_ooc_set(superlong_ooc* num, const superlong* src) {
+  size_t len = superlong_is_zero(src) ? 0 : src->digits.len;
+  if (ftruncate(num->fd, 0) != 0 || superlong_ooc_pwrite(num->fd, src->digits.arr, len, 0) != 0)
+    return -1;
+  num->len = len;
+  num->sign = (len > 0) ? src->sign : 0;
+  return superlong_ooc_trim(num);
+}
+
+int superlong_ooc_get(const superlong_ooc* num, superlong* res) {
+  n256* buf = nc_malloc(num->len > 0 ? num->len : 1);
+  if (superlong_ooc_pread(num->fd, buf, num->len, 0) != 0) {
+    nc_free(buf);
+    return -1;
+  }
+  superlong_import(res, num->len, -1, 1, -1, buf);
+  if (num->sign < 0)
+    superlong_negate(res);
+  nc_free(buf);
+  return 0;
+}
+
+// compares |a| and |b| from the top window down
+static int superlong_ooc_abs_compare(const superlong_ooc* a, const superlong_ooc* b, int* cmp) {
+  *cmp = 0;
+  if (a->len != b->len) {
+    *cmp = (a->len > b->len) ? 1 : -1;
+    return 0;
+  }
+  size_t window = superlong_ooc_window(2, 1);
+  for (size_t end = a->len; end > 0 && *cmp == 0;) {
+    size_t off = (end > window) ? end - window : 0;
+    superlong_ooc_map ma, mb;
+    if (superlong_ooc_map_window(a->fd, off, end - off, 0, &ma) != 0)
+      return -1;
+    if (superlong_ooc_map_window(b->fd, off, end - off, 0, &mb) != 0) {
+      superlong_ooc_unmap(&ma);
+      return -1;
+    }
+    for (size_t i = end - off; i-- > 0;) {
+      if (ma.digits[i] != mb.digits[i]) {
+        *cmp = (ma.digits[i] > mb.digits[i]) ? 1 : -1;
+        break;
+      }
+    }
+    superlong_ooc_unmap(&ma);
+    superlong_ooc_unmap(&mb);
+    end = off;
+  }
+  return 0;
+}
+
+int superlong_ooc_compare(const superlong_ooc* a, const superlong_ooc* b) {
+  if (a->sign != b->sign)
+    return (a->sign > b->sign) ? 1 : -1;
+  int cmp = 0;
+  if (a->sign == 0 || superlong_ooc_abs_compare(a, b, &cmp) != 0)
+    return 0;
+  return a->sign * cmp;
+}
+
+// digits [off, off + len) of a file
+typedef struct {
+  int fd;
+  size_t off;
+  size_t len;
+} superlong_ooc_range;
+
+// res = x + y, or x - y when sub and x >= y, over the res.len digits of res, streaming up from
+// the low digits; x and y are at most that long. Every digit is read before the same index is
+// written, so res may be x or y itself
+static int superlong_ooc_range_addsub(superlong_ooc_range x, superlong_ooc_range y, superlong_ooc_range res, int sub) {
+  size_t n = res.len;
+  size_t window = superlong_ooc_window(3, 1);
+  int carry = 0;
+  for (size_t off = 0; off < n; off += window) {
+    size_t k = (n - off < window) ? n - off : window;
+    size_t kx = (off < x.len) ? ((x.len - off < k) ? x.len - off : k) : 0;
+    size_t ky = (off < y.len) ? ((y.len - off < k) ? y.len - off : k) : 0;
+    superlong_ooc_map mx, my, mr;
+    int failed = superlong_ooc_map_window(x.fd, x.off + off, kx, 0, &mx) != 0;
+    failed |= superlong_ooc_map_window(y.fd, y.off + off, ky, 0, &my) != 0;
+    failed |= superlong_ooc_map_window(res.fd, res.off + off, k, 1, &mr) != 0;
+    for (size_t i = 0; i < k && !failed; i++) {
+      int t = carry + ((i < kx) ? mx.digits[i] : 0);
+      if (i < ky)
+        t += sub ? -my.digits[i] : my.digits[i];
+      mr.digits[i] = (n256) t;
+      carry = (t < 0) ? -1 : (t >> 8);
+    }
+    superlong_ooc_unmap(&mx);
+    superlong_ooc_unmap(&my);
+    superlong_ooc_unmap(&mr);
+    if (failed)
+      return -1;
+  }
+  return 0;
+}
+
+// |res| = |x| + |y|, or |x| - |y| when sub and |x| >= |y|; res may share a file with x or y
+static int superlong_ooc_abs_addsub(const superlong_ooc* x, const superlong_ooc* y, superlong_ooc* res, int sub) {
+  size_t n = x->len + (sub ? 0 : 1);
+  if (n > res->len && ftruncate(res->fd, (off_t) n) != 0)
+    return -1;
+  superlong_ooc_range rx = {x->fd, 0, x->len};
+  superlong_ooc_range ry = {y->fd, 0, y->len};
+  superlong_ooc_range rr = {res->fd, 0, n};
+  if (superlong_ooc_range_addsub(rx, ry, rr, sub) != 0)
+    return -1;
+  res->len = n;
+  return 0;
+}
+
+static int superlong_ooc_addsub(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res, int bsign) {
+  int asign = a->sign;
+  bsign *= b->sign;
+  int sign;
+  if (asign == 0 || bsign == 0) {
+    // copy the nonzero side through the streaming path
+    const superlong_ooc* src = (asign == 0) ? b : a;
+    superlong_ooc zero = {src->fd, 0, 0};
+    if (superlong_ooc_abs_addsub(src, &zero, res, 1) != 0)
+      return -1;
+    sign = (asign == 0) ? bsign : asign;
+  } else if (asign == bsign) {
+    const superlong_ooc* x = (a->len >= b->len) ? a : b;
+    if (superlong_ooc_abs_addsub(x, (x == a) ? b : a, res, 0) != 0)
+      return -1;
+    sign = asign;
+  } else {
+    int cmp;
+    if (superlong_ooc_abs_compare(a, b, &cmp) != 0)
+      return -1;
+    const superlong_ooc* x = (cmp >= 0) ? a : b;
+    if (superlong_ooc_abs_addsub(x, (x == a) ? b : a, res, 1) != 0)
+      return -1;
+    sign = (cmp >= 0) ? asign : bsign;
+  }
+  res->sign = sign;
+  return superlong_ooc_trim(res);
+}
+
+int superlong_ooc_add(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res) {
+  return superlong_ooc_addsub(a, b, res, 1);
+}
+
+int superlong_ooc_sub(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res) {
+  return superlong_ooc_addsub(a, b, res, -1);
+}
+
+static int superlong_ooc_range_zero(superlong_ooc_range r) {
+  size_t window = superlong_ooc_window(1, 1);
+  for (size_t off = 0; off < r.len; off += window) {
+    size_t k = (r.len - off < window) ? r.len - off : window;
+    superlong_ooc_map m;
+    if (superlong_ooc_map_window(r.fd, r.off + off, k, 1, &m) != 0)
+      return -1;
+    memset(m.digits, 0, k);
+    superlong_ooc_unmap(&m);
+  }
+  return 0;
+}
+
+// out = x y in memory, by superlong_mul and whichever in-core algorithm it picks
+static int superlong_ooc_range_mul_core(superlong_ooc_range x, superlong_ooc_range y, superlong_ooc_range out) {
+  superlong_ooc_map mx, my, mo;
+  int failed = superlong_ooc_map_window(x.fd, x.off, x.len, 0, &mx) != 0;
+  failed |= superlong_ooc_map_window(y.fd, y.off, y.len, 0, &my) != 0;
+  failed |= superlong_ooc_map_window(out.fd, out.off, out.len, 1, &mo) != 0;
+  if (!failed) {
+    superlong a = superlong_view_borrow(superlong_view_from_buffer(mx.digits, x.len, 1));
+    superlong b = superlong_view_borrow(superlong_view_from_buffer(my.digits, y.len, 1));
+    superlong prod;
+    superlong_init(&prod);
+    superlong_mul(&a, &b, &prod);
+    size_t k = superlong_is_zero(&prod) ? 0 : prod.digits.len;
+    memcpy(mo.digits, prod.digits.arr, k);
+    memset(mo.digits + k, 0, out.len - k);
+    superlong_deinit(&prod);
+  }
+  superlong_ooc_unmap(&mx);
+  superlong_ooc_unmap(&my);
+  superlong_ooc_unmap(&mo);
+  return failed ? -1 : 0;
+}
+
+// out = x y over the x.len + y.len digits of out, which must not overlap x or y. Operands that
+// fit an eighth of the budget together are multiplied in memory; larger ones by Karatsuba over
+// the files, with the half sums and the middle product in a scratch file per level, and a short
+// y against a long x one y-sized piece of x at a time
+static int superlong_ooc_range_mul(superlong_ooc_range x, superlong_ooc_range y, superlong_ooc_range out) {
+  if (x.len < y.len) {
+    superlong_ooc_range t = x;
+    x = y;
+    y = t;
+  }
+  if (y.len == 0)
+    return superlong_ooc_range_zero(out);
+  if (x.len + y.len <= superlong_ooc_window(8, 1))
+    return superlong_ooc_range_mul_core(x, y, out);
+
+  size_t h = (x.len + 1) / 2;
+  if (y.len <= h) {
+    // the product so far stays below the digit the next piece starts at plus y.len, so each
+    // piece's product is added over its own length without a carry out
+    int fd = superlong_ooc_scratch(2 * y.len);
+    if (fd < 0 || superlong_ooc_range_zero(out) != 0) {
+      if (fd >= 0)
+        close(fd);
+      return -1;
+    }
+    int failed = 0;
+    for (size_t i = 0; i < x.len && !failed; i += y.len) {
+      size_t k = (x.len - i < y.len) ? x.len - i : y.len;
+      superlong_ooc_range piece = {x.fd, x.off + i, k};
+      superlong_ooc_range prod = {fd, 0, k + y.len};
+      superlong_ooc_range dst = {out.fd, out.off + i, k + y.len};
+      failed = superlong_ooc_range_mul(piece, y, prod) != 0 || superlong_ooc_range_addsub(dst, prod, dst, 0) != 0;
+    }
+    close(fd);
+    return failed ? -1 : 0;
+  }
+
+  // x = x1 B^h + x0, y = y1 B^h + y0: z0 = x0 y0 and z2 = x1 y1 go straight into out,
+  // z1 = (x0 + x1)(y0 + y1) - z0 - z2 is added in at digit h
+  superlong_ooc_range x0 = {x.fd, x.off, h}, x1 = {x.fd, x.off + h, x.len - h};
+  superlong_ooc_range y0 = {y.fd, y.off, h}, y1 = {y.fd, y.off + h, y.len - h};
+  superlong_ooc_range z0 = {out.fd, out.off, 2 * h}, z2 = {out.fd, out.off + 2 * h, out.len - 2 * h};
+  int fd = superlong_ooc_scratch(4 * h + 4);
+  if (fd < 0)
+    return -1;
+  superlong_ooc_range sx = {fd, 0, h + 1}, sy = {fd, h + 1, h + 1}, z1 = {fd, 2 * h + 2, 2 * h + 2};
+  int failed = superlong_ooc_range_mul(x0, y0, z0) != 0 || superlong_ooc_range_mul(x1, y1, z2) != 0 ||
+               superlong_ooc_range_addsub(x0, x1, sx, 0) != 0 || superlong_ooc_range_addsub(y0, y1, sy, 0) != 0 ||
+               superlong_ooc_range_mul(sx, sy, z1) != 0 || superlong_ooc_range_addsub(z1, z0, z1, 1) != 0 ||
+               superlong_ooc_range_addsub(z1, z2, z1, 1) != 0;
+  if (!failed) {
+    // z1 fits below the top of out, its digits above that are zero
+    superlong_ooc_range mid = {out.fd, out.off + h, out.len - h};
+    if (z1.len > mid.len)
+      z1.len = mid.len;
+    failed = superlong_ooc_range_addsub(mid, z1, mid, 0) != 0;
+  }
+  close(fd);
+  return failed ? -1 : 0;
+}
+
+int superlong_ooc_mul(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res) {
+  if (ftruncate(res->fd, 0) != 0)
+    return -1;
+  res->len = 0;
+  res->sign = 0;
+  if (a->sign == 0 || b->sign == 0)
+    return 0;
+  res->len = a->len + b->len;
+  if (ftruncate(res->fd, (off_t) res->len) != 0)
+    return -1;
+  superlong_ooc_range x = {a->fd, 0, a->len};
+  superlong_ooc_range y = {b->fd, 0, b->len};
+  superlong_ooc_range out = {res->fd, 0, res->len};
+  if (superlong_ooc_range_mul(x, y, out) != 0)
+    return -1;
+  res->sign = a->sign * b->sign;
+  return superlong_ooc_trim(res);
+}
+
+static int superlong_ooc_zeros(superlong_sink sink, void* ctx, size_t count) {
+  static const char zeros[] = "0000000000000000000000000000000000000000000000000000000000000000";
+  while (count > 0) {
+    size_t step = (count < sizeof(zeros) - 1) ? count : sizeof(zeros) - 1;
+    if (sink(ctx, zeros, step) != 0)
+      return -1;
+    count -= step;
+  }
+  return 0;
+}
+
+// one pass of long division of src[0, *len) by the m words of d, streaming from the top a block
+// of bw words at a time with the running remainder in memory: the quotient goes to the same
+// digits of dst, which may be src, *len becomes its length and rem receives the remainder
+static int superlong_ooc_divrem_pass(int src, int dst, size_t* len, const uint32_t* d, size_t m, size_t bw,
+                                     uint32_t* rem) {
+  uint32_t* u = nc_malloc((bw + m + 1) * sizeof(uint32_t));
+  n256* bytes = nc_malloc(bw * 4);
+  memset(rem, 0, m * sizeof(uint32_t));
+  size_t n = *len;
+  size_t qlen = 0;
+  int failed = 0;
+  for (size_t top = (n + 3) / 4; top > 0 && !failed;) {
+    size_t lo = (top > bw) ? top - bw : 0;
+    size_t k = top - lo;
+    size_t kb = ((4 * top < n) ? 4 * top : n) - 4 * lo;
+    if (superlong_ooc_pread(src, bytes, kb, 4 * lo) != 0) {
+      failed = 1;
+      break;
+    }
+    memset(bytes + kb, 0, 4 * k - kb);
+    for (size_t i = 0; i < k; i++)
+      u[i] = (uint32_t) bytes[4 * i] | (uint32_t) bytes[4 * i + 1] << 8 | (uint32_t) bytes[4 * i + 2] << 16 |
+             (uint32_t) bytes[4 * i + 3] << 24;
+    memcpy(u + k, rem, m * sizeof(uint32_t));
+    u[k + m] = 0;
+    superlong_words_divrem(u, k + m, d, m);
+    memcpy(rem, u, m * sizeof(uint32_t));
+    for (size_t i = 0; i < k; i++)
+      for (int j = 0; j < 4; j++)
+        bytes[4 * i + j] = (n256) (u[m + i] >> (8 * j));
+    for (size_t i = kb; qlen == 0 && i-- > 0;)
+      if (bytes[i] != 0)
+        qlen = 4 * lo + i + 1;
+    failed = superlong_ooc_pwrite(dst, bytes, kb, 4 * lo) != 0;
+    top = lo;
+  }
+  nc_free(u);
+  nc_free(bytes);
+  *len = qlen;
+  return failed ? -1 : 0;
+}
+
+// Other bases beyond a quarter of the budget: repeated division by d = big^c, a power of the
+// chunk radix kept near 1/32 of the budget, peels blocks of c chunks off the low end into a
+// scratch file, each pass streaming the quotient from the top. Once the quotient fits in memory
+// it is written first, then the blocks from the highest down, zero padded to c chunks
+static int superlong_ooc_out_radix(superlong_sink sink, void* ctx, int base, const superlong_ooc* num) {
+  unsigned width;
+  uint32_t big = superlong_radix_chunk(base, &width);
+  size_t c = 1;
+  while (8 * c <= superlong_ooc_budget / 32)
+    c *= 2;
+  superlong tmp;
+  superlong_init(&tmp);
+  superlong_from_uint(&tmp, big);
+  superlong_pow_ui(&tmp, c, &tmp);
+  size_t m = (tmp.digits.len + 3) / 4;
+  uint32_t* d = nc_malloc(m * sizeof(uint32_t));
+  memset(d, 0, m * sizeof(uint32_t));
+  for (size_t i = 0; i < tmp.digits.len; i++)
+    d[i / 4] |= (uint32_t) tmp.digits.arr[i] << (8 * (i % 4));
+  size_t bw = superlong_ooc_budget / 128 + 1;
+  uint32_t* rem = nc_malloc(m * sizeof(uint32_t));
+
+  int quotient = superlong_ooc_scratch(num->len);
+  int blocks = superlong_ooc_scratch(0);
+  int failed = quotient < 0 || blocks < 0;
+  size_t len = num->len;
+  size_t count = 0;
+  for (int src = num->fd; !failed && len > superlong_ooc_budget / 4; src = quotient, count++)
+    failed = superlong_ooc_divrem_pass(src, quotient, &len, d, m, bw, rem) != 0 ||
+             superlong_ooc_pwrite(blocks, rem, m * sizeof(uint32_t), count * m * sizeof(uint32_t)) != 0;
+
+  if (!failed) {
+    superlong_ooc top = {quotient, len, 1};
+    failed = superlong_ooc_get(&top, &tmp) != 0 || superlong_out_sink(sink, ctx, base, &tmp) != 0;
+  }
+  while (!failed && count-- > 0) {
+    failed = superlong_ooc_pread(blocks, rem, m * sizeof(uint32_t), count * m * sizeof(uint32_t)) != 0;
+    if (failed)
+      break;
+    superlong_import(&tmp, m, -1, sizeof(uint32_t), 0, rem);
+    char* str = superlong_to_str(&tmp, base);
+    size_t used = strlen(str);
+    failed = superlong_ooc_zeros(sink, ctx, c * width - used) != 0 || sink(ctx, str, used) != 0;
+    free(str);
+  }
+  if (quotient >= 0)
+    close(quotient);
+  if (blocks >= 0)
+    close(blocks);
+  nc_free(rem);
+  nc_free(d);
+  superlong_deinit(&tmp);
+  return failed ? -1 : 0;
+}
+
+int superlong_ooc_out_sink(superlong_sink sink, void* ctx, int base, const superlong_ooc* num) {
+  if (base < 2 || base > 62)
+    return -1;
+  if (num->sign == 0)
+    return sink(ctx, "0", 1);
+  if ((base & (base - 1)) != 0) {
+    if (num->len > superlong_ooc_budget / 4) {
+      if (num->sign < 0 && sink(ctx, "-", 1) != 0)
+        return -1;
+      return superlong_ooc_out_radix(sink, ctx, base, num);
+    }
+    superlong tmp;
+    superlong_init(&tmp);
+    int rc = superlong_ooc_get(num, &tmp);
+    if (rc == 0)
+      rc = superlong_out_sink(sink, ctx, base, &tmp);
+    superlong_deinit(&tmp);
+    return rc;
+  }
+
+  // a window of `width` pages holds a whole number of width-bit characters
+  unsigned width = (unsigned) __builtin_ctz((unsigned) base);
+  size_t window = superlong_ooc_window(4, width);
+  size_t chars = window * 8 / width;
+  if (num->sign < 0 && sink(ctx, "-", 1) != 0)
+    return -1;
+  size_t top = (num->len - 1) / window * window;
+  for (size_t off = top + window; off > 0;) {
+    off -= window;
+    size_t k = (num->len - off < window) ? num->len - off : window;
+    superlong_ooc_map m;
+    if (superlong_ooc_map_window(num->fd, off, k, 0, &m) != 0)
+      return -1;
+    superlong part = superlong_view_borrow(superlong_view_from_buffer(m.digits, k, 1));
+    char* str = superlong_to_str(&part, base);
+    superlong_ooc_unmap(&m);
+    // below the top window the leading zeros are significant
+    size_t len = strlen(str);
+    int rc = superlong_ooc_zeros(sink, ctx, (off == top) ? 0 : chars - len);
+    if (rc == 0)
+      rc = sink(ctx, str, len);
+    free(str);
+    if (rc != 0)
+      return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef SUPERLONG_OOC_H
+#define SUPERLONG_OOC_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Out-of-core number: the magnitude lives in a file of raw little-endian digits that is
+// mapped a window at a time, the sign lives in the struct. Operations stream over the files
+// and keep their mapped windows and in-memory temporaries within the budget set by
+// superlong_ooc_set_budget (64 MiB by default); intermediate files are created unlinked under
+// $TMPDIR (/tmp when unset). Functions return 0 or -1 on I/O errors.
+typedef struct {
+  int fd;
+  size_t len;
+  int sign;
+} superlong_ooc;
+
+void superlong_ooc_set_budget(size_t bytes);
+size_t superlong_ooc_get_budget(void);
+
+// create truncates the file to an empty number, otherwise its contents are a positive magnitude
+int superlong_ooc_open(superlong_ooc*, const char* path, int create);
+void superlong_ooc_close(superlong_ooc*);
+
+int superlong_ooc_set(superlong_ooc*, const superlong* num);
+int superlong_ooc_get(const superlong_ooc*, superlong* res);
+
+// add and sub allow res to be either operand, mul needs a distinct res. mul recurses by
+// Karatsuba over file-backed halves and multiplies in memory once both fit an eighth of the budget
+int superlong_ooc_add(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res);
+int superlong_ooc_sub(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res);
+int superlong_ooc_mul(const superlong_ooc* a, const superlong_ooc* b, superlong_ooc* res);
+int superlong_ooc_compare(const superlong_ooc*, const superlong_ooc*);
+
+// power-of-two bases stream window by window; other bases split numbers past a quarter of the
+// budget by repeated streaming division by a power of the base, printing the blocks from the top
+int superlong_ooc_out_sink(superlong_sink sink, void* ctx, int base, const superlong_ooc* num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,490 @@
+#include "superlong-rns.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+#include "superlong-mod.h"
+#include "superlong-series.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SUPERLONG_RNS_AVX2
+#endif
+
+__extension__ typedef unsigned __int128 superlong_rns_u128;
+
+// odd numbers per segment when sieving for primes below 2^31, and the sieving primes' bound
+#define SUPERLONG_RNS_SEGMENT 65536
+#define SUPERLONG_RNS_SIEVE 46341
+
+// tree nodes of at most this many primes are handled with word operations, prime by prime
+#define SUPERLONG_RNS_LEAF 512
+
+// at least this many residues go to each thread
+#define SUPERLONG_RNS_PARALLEL_MIN (1 << 15)
+
+// word-sized Montgomery arithmetic with R = 2^32: p < 2^31 keeps every sum below 2^32 and
+// x y + q p below 2^64
+
+static uint32_t superlong_rns_mont_mul(uint32_t x, uint32_t y, uint32_t p, uint32_t minv) {
+  uint64_t t = (uint64_t) x * y;
+  uint32_t q = (uint32_t) t * minv;
+  uint32_t u = (uint32_t) ((t + (uint64_t) q * p) >> 32);
+  return (u >= p) ? u - p : u;
+}
+
+static uint32_t superlong_rns_pow(uint32_t x, uint32_t e, uint32_t p) {
+  uint64_t r = 1, b = x % p;
+  for (; e > 0; e >>= 1, b = b * b % p)
+    if (e & 1)
+      r = r * b % p;
+  return (uint32_t) r;
+}
+
+// the count largest primes below 2^31, by a segmented sieve going down from the top
+static void superlong_rns_primes(uint32_t* out, size_t count) {
+  uint8_t* composite = superlong_sieve(SUPERLONG_RNS_SIEVE);
+  uint32_t* small = nc_malloc(SUPERLONG_RNS_SIEVE / 2 * sizeof(uint32_t));
+  size_t nsmall = 0;
+  for (uint32_t q = 3; q < SUPERLONG_RNS_SIEVE; q += 2)
+    if (superlong_sieve_is_prime(composite, q))
+      small[nsmall++] = q;
+  nc_free(composite);
+
+  uint8_t* segment = nc_malloc(SUPERLONG_RNS_SEGMENT);
+  uint64_t hi = (uint64_t) 1 << 31;
+  size_t found = 0;
+  while (found < count) {
+    // entry k stands for the odd number lo + 1 + 2k
+    uint64_t lo = hi - 2 * SUPERLONG_RNS_SEGMENT;
+    memset(segment, 0, SUPERLONG_RNS_SEGMENT);
+    for (size_t i = 0; i < nsmall; i++) {
+      uint64_t q = small[i];
+      uint64_t m = (lo + q) / q * q;
+      if ((m & 1) == 0)
+        m += q;
+      for (; m < hi; m += 2 * q)
+        segment[(m - lo - 1) / 2] = 1;
+    }
+    for (size_t k = SUPERLONG_RNS_SEGMENT; k-- > 0 && found < count;)
+      if (!segment[k])
+        out[found++] = (uint32_t) (lo + 1 + 2 * k);
+    hi = lo;
+  }
+  nc_free(segment);
+  nc_free(small);
+}
+
+// a mod m for a >= 0 and m > 0
+static void superlong_rns_reduce(const superlong* a, const superlong* m, superlong* res) {
+  superlong q, r;
+  superlong_init(&q);
+  superlong_init(&r);
+  superlong_div_newton(a, m, &q);
+  superlong_copy(a, &r);
+  superlong_submul(&q, m, &r);
+  superlong_deinit(res);
+  *res = r;
+  superlong_deinit(&q);
+}
+
+// extra bits in the Barrett reciprocals, enough for dividends of a node's parent whose halves
+// differ by a prime
+#define SUPERLONG_RNS_BARRETT_SLACK 64
+
+// the product of a block of primes and, given c, sum of c_j prod / p_j over it, in 64-bit words
+static void superlong_rns_block(const uint32_t* primes, size_t n, const uint32_t* c, superlong* sum, superlong* prod) {
+  size_t cap = n / 2 + 3, len = 1;
+  uint64_t* words = nc_malloc(2 * cap * sizeof(uint64_t));
+  uint64_t *s = words, *q = words + cap;
+  memset(words, 0, 2 * cap * sizeof(uint64_t));
+  q[0] = 1;
+  for (size_t j = 0; j < n; j++) {
+    // s = s p + q c, then q = q p; s stays below q
+    uint64_t p = primes[j], cj = c ? c[j] : 0, cs = 0, cq = 0;
+    for (size_t i = 0; i < len; i++) {
+      superlong_rns_u128 t = (superlong_rns_u128) s[i] * p + (superlong_rns_u128) q[i] * cj + cs;
+      s[i] = (uint64_t) t;
+      cs = (uint64_t) (t >> 64);
+      t = (superlong_rns_u128) q[i] * p + cq;
+      q[i] = (uint64_t) t;
+      cq = (uint64_t) (t >> 64);
+    }
+    s[len] = cs;
+    q[len] = cq;
+    if (cq != 0 || cs != 0)
+      len++;
+  }
+  if (sum)
+    superlong_import(sum, len, -1, sizeof(uint64_t), 0, s);
+  superlong_import(prod, len, -1, sizeof(uint64_t), 0, q);
+  nc_free(words);
+}
+
+// products and their reciprocals down to blocks of SUPERLONG_RNS_LEAF primes, the entries below
+// those stay zero
+static void superlong_rns_build(superlong_rns_basis* basis, size_t i, size_t lo, size_t hi) {
+  if (hi - lo <= SUPERLONG_RNS_LEAF) {
+    superlong_rns_block(basis->primes + lo, hi - lo, NULL, NULL, &basis->tree[i]);
+  } else {
+    size_t mid = lo + (hi - lo) / 2;
+    superlong_rns_build(basis, i + 1, lo, mid);
+    superlong_rns_build(basis, i + 2 * (mid - lo), mid, hi);
+    superlong_mul(&basis->tree[i + 1], &basis->tree[i + 2 * (mid - lo)], &basis->tree[i]);
+  }
+  superlong_from_uint(&basis->inv[i], 1);
+  superlong_shl(&basis->inv[i], 2 * superlong_bit_length(&basis->tree[i]) + SUPERLONG_RNS_BARRETT_SLACK);
+  superlong_div_newton(&basis->inv[i], &basis->tree[i], &basis->inv[i]);
+}
+
+// x mod the product at node i for x >= 0: Barrett reduction with the node's reciprocal, whose
+// quotient estimate is never too large and at most a few units too small
+static void superlong_rns_reduce_node(const superlong_rns_basis* basis, size_t i, const superlong* x, superlong* res) {
+  const superlong* p = &basis->tree[i];
+  size_t b = superlong_bit_length(p);
+  if (superlong_bit_length(x) > 2 * b + SUPERLONG_RNS_BARRETT_SLACK) {
+    superlong_rns_reduce(x, p, res);
+    return;
+  }
+  superlong q, r;
+  superlong_init(&q);
+  superlong_init(&r);
+  superlong_copy(x, &q);
+  superlong_shr(&q, b - 1);
+  superlong_mul(&q, &basis->inv[i], &q);
+  superlong_shr(&q, b + 1 + SUPERLONG_RNS_BARRETT_SLACK);
+  superlong_copy(x, &r);
+  superlong_submul(&q, p, &r);
+  while (superlong_compare(&r, p) >= 0)
+    superlong_sub(&r, p, &r);
+  superlong_deinit(res);
+  *res = r;
+  superlong_deinit(&q);
+}
+
+// c = (M / P) mod P for the node's product P; each half multiplies in the other one, and at the
+// leaves M / p = c times the node's other primes
+static void superlong_rns_crt_down(superlong_rns_basis* basis, size_t i, size_t lo, size_t hi, const superlong* c) {
+  if (hi - lo <= SUPERLONG_RNS_LEAF) {
+    superlong_mod_ui_multi(c, basis->primes + lo, hi - lo, basis->crt + lo);
+    for (size_t j = lo; j < hi; j++) {
+      uint64_t p = basis->primes[j], w = basis->crt[j];
+      for (size_t l = lo; l < hi; l++)
+        if (l != j)
+          w = w * basis->primes[l] % p;
+      basis->crt[j] = superlong_rns_pow((uint32_t) w, (uint32_t) p - 2, (uint32_t) p);
+    }
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2, l = i + 1, r = i + 2 * (mid - lo);
+  superlong t;
+  superlong_init(&t);
+  superlong_mul(c, &basis->tree[r], &t);
+  superlong_rns_reduce_node(basis, l, &t, &t);
+  superlong_rns_crt_down(basis, l, lo, mid, &t);
+  superlong_mul(c, &basis->tree[l], &t);
+  superlong_rns_reduce_node(basis, r, &t, &t);
+  superlong_rns_crt_down(basis, r, mid, hi, &t);
+  superlong_deinit(&t);
+}
+
+void superlong_rns_basis_init(superlong_rns_basis* basis, size_t bits) {
+  // every prime exceeds 2^30, and M > 2^(bits + 1) covers the sign
+  size_t count = (bits + 1) / 30 + 1;
+  basis->count = count;
+  basis->primes = nc_malloc(4 * count * sizeof(uint32_t));
+  basis->minv = basis->primes + count;
+  basis->r2 = basis->primes + 2 * count;
+  basis->crt = basis->primes + 3 * count;
+  superlong_rns_primes(basis->primes, count);
+  for (size_t j = 0; j < count; j++) {
+    uint32_t p = basis->primes[j], inv = p;
+    for (int i = 0; i < 4; i++)
+      inv *= 2 - p * inv;
+    basis->minv[j] = 0 - inv;
+    uint64_t r = ((uint64_t) 1 << 32) % p;
+    basis->r2[j] = (uint32_t) (r * r % p);
+  }
+  basis->tree = nc_malloc(2 * (2 * count - 1) * sizeof(superlong));
+  basis->inv = basis->tree + 2 * count - 1;
+  for (size_t i = 0; i < 2 * (2 * count - 1); i++)
+    superlong_init(&basis->tree[i]);
+  superlong_rns_build(basis, 0, 0, count);
+  superlong one;
+  superlong_init(&one);
+  superlong_from_uint(&one, 1);
+  superlong_rns_crt_down(basis, 0, 0, count, &one);
+  superlong_deinit(&one);
+}
+
+void superlong_rns_basis_deinit(superlong_rns_basis* basis) {
+  for (size_t i = 0; i < 2 * (2 * basis->count - 1); i++)
+    superlong_deinit(&basis->tree[i]);
+  nc_free(basis->tree);
+  nc_free(basis->primes);
+  basis->tree = basis->inv = NULL;
+  basis->primes = basis->minv = basis->r2 = basis->crt = NULL;
+  basis->count = 0;
+}
+
+void superlong_rns_init(superlong_rns* num, const superlong_rns_basis* basis, size_t count) {
+  num->basis = basis;
+  num->count = count;
+  size_t size = basis->count * count * sizeof(uint32_t);
+  num->residues = nc_malloc(size > 0 ? size : 1);
+  memset(num->residues, 0, size);
+}
+
+void superlong_rns_deinit(superlong_rns* num) {
+  nc_free(num->residues);
+  num->residues = NULL;
+  num->count = 0;
+}
+
+// residues of x < P by the remainder tree, stopping at nodes small enough for mod_ui_multi
+static void superlong_rns_split(const superlong_rns_basis* basis, size_t i, size_t lo, size_t hi, const superlong* x,
+                                uint32_t* out) {
+  if (hi - lo <= SUPERLONG_RNS_LEAF) {
+    superlong_mod_ui_multi(x, basis->primes + lo, hi - lo, out + lo);
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2, l = i + 1, r = i + 2 * (mid - lo);
+  superlong t;
+  superlong_init(&t);
+  superlong_rns_reduce_node(basis, l, x, &t);
+  superlong_rns_split(basis, l, lo, mid, &t, out);
+  superlong_rns_reduce_node(basis, r, x, &t);
+  superlong_rns_split(basis, r, mid, hi, &t, out);
+  superlong_deinit(&t);
+}
+
+void superlong_rns_set(superlong_rns* num, size_t lane, const superlong* value) {
+  const superlong_rns_basis* basis = num->basis;
+  size_t k = basis->count;
+  uint32_t* out = nc_malloc(k * sizeof(uint32_t));
+  superlong x;
+  superlong_init(&x);
+  superlong_copy(value, &x);
+  if (!superlong_is_zero(&x))
+    x.sign = 1;
+  if (superlong_compare(&x, &basis->tree[0]) >= 0)
+    superlong_rns_reduce_node(basis, 0, &x, &x);
+  superlong_rns_split(basis, 0, 0, k, &x, out);
+  for (size_t j = 0; j < k; j++) {
+    uint32_t r = out[j];
+    if (value->sign < 0 && r != 0)
+      r = basis->primes[j] - r;
+    num->residues[j * num->count + lane] = superlong_rns_mont_mul(r, basis->r2[j], basis->primes[j], basis->minv[j]);
+  }
+  superlong_deinit(&x);
+  nc_free(out);
+}
+
+// sum of c_j M_node / p_j over the node: the halves' sums weighted by each other's products
+static void superlong_rns_join(const superlong_rns_basis* basis, size_t i, size_t lo, size_t hi, const uint32_t* c,
+                               superlong* res) {
+  if (hi - lo <= SUPERLONG_RNS_LEAF) {
+    superlong prod;
+    superlong_init(&prod);
+    superlong_rns_block(basis->primes + lo, hi - lo, c + lo, res, &prod);
+    superlong_deinit(&prod);
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2, l = i + 1, r = i + 2 * (mid - lo);
+  superlong right;
+  superlong_init(&right);
+  superlong_rns_join(basis, l, lo, mid, c, res);
+  superlong_rns_join(basis, r, mid, hi, c, &right);
+  superlong_mul(res, &basis->tree[r], res);
+  superlong_addmul(&right, &basis->tree[l], res);
+  superlong_deinit(&right);
+}
+
+void superlong_rns_get(const superlong_rns* num, size_t lane, superlong* res) {
+  const superlong_rns_basis* basis = num->basis;
+  size_t k = basis->count;
+  uint32_t* c = nc_malloc(k * sizeof(uint32_t));
+  // leaving Montgomery form and the CRT weight take one product
+  for (size_t j = 0; j < k; j++)
+    c[j] = superlong_rns_mont_mul(num->residues[j * num->count + lane], basis->crt[j], basis->primes[j],
+                                  basis->minv[j]);
+  superlong x, twice;
+  superlong_init(&x);
+  superlong_init(&twice);
+  superlong_rns_join(basis, 0, 0, k, c, &x);
+  superlong_rns_reduce_node(basis, 0, &x, &x);
+  superlong_copy(&x, &twice);
+  superlong_shl(&twice, 1);
+  if (superlong_compare(&twice, &basis->tree[0]) > 0)
+    superlong_sub(&x, &basis->tree[0], &x);
+  superlong_deinit(res);
+  *res = x;
+  superlong_deinit(&twice);
+  nc_free(c);
+}
+
+// row kernels: m lanes modulo one prime p
+
+typedef void (*superlong_rns_kernel)(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m, uint32_t p,
+                                     uint32_t minv);
+
+typedef struct {
+  superlong_rns_kernel add, sub, mul;
+} superlong_rns_kernels;
+
+static void rns_add_scalar(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m, uint32_t p, uint32_t minv) {
+  (void) minv;
+  for (size_t l = 0; l < m; l++) {
+    uint32_t s = x[l] + y[l];
+    r[l] = (s >= p) ? s - p : s;
+  }
+}
+
+static void rns_sub_scalar(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m, uint32_t p, uint32_t minv) {
+  (void) minv;
+  for (size_t l = 0; l < m; l++)
+    r[l] = (x[l] >= y[l]) ? x[l] - y[l] : x[l] - y[l] + p;
+}
+
+static void rns_mul_scalar(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m, uint32_t p, uint32_t minv) {
+  for (size_t l = 0; l < m; l++)
+    r[l] = superlong_rns_mont_mul(x[l], y[l], p, minv);
+}
+
+#ifdef SUPERLONG_RNS_AVX2
+
+// eight lanes per vector; a wrapped difference is always the larger candidate, so an unsigned
+// minimum picks the reduced value
+
+__attribute__((target("avx2"))) static void rns_add_avx2(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m,
+                                                         uint32_t p, uint32_t minv) {
+  const __m256i vp = _mm256_set1_epi32((int) p);
+  size_t l = 0;
+  for (; l + 8 <= m; l += 8) {
+    __m256i s = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*) (x + l)),
+                                 _mm256_loadu_si256((const __m256i*) (y + l)));
+    _mm256_storeu_si256((__m256i*) (r + l), _mm256_min_epu32(s, _mm256_sub_epi32(s, vp)));
+  }
+  rns_add_scalar(r + l, x + l, y + l, m - l, p, minv);
+}
+
+__attribute__((target("avx2"))) static void rns_sub_avx2(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m,
+                                                         uint32_t p, uint32_t minv) {
+  const __m256i vp = _mm256_set1_epi32((int) p);
+  size_t l = 0;
+  for (; l + 8 <= m; l += 8) {
+    __m256i d = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (x + l)),
+                                 _mm256_loadu_si256((const __m256i*) (y + l)));
+    _mm256_storeu_si256((__m256i*) (r + l), _mm256_min_epu32(d, _mm256_add_epi32(d, vp)));
+  }
+  rns_sub_scalar(r + l, x + l, y + l, m - l, p, minv);
+}
+
+// Montgomery products of the even and the odd 32-bit lanes in two 64-bit halves, blended back
+__attribute__((target("avx2"))) static void rns_mul_avx2(uint32_t* r, const uint32_t* x, const uint32_t* y, size_t m,
+                                                         uint32_t p, uint32_t minv) {
+  const __m256i vp = _mm256_set1_epi32((int) p);
+  const __m256i vminv = _mm256_set1_epi32((int) minv);
+  size_t l = 0;
+  for (; l + 8 <= m; l += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i*) (x + l));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (y + l));
+    __m256i te = _mm256_mul_epu32(a, b);
+    __m256i to = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i ue = _mm256_add_epi64(te, _mm256_mul_epu32(_mm256_mul_epu32(te, vminv), vp));
+    __m256i uo = _mm256_add_epi64(to, _mm256_mul_epu32(_mm256_mul_epu32(to, vminv), vp));
+    __m256i u = _mm256_blend_epi32(_mm256_srli_epi64(ue, 32), uo, 0xAA);
+    _mm256_storeu_si256((__m256i*) (r + l), _mm256_min_epu32(u, _mm256_sub_epi32(u, vp)));
+  }
+  rns_mul_scalar(r + l, x + l, y + l, m - l, p, minv);
+}
+
+#endif
+
+static superlong_rns_kernels superlong_rns_select(void) {
+#ifdef SUPERLONG_RNS_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    superlong_rns_kernels k = {rns_add_avx2, rns_sub_avx2, rns_mul_avx2};
+    return k;
+  }
+#endif
+  superlong_rns_kernels k = {rns_add_scalar, rns_sub_scalar, rns_mul_scalar};
+  return k;
+}
+
+static void superlong_rns_check(const superlong_rns* a, const superlong_rns* b) {
+  if (a->basis != b->basis || a->count != b->count) {
+    fprintf(stderr, "superlong_rns: mismatched bases or counts\n");
+    exit(1);
+  }
+}
+
+typedef struct {
+  superlong_rns_kernel kernel;
+  const superlong_rns *a, *b;
+  superlong_rns* res;
+  size_t lo, hi;
+  unsigned threads;
+} superlong_rns_job;
+
+static void superlong_rns_rows(const superlong_rns_job* job);
+
+#ifndef __STDC_NO_THREADS__
+static int superlong_rns_thread(void* arg) {
+  superlong_rns_rows(arg);
+  return 0;
+}
+#endif
+
+// rows [lo, hi) of residues, halves of the range going to new threads while they stay large
+static void superlong_rns_rows(const superlong_rns_job* job) {
+  size_t n = job->a->count;
+#ifndef __STDC_NO_THREADS__
+  if (job->threads > 1 && job->hi - job->lo >= 2 && (job->hi - job->lo) * n >= 2 * SUPERLONG_RNS_PARALLEL_MIN) {
+    size_t mid = job->lo + (job->hi - job->lo) / 2;
+    superlong_rns_job left = *job, right = *job;
+    left.hi = mid;
+    left.threads = job->threads / 2;
+    right.lo = mid;
+    right.threads = job->threads - job->threads / 2;
+    thrd_t thread;
+    if (thrd_create(&thread, superlong_rns_thread, &left) == thrd_success) {
+      superlong_rns_rows(&right);
+      thrd_join(thread, NULL);
+      return;
+    }
+  }
+#endif
+  const superlong_rns_basis* basis = job->a->basis;
+  for (size_t j = job->lo; j < job->hi; j++)
+    job->kernel(job->res->residues + j * n, job->a->residues + j * n, job->b->residues + j * n, n, basis->primes[j],
+                basis->minv[j]);
+}
+
+static void superlong_rns_run(superlong_rns_kernel kernel, const superlong_rns* a, const superlong_rns* b,
+                              superlong_rns* res) {
+  superlong_rns_check(a, b);
+  superlong_rns_check(a, res);
+  superlong_rns_job job = {kernel, a, b, res, 0, a->basis->count, superlong_get_threads()};
+  superlong_rns_rows(&job);
+}
+
+void superlong_rns_add(const superlong_rns* a, const superlong_rns* b, superlong_rns* res) {
+  superlong_rns_run(superlong_rns_select().add, a, b, res);
+}
+
+void superlong_rns_sub(const superlong_rns* a, const superlong_rns* b, superlong_rns* res) {
+  superlong_rns_run(superlong_rns_select().sub, a, b, res);
+}
+
+void superlong_rns_mul(const superlong_rns* a, const superlong_rns* b, superlong_rns* res) {
+  superlong_rns_run(superlong_rns_select().mul, a, b, res);
+}
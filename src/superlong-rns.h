@@ -0,0 +1,62 @@
+#ifndef SUPERLONG_RNS_H
+#define SUPERLONG_RNS_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Residue number system: numbers are kept as their residues modulo a basis of distinct primes
+// below 2^31, so addition, subtraction and multiplication work on every residue independently
+// and never propagate carries. A value v comes back exactly while |v| < M / 2, M being the
+// product of the primes; beyond that results wrap modulo M.
+typedef struct {
+  size_t count;
+  uint32_t* primes;
+  uint32_t* minv; // -p^-1 mod 2^32
+  uint32_t* r2;   // 2^64 mod p
+  uint32_t* crt;  // (M / p)^-1 mod p
+  // products of the primes in preorder: node 0 covers all of them, the node of primes [lo, hi)
+  // at index i has its halves at i + 1 and i + 2 (mid - lo), down to blocks of a few hundred
+  // primes that are handled word by word
+  superlong* tree;
+  // floor(2^(2b + 64) / P) for the b-bit products the remainder trees reduce by, zero elsewhere
+  superlong* inv;
+} superlong_rns_basis;
+
+// count numbers over one basis, stored structure-of-arrays like superlong_batch: the residue of
+// lane i modulo prime j lives at residues[j * count + i], in Montgomery form
+typedef struct {
+  const superlong_rns_basis* basis;
+  uint32_t* residues;
+  size_t count;
+} superlong_rns;
+
+// the basis holds every value of up to bits bits, sign included
+void superlong_rns_basis_init(superlong_rns_basis*, size_t bits);
+void superlong_rns_basis_deinit(superlong_rns_basis*);
+
+// all lanes start at zero; the basis must outlive the numbers
+void superlong_rns_init(superlong_rns*, const superlong_rns_basis*, size_t count);
+void superlong_rns_deinit(superlong_rns*);
+
+// set splits num by a remainder tree over the basis, get recombines the residues by the CRT
+// up the product tree and returns the representative in (-M / 2, M / 2]
+void superlong_rns_set(superlong_rns*, size_t lane, const superlong* num);
+void superlong_rns_get(const superlong_rns*, size_t lane, superlong* res);
+
+// lane-wise operations over numbers of the same basis and count; res may alias either operand.
+// Rows of residues run on AVX2 where available and on up to superlong_get_threads() threads
+void superlong_rns_add(const superlong_rns* a, const superlong_rns* b, superlong_rns* res);
+void superlong_rns_sub(const superlong_rns* a, const superlong_rns* b, superlong_rns* res);
+void superlong_rns_mul(const superlong_rns* a, const superlong_rns* b, superlong_rns* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
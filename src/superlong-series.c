@@ -0,0 +1,387 @@
+#include "superlong-series.h"
+
+#include "superlong-checkpoint.h"
+#include "superlong-internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+// ranges of at least this many terms are split across threads
+#define SUPERLONG_SERIES_PARALLEL_MIN 64
+
+// extra bits carried through the Newton iterations, and the sizes below which plain long
+// division is used instead: reciprocal precision and quotient length in bits
+#define SUPERLONG_NEWTON_GUARD 16
+#define SUPERLONG_NEWTON_BASE 64
+#define SUPERLONG_NEWTON_DIV_MIN 256
+
+// decimal guard digits of the constants
+#define SUPERLONG_CONST_GUARD 10
+
+// binary splitting
+
+void superlong_series_init(superlong_series* s) {
+  superlong_init(&s->p);
+  superlong_init(&s->q);
+  superlong_init(&s->t);
+}
+
+void superlong_series_deinit(superlong_series* s) {
+  superlong_deinit(&s->p);
+  superlong_deinit(&s->q);
+  superlong_deinit(&s->t);
+}
+
+typedef struct {
+  superlong_series_term term;
+  void* ctx;
+} superlong_series_source;
+
+static void superlong_series_tree(const superlong_series_source* src, uint64_t lo, uint64_t hi, int need_p,
+                                  superlong_series* res, unsigned threads);
+
+#ifndef __STDC_NO_THREADS__
+typedef struct {
+  const superlong_series_source* src;
+  uint64_t lo, hi;
+  unsigned threads;
+  superlong_series* res;
+} superlong_series_job;
+
+static int superlong_series_thread(void* arg) {
+  superlong_series_job* job = arg;
+  superlong_series_tree(job->src, job->lo, job->hi, 1, job->res, job->threads);
+  return 0;
+}
+#endif
+
+// P(lo, hi) is only needed by left halves, so need_p lets right halves and the root skip it
+static void superlong_series_tree(const superlong_series_source* src, uint64_t lo, uint64_t hi, int need_p,
+                                  superlong_series* res, unsigned threads) {
+  if (hi - lo == 1) {
+    superlong a;
+    superlong_init(&a);
+    src->term(src->ctx, lo, &res->p, &res->q, &a);
+    superlong_mul(&a, &res->p, &res->t);
+    superlong_deinit(&a);
+    return;
+  }
+  uint64_t mid = lo + (hi - lo) / 2;
+  superlong_series left, right;
+  superlong_series_init(&left);
+  superlong_series_init(&right);
+
+#ifndef __STDC_NO_THREADS__
+  if (threads > 1 && hi - lo >= SUPERLONG_SERIES_PARALLEL_MIN) {
+    // the left half goes to a new thread, the right one stays on this thread
+    superlong_series_job job = {src, lo, mid, threads / 2, &left};
+    thrd_t thread;
+    if (thrd_create(&thread, superlong_series_thread, &job) == thrd_success) {
+      superlong_series_tree(src, mid, hi, need_p, &right, threads - threads / 2);
+      thrd_join(thread, NULL);
+    } else {
+      superlong_series_tree(src, lo, mid, 1, &left, 1);
+      superlong_series_tree(src, mid, hi, need_p, &right, 1);
+    }
+  } else
+#endif
+  {
+    superlong_series_tree(src, lo, mid, 1, &left, threads);
+    superlong_series_tree(src, mid, hi, need_p, &right, threads);
+  }
+
+  // T = T_l Q_r + P_l T_r, Q = Q_l Q_r, P = P_l P_r
+  superlong_mul(&left.t, &right.q, &res->t);
+  superlong_addmul(&left.p, &right.t, &res->t);
+  superlong_mul(&left.q, &right.q, &res->q);
+  if (need_p)
+    superlong_mul(&left.p, &right.p, &res->p);
+  superlong_series_deinit(&left);
+  superlong_series_deinit(&right);
+}
+
+static void superlong_series_eval_p(superlong_series_term term, void* ctx, uint64_t lo, uint64_t hi, int need_p,
+                                    superlong_series* res) {
+  if (hi <= lo) {
+    superlong_from_uint(&res->p, 1);
+    superlong_from_uint(&res->q, 1);
+    superlong_from_uint(&res->t, 0);
+    return;
+  }
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_SERIES, hi - lo);
+  superlong_series_source src = {term, ctx};
+  superlong_series_tree(&src, lo, hi, need_p, res, superlong_get_threads());
+}
+
+void superlong_series_eval(superlong_series_term term, void* ctx, uint64_t lo, uint64_t hi, superlong_series* res) {
+  superlong_series_eval_p(term, ctx, lo, hi, 1, res);
+}
+
+// Newton iterations
+
+// 2^(bits(b) + prec) / b within a few units for b > 0: each step doubles the precision of the
+// previous approximation and only looks at the top prec + guard bits of b
+static void superlong_newton_recip(const superlong* b, size_t prec, superlong* res) {
+  size_t nb = superlong_bit_length(b);
+  size_t shift = (nb > prec + SUPERLONG_NEWTON_GUARD) ? nb - prec - SUPERLONG_NEWTON_GUARD : 0;
+  size_t scale = nb - shift + prec;
+  superlong top, pow2, err;
+  superlong_init(&top);
+  superlong_init(&pow2);
+  superlong_init(&err);
+  superlong_copy(b, &top);
+  superlong_shr(&top, shift);
+  superlong_from_uint(&pow2, 1);
+  superlong_shl(&pow2, scale);
+
+  if (prec <= SUPERLONG_NEWTON_BASE) {
+    superlong_div(&pow2, &top, res);
+  } else {
+    size_t half = prec / 2 + SUPERLONG_NEWTON_GUARD;
+    superlong_newton_recip(&top, half, res);
+    superlong_shl(res, prec - half);
+    // x += x (2^scale - top x) / 2^scale
+    superlong_mul(&top, res, &err);
+    superlong_sub(&pow2, &err, &err);
+    superlong_mul(res, &err, &err);
+    superlong_shr(&err, scale);
+    superlong_add(res, &err, res);
+  }
+  superlong_deinit(&top);
+  superlong_deinit(&pow2);
+  superlong_deinit(&err);
+}
+
+void superlong_div_newton(const superlong* a, const superlong* b, superlong* res) {
+  if (superlong_is_zero(b)) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  size_t na = superlong_bit_length(a), nb = superlong_bit_length(b);
+  if (na < nb + SUPERLONG_NEWTON_DIV_MIN || nb < SUPERLONG_NEWTON_DIV_MIN) {
+    // short quotients or divisors: long division is already cheap
+    superlong_div(a, b, res);
+    return;
+  }
+  int sign = a->sign * b->sign;
+  superlong x, q, r, babs;
+  superlong_init(&x);
+  superlong_init(&q);
+  superlong_init(&r);
+  superlong_init(&babs);
+  superlong_copy(b, &babs);
+  babs.sign = 1;
+
+  // q ~ a x / 2^(nb + prec) from the top prec bits of a, then fix the last units
+  size_t prec = na - nb + 1 + SUPERLONG_NEWTON_GUARD;
+  size_t shift = na - prec;
+  superlong_newton_recip(&babs, prec, &x);
+  superlong_copy(a, &q);
+  q.sign = 1;
+  superlong_shr(&q, shift);
+  superlong_mul(&q, &x, &q);
+  superlong_shr(&q, nb + prec - shift);
+
+  superlong_copy(a, &r);
+  r.sign = 1;
+  superlong_submul(&q, &babs, &r);
+  while (r.sign < 0 && !superlong_is_zero(&r)) {
+    superlong_sub_uint(&q, 1, &q);
+    superlong_add(&r, &babs, &r);
+  }
+  while (superlong_compare(&r, &babs) >= 0) {
+    superlong_add_uint(&q, 1, &q);
+    superlong_sub(&r, &babs, &r);
+  }
+
+  if (!superlong_is_zero(&q))
+    q.sign = sign;
+  superlong_deinit(res);
+  *res = q;
+  superlong_deinit(&x);
+  superlong_deinit(&r);
+  superlong_deinit(&babs);
+}
+
+// s = floor(sqrt(a >> 2k)) for k = bits / 4 gives half the bits of the root, one Newton step
+// x = (s 2^k + a / (s 2^k)) / 2 lands within a few units above it
+void superlong_sqrt(const superlong* a, superlong* res) {
+  if (a->sign < 0 && !superlong_is_zero(a)) {
+    perror("Square root of a negative number\n");
+    exit(1);
+  }
+  size_t n = superlong_bit_length(a);
+  if (n == 0) {
+    superlong_from_uint(res, 0);
+    return;
+  }
+  if (n <= 62) {
+    // Newton from 2^ceil(n / 2) >= sqrt(v) decreases monotonically to the root
+    uint64_t v = (uint64_t) superlong_get_int64(a);
+    uint64_t s = (uint64_t) 1 << ((n + 1) / 2);
+    for (uint64_t next = (s + v / s) / 2; next < s; next = (s + v / s) / 2)
+      s = next;
+    superlong_from_uint64(res, s);
+    return;
+  }
+  size_t k = n / 4;
+  superlong x, t, r;
+  superlong_init(&x);
+  superlong_init(&t);
+  superlong_init(&r);
+  superlong_copy(a, &t);
+  superlong_shr(&t, 2 * k);
+  superlong_sqrt(&t, &x);
+  superlong_shl(&x, k);
+  superlong_div_newton(a, &x, &t);
+  superlong_add(&x, &t, &x);
+  superlong_shr(&x, 1);
+
+  // r = a - x^2, then step x until 0 <= r <= 2x
+  superlong_copy(a, &r);
+  superlong_submul(&x, &x, &r);
+  while (r.sign < 0 && !superlong_is_zero(&r)) {
+    superlong_addmul_ui(&x, 2, &r);
+    superlong_sub_uint(&r, 1, &r);
+    superlong_sub_uint(&x, 1, &x);
+  }
+  for (;;) {
+    superlong_copy(&x, &t);
+    superlong_shl(&t, 1);
+    if (superlong_compare(&r, &t) <= 0)
+      break;
+    superlong_add_uint(&t, 1, &t);
+    superlong_sub(&r, &t, &r);
+    superlong_add_uint(&x, 1, &x);
+  }
+  superlong_deinit(res);
+  *res = x;
+  superlong_deinit(&t);
+  superlong_deinit(&r);
+}
+
+// constants
+
+// Chudnovsky: 1 / pi = 12 / 640320^(3/2) sum (-1)^k (6k)! (13591409 + 545140134 k) / ((3k)! k!^3 640320^(3k)),
+// as term ratios p(k) / q(k) = -(6k - 5)(2k - 1)(6k - 1) / (k^3 640320^3 / 24)
+static void superlong_chudnovsky_term(void* ctx, uint64_t k, superlong* p, superlong* q, superlong* a) {
+  (void) ctx;
+  superlong_from_uint64(a, 13591409 + 545140134 * k);
+  if (k == 0) {
+    superlong_from_uint(p, 1);
+    superlong_from_uint(q, 1);
+    return;
+  }
+  superlong_from_uint64(p, (6 * k - 5) * (2 * k - 1));
+  superlong_mul_ui64(p, 6 * k - 1, p);
+  superlong_negate(p);
+  superlong_from_uint64(q, k * k);
+  superlong_mul_ui64(q, k, q);
+  superlong_mul_ui64(q, 10939058860032000ull, q);
+}
+
+static void superlong_pow10(size_t exp, superlong* res) {
+  superlong ten;
+  superlong_init(&ten);
+  superlong_from_uint(&ten, 10);
+  superlong_pow_ui(&ten, exp, res);
+  superlong_deinit(&ten);
+}
+
+// each term adds 14.18 digits
+static uint64_t superlong_const_pi_terms(size_t scaled) { return scaled / 14 + 2; }
+
+// pi 10^digits = 426880 sqrt(10005 10^(2 digits)) Q / T
+static void superlong_const_pi_finish(size_t digits, const superlong_series* s, superlong* res) {
+  size_t scaled = digits + SUPERLONG_CONST_GUARD;
+  superlong root;
+  superlong_init(&root);
+  superlong_pow10(2 * scaled, &root);
+  superlong_mul_uint(&root, 10005, &root);
+  superlong_sqrt(&root, &root);
+  superlong_mul(&root, &s->q, &root);
+  superlong_mul_uint(&root, 426880, &root);
+  superlong_div_newton(&root, &s->t, res);
+  superlong_pow10(SUPERLONG_CONST_GUARD, &root);
+  superlong_div(res, &root, res);
+  superlong_deinit(&root);
+}
+
+void superlong_const_pi(size_t digits, superlong* res) {
+  superlong_series s;
+  superlong_series_init(&s);
+  superlong_series_eval_p(superlong_chudnovsky_term, NULL, 0, superlong_const_pi_terms(digits + SUPERLONG_CONST_GUARD),
+                          0, &s);
+  superlong_const_pi_finish(digits, &s, res);
+  superlong_series_deinit(&s);
+}
+
+// the series is all that is checkpointed; Q stays zero unless the driver computed it
+int superlong_const_pi_checkpoint(superlong_exec* exec, size_t digits, const char* path, double interval,
+                                  superlong* res) {
+  superlong_series s;
+  superlong_series_init(&s);
+  int rc = superlong_series_eval_checkpoint(exec, superlong_chudnovsky_term, NULL, 0,
+                                            superlong_const_pi_terms(digits + SUPERLONG_CONST_GUARD), path, interval,
+                                            &s);
+  if (!superlong_is_zero(&s.q))
+    superlong_const_pi_finish(digits, &s, res);
+  superlong_series_deinit(&s);
+  return rc;
+}
+
+static void superlong_e_term(void* ctx, uint64_t k, superlong* p, superlong* q, superlong* a) {
+  (void) ctx;
+  superlong_from_uint(p, 1);
+  superlong_from_uint64(q, (k > 0) ? k : 1);
+  superlong_from_uint(a, 1);
+}
+
+// e = sum 1 / k! up to the first k! beyond 10^(digits + guard)
+static uint64_t superlong_const_e_terms(size_t scaled) {
+  // terms! = mantissa 10^exp10 with 1 <= mantissa < 10
+  uint64_t terms = 1;
+  double mantissa = 1;
+  for (size_t exp10 = 0; exp10 <= scaled + 1; terms++) {
+    for (mantissa *= (double) (terms + 1); mantissa >= 10; mantissa /= 10)
+      exp10++;
+  }
+  return terms + 1;
+}
+
+static void superlong_const_e_finish(size_t digits, superlong_series* s, superlong* res) {
+  superlong scale;
+  superlong_init(&scale);
+  superlong_pow10(digits + SUPERLONG_CONST_GUARD, &scale);
+  superlong_mul(&s->t, &scale, &s->t);
+  superlong_div_newton(&s->t, &s->q, res);
+  superlong_pow10(SUPERLONG_CONST_GUARD, &scale);
+  superlong_div(res, &scale, res);
+  superlong_deinit(&scale);
+}
+
+void superlong_const_e(size_t digits, superlong* res) {
+  superlong_series s;
+  superlong_series_init(&s);
+  superlong_series_eval_p(superlong_e_term, NULL, 0, superlong_const_e_terms(digits + SUPERLONG_CONST_GUARD), 0, &s);
+  superlong_const_e_finish(digits, &s, res);
+  superlong_series_deinit(&s);
+}
+
+int superlong_const_e_checkpoint(superlong_exec* exec, size_t digits, const char* path, double interval,
+                                 superlong* res) {
+  superlong_series s;
+  superlong_series_init(&s);
+  int rc = superlong_series_eval_checkpoint(exec, superlong_e_term, NULL, 0,
+                                            superlong_const_e_terms(digits + SUPERLONG_CONST_GUARD), path, interval,
+                                            &s);
+  if (!superlong_is_zero(&s.q))
+    superlong_const_e_finish(digits, &s, res);
+  superlong_series_deinit(&s);
+  return rc;
+}
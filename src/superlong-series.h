@@ -0,0 +1,48 @@
+#ifndef SUPERLONG_SERIES_H
+#define SUPERLONG_SERIES_H
+
+#include "superlong.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary splitting for hypergeometric-type series
+//   S = sum over lo <= n < hi of a(n) * p(lo) * ... * p(n) / (q(lo) * ... * q(n))
+// The callback fills p(k), q(k) and a(k) for one term. Subtrees run on up to
+// superlong_get_threads() threads, so the callback must be safe to call concurrently.
+typedef void (*superlong_series_term)(void* ctx, uint64_t k, superlong* p, superlong* q, superlong* a);
+
+// P and Q are the products of p and q over the range and S = T / Q
+typedef struct {
+  superlong p, q, t;
+} superlong_series;
+
+void superlong_series_init(superlong_series*);
+void superlong_series_deinit(superlong_series*);
+void superlong_series_eval(superlong_series_term term, void* ctx, uint64_t lo, uint64_t hi, superlong_series* res);
+
+// Newton iterations: the quotient truncated towards zero like superlong_div, and floor(sqrt(a)).
+// Division by zero and the square root of a negative number abort like superlong_div
+void superlong_div_newton(const superlong* a, const superlong* b, superlong* res);
+void superlong_sqrt(const superlong* a, superlong* res);
+
+// floor(pi * 10^digits) and floor(e * 10^digits), i.e. the constant's first digits + 1 digits
+void superlong_const_pi(size_t digits, superlong* res);
+void superlong_const_e(size_t digits, superlong* res);
+
+// the same with the series checkpointed to path by superlong_series_eval_checkpoint, returning
+// like the drivers of superlong-checkpoint.h; the final square root and divisions are not
+int superlong_const_pi_checkpoint(superlong_exec* exec, size_t digits, const char* path, double interval,
+                                  superlong* res);
+int superlong_const_e_checkpoint(superlong_exec* exec, size_t digits, const char* path, double interval,
+                                 superlong* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,233 @@
+#include "superlong-stats.h"
+
+#include "safe-alloc.h"
+#include "superlong-internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const superlong_stat_names[SUPERLONG_STAT_OP_COUNT] = {
+    "add",       "sub",           "mul",          "addmul",        "mul_uint",       "div",
+    "div_uint",  "divrem_preinv", "to_str",       "from_str",      "out_str",        "prod_array",
+    "factorial", "pow",           "series",       "mul_basecase",  "mul_karatsuba",  "mul_unbalanced",
+    "div_long",
+};
+
+const char* superlong_stats_name(enum superlong_stat_op op) {
+  return ((unsigned) op < SUPERLONG_STAT_OP_COUNT) ? superlong_stat_names[op] : "unknown";
+}
+
+#ifndef SUPERLONG_STATS
+
+int superlong_stats_enabled(void) { return 0; }
+
+void superlong_stats_snapshot(superlong_stats* out) { memset(out, 0, sizeof(*out)); }
+
+void superlong_stats_reset(void) {}
+
+#ifdef NC_ALLOC_PROFILE
+// the allocation profile attributes blocks to operations, so the scopes keep track of the
+// innermost one even without the counters
+#ifndef __STDC_NO_THREADS__
+static _Thread_local int superlong_stats_current = -1;
+#else
+static int superlong_stats_current = -1;
+#endif
+
+superlong_stat_scope superlong_stats_enter(enum superlong_stat_op op, size_t size) {
+  (void) size;
+  superlong_stat_scope scope = {op, superlong_stats_current, 0};
+  superlong_stats_current = op;
+  return scope;
+}
+
+void superlong_stats_leave(superlong_stat_scope* scope) { superlong_stats_current = scope->prev; }
+
+int superlong_stats_current_op(void) { return superlong_stats_current; }
+#else
+int superlong_stats_current_op(void) { return -1; }
+#endif
+
+#else
+
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+// one block per thread: only its owner writes the counters, snapshots read them with relaxed loads
+typedef struct superlong_stats_block {
+  struct {
+    _Atomic uint64_t calls;
+    _Atomic uint64_t cycles;
+    _Atomic uint64_t sizes[SUPERLONG_STAT_BUCKETS];
+  } ops[SUPERLONG_STAT_OP_COUNT];
+  int current;
+  struct superlong_stats_block* next;
+  struct superlong_stats_block* next_free;
+} superlong_stats_block;
+
+static _Atomic(superlong_stats_block*) superlong_stats_blocks = NULL;
+
+#ifndef __STDC_NO_THREADS__
+static _Thread_local superlong_stats_block* superlong_stats_local = NULL;
+
+// an exiting thread's counts move to the retired block and its own block to the free list, where
+// the next new thread picks it up: blocks stay linked for snapshots but only grow with the number
+// of threads alive at once
+static superlong_stats_block superlong_stats_retired;
+static superlong_stats_block* superlong_stats_free = NULL;
+static mtx_t superlong_stats_free_lock;
+static tss_t superlong_stats_key;
+static once_flag superlong_stats_once = ONCE_FLAG_INIT;
+
+// moves each counter with an exchange, so a racing snapshot misses the counts instead of seeing
+// them twice
+static void superlong_stats_retire(void* arg) {
+  superlong_stats_block* block = arg;
+  for (int op = 0; op < SUPERLONG_STAT_OP_COUNT; op++) {
+    atomic_fetch_add_explicit(&superlong_stats_retired.ops[op].calls,
+                              atomic_exchange_explicit(&block->ops[op].calls, 0, memory_order_relaxed),
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&superlong_stats_retired.ops[op].cycles,
+                              atomic_exchange_explicit(&block->ops[op].cycles, 0, memory_order_relaxed),
+                              memory_order_relaxed);
+    for (int k = 0; k < SUPERLONG_STAT_BUCKETS; k++)
+      atomic_fetch_add_explicit(&superlong_stats_retired.ops[op].sizes[k],
+                                atomic_exchange_explicit(&block->ops[op].sizes[k], 0, memory_order_relaxed),
+                                memory_order_relaxed);
+  }
+  mtx_lock(&superlong_stats_free_lock);
+  block->next_free = superlong_stats_free;
+  superlong_stats_free = block;
+  mtx_unlock(&superlong_stats_free_lock);
+}
+
+static void superlong_stats_init(void) {
+  if (mtx_init(&superlong_stats_free_lock, mtx_plain) != thrd_success ||
+      tss_create(&superlong_stats_key, superlong_stats_retire) != thrd_success) {
+    perror("superlong_stats_init");
+    exit(1);
+  }
+}
+#else
+static superlong_stats_block* superlong_stats_local = NULL;
+#endif
+
+static superlong_stats_block* superlong_stats_block_get(void) {
+  superlong_stats_block* block = superlong_stats_local;
+  if (block)
+    return block;
+#ifndef __STDC_NO_THREADS__
+  call_once(&superlong_stats_once, superlong_stats_init);
+  mtx_lock(&superlong_stats_free_lock);
+  block = superlong_stats_free;
+  if (block)
+    superlong_stats_free = block->next_free;
+  mtx_unlock(&superlong_stats_free_lock);
+#endif
+  if (!block) {
+    block = nc_malloc(sizeof(*block));
+    memset(block, 0, sizeof(*block));
+    // blocks are never unlinked, so a lock-free push is enough
+    block->next = atomic_load(&superlong_stats_blocks);
+    while (!atomic_compare_exchange_weak(&superlong_stats_blocks, &block->next, block))
+      ;
+  }
+  block->current = -1;
+#ifndef __STDC_NO_THREADS__
+  tss_set(superlong_stats_key, block);
+#endif
+  superlong_stats_local = block;
+  return block;
+}
+
+static uint64_t superlong_stats_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// single writer: a relaxed load and store instead of a locked read-modify-write
+static void superlong_stat_bump(_Atomic uint64_t* counter, uint64_t v) {
+  atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + v, memory_order_relaxed);
+}
+
+int superlong_stats_enabled(void) { return 1; }
+
+superlong_stat_scope superlong_stats_enter(enum superlong_stat_op op, size_t size) {
+  superlong_stats_block* block = superlong_stats_block_get();
+  unsigned bucket = 0;
+  while (size != 0 && bucket < SUPERLONG_STAT_BUCKETS - 1) {
+    size >>= 1;
+    bucket++;
+  }
+  superlong_stat_bump(&block->ops[op].calls, 1);
+  superlong_stat_bump(&block->ops[op].sizes[bucket], 1);
+
+  superlong_stat_scope scope = {op, block->current, superlong_stats_clock()};
+  block->current = op;
+  return scope;
+}
+
+void superlong_stats_leave(superlong_stat_scope* scope) {
+  superlong_stats_block* block = superlong_stats_local;
+  superlong_stat_bump(&block->ops[scope->op].cycles, superlong_stats_clock() - scope->start);
+  block->current = scope->prev;
+}
+
+int superlong_stats_current_op(void) {
+  superlong_stats_block* block = superlong_stats_local;
+  return block ? block->current : -1;
+}
+
+static void superlong_stats_add_block(superlong_stats* out, superlong_stats_block* block) {
+  for (int op = 0; op < SUPERLONG_STAT_OP_COUNT; op++) {
+    out->ops[op].calls += atomic_load_explicit(&block->ops[op].calls, memory_order_relaxed);
+    out->ops[op].cycles += atomic_load_explicit(&block->ops[op].cycles, memory_order_relaxed);
+    for (int k = 0; k < SUPERLONG_STAT_BUCKETS; k++)
+      out->ops[op].sizes[k] += atomic_load_explicit(&block->ops[op].sizes[k], memory_order_relaxed);
+  }
+}
+
+static void superlong_stats_clear_block(superlong_stats_block* block) {
+  for (int op = 0; op < SUPERLONG_STAT_OP_COUNT; op++) {
+    atomic_store_explicit(&block->ops[op].calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&block->ops[op].cycles, 0, memory_order_relaxed);
+    for (int k = 0; k < SUPERLONG_STAT_BUCKETS; k++)
+      atomic_store_explicit(&block->ops[op].sizes[k], 0, memory_order_relaxed);
+  }
+}
+
+void superlong_stats_snapshot(superlong_stats* out) {
+  memset(out, 0, sizeof(*out));
+  for (superlong_stats_block* block = atomic_load(&superlong_stats_blocks); block; block = block->next)
+    superlong_stats_add_block(out, block);
+#ifndef __STDC_NO_THREADS__
+  superlong_stats_add_block(out, &superlong_stats_retired);
+#endif
+}
+
+// counts racing with the reset on other threads may survive it
+void superlong_stats_reset(void) {
+  for (superlong_stats_block* block = atomic_load(&superlong_stats_blocks); block; block = block->next)
+    superlong_stats_clear_block(block);
+#ifndef __STDC_NO_THREADS__
+  superlong_stats_clear_block(&superlong_stats_retired);
+#endif
+}
+
+#endif
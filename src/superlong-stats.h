@@ -0,0 +1,63 @@
+#ifndef SUPERLONG_STATS_H
+#define SUPERLONG_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-operation counters, collected only when the library is built with SUPERLONG_STATS (make STATS=1).
+// The snapshot/reset API is always available and reports zeros otherwise.
+
+enum superlong_stat_op {
+  // public entry points
+  SUPERLONG_STAT_ADD,
+  SUPERLONG_STAT_SUB,
+  SUPERLONG_STAT_MUL,
+  SUPERLONG_STAT_ADDMUL,
+  SUPERLONG_STAT_MUL_UINT,
+  SUPERLONG_STAT_DIV,
+  SUPERLONG_STAT_DIV_UINT,
+  SUPERLONG_STAT_DIVREM_PREINV,
+  SUPERLONG_STAT_TO_STR,
+  SUPERLONG_STAT_FROM_STR,
+  SUPERLONG_STAT_OUT_STR,
+  SUPERLONG_STAT_PROD_ARRAY,
+  SUPERLONG_STAT_FACTORIAL,
+  SUPERLONG_STAT_POW,
+  SUPERLONG_STAT_SERIES,
+  // algorithm tiers
+  SUPERLONG_STAT_MUL_BASECASE,
+  SUPERLONG_STAT_MUL_KARATSUBA,
+  SUPERLONG_STAT_MUL_UNBALANCED,
+  SUPERLONG_STAT_DIV_LONG,
+  SUPERLONG_STAT_OP_COUNT
+};
+
+// operand sizes in digits, bucketed by bit length: bucket k holds sizes in [2^(k-1), 2^k)
+#define SUPERLONG_STAT_BUCKETS 32
+
+typedef struct {
+  uint64_t calls;
+  uint64_t cycles; // inclusive of nested operations; TSC ticks on x86, nanoseconds elsewhere
+  uint64_t sizes[SUPERLONG_STAT_BUCKETS];
+} superlong_op_stats;
+
+typedef struct {
+  superlong_op_stats ops[SUPERLONG_STAT_OP_COUNT];
+} superlong_stats;
+
+int superlong_stats_enabled(void);
+const char* superlong_stats_name(enum superlong_stat_op);
+
+// sums the counters of every thread that has used the library
+void superlong_stats_snapshot(superlong_stats* out);
+void superlong_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
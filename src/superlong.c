@@ -2,19 +2,26 @@
 
 #include "generate-arr.h"
 #include "safe-alloc.h"
+#include "superlong-internal.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
 typedef uint16_t n256plus;
 typedef uint32_t n256plusplus;
 typedef uint64_t n256plusplusplus;
 
 DEFINE_DYN_ARR(n256, sldigits, 16)
+DEFINE_DYN_ARR(int64_t, sllanes, 16)
 
-#define SLDIGITS_ARR_PTR(NUM) (&(NUM)->digits)
+#define SUPERLONG_KARATSUBA_THRESHOLD 16
 
 // initialization
 
@@ -35,7 +42,7 @@ superlong* new_superlong() {
 void delete_superlong(superlong* num) {
   if (num) {
     superlong_deinit(num);
-    free(num);
+    nc_free(num);
   }
 }
 
@@ -67,16 +74,56 @@ void superlong_from_int(superlong* num, int16_t n) {
   }
 }
 
+void superlong_from_uint64(superlong* num, uint64_t n) {
+  superlong_clean(num);
+  while (n > 0) {
+    sldigits_add_tail(SLDIGITS_ARR_PTR(num), (n256) (n & 0xFF));
+    n >>= 8;
+  }
+  num->sign = (num->digits.len > 0) ? 1 : 0;
+}
+
+void superlong_from_int64(superlong* num, int64_t n) {
+  if (n >= 0) {
+    superlong_from_uint64(num, (uint64_t) n);
+  } else {
+    superlong_from_uint64(num, (uint64_t) -(n + 1) + 1);
+    num->sign = -1;
+  }
+}
+
 // side-operations
 
 int superlong_is_zero(const superlong* num) {
-  if (num->sign == 0)
+  if (num->sign == 0 || num->digits.len == 0)
     return 1;
   if (num->digits.len == 1 && sldigits_get(SLDIGITS_ARR_PTR(num), 0) == 0)
     return 1;
   return 0;
 }
 
+// low 64 bits of the magnitude with the sign applied (wraps like a cast when it does not fit)
+int64_t superlong_get_int64(const superlong* num) {
+  if (superlong_is_zero(num))
+    return 0;
+  uint64_t mag = 0;
+  for (size_t i = 0; i < 8 && i < num->digits.len; i++)
+    mag |= (uint64_t) num->digits.arr[i] << (8 * i);
+  if (num->sign < 0)
+    mag = ~mag + 1;
+  return (int64_t) mag;
+}
+
+int superlong_fits_int64(const superlong* num) {
+  if (superlong_is_zero(num))
+    return 1;
+  size_t bits = superlong_bit_length(num);
+  if (bits < 64)
+    return 1;
+  // -2^63 is the only 64-bit magnitude that fits
+  return bits == 64 && num->sign < 0 && superlong_trailing_zeros(num) == 63;
+}
+
 void superlong_normalize(superlong* num) {
   while ((num->digits.len > 1) && (sldigits_get(SLDIGITS_ARR_PTR(num), num->digits.len - 1) == 0)) {
     sldigits_del_tail(SLDIGITS_ARR_PTR(num));
@@ -91,32 +138,262 @@ void superlong_negate(superlong* num) {
 }
 
 void superlong_copy(const superlong* num, superlong* res) {
-  superlong_clean(res);
-
-  for (size_t i = 0; i < num->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), sldigits_get(SLDIGITS_ARR_PTR(num), i));
+  if (num == res)
+    return;
+  res->digits.len = 0;
+  sldigits_ensure_capacity(SLDIGITS_ARR_PTR(res), num->digits.len);
+  if (num->digits.len > 0)
+    memcpy(res->digits.arr, num->digits.arr, num->digits.len);
+  res->digits.len = num->digits.len;
   res->sign = num->sign;
 }
 
-// absolute value operations
+// digit kernels: in-place loops over raw little-endian digit arrays
 
-static int superlong_abs_compare_uint(const superlong* a, uint32_t b) {
-  if (a->digits.len == 0)
-    return (b == 0) ? 0 : -1;
-  if (a->digits.len > 4)
-    return 1;
+// rp[0..n) += c, returns the carry out of the top digit
+static uint64_t digits_add_1(n256* rp, size_t n, uint64_t c) {
+  for (size_t i = 0; i < n && c != 0; i++) {
+    c += rp[i];
+    rp[i] = (n256) c;
+    c >>= 8;
+  }
+  return c;
+}
+
+// rp[0..n) -= c, returns the borrow out of the top digit
+static uint64_t digits_sub_1(n256* rp, size_t n, uint64_t c) {
+  for (size_t i = 0; i < n && c != 0; i++) {
+    n256 low = (n256) c;
+    c >>= 8;
+    if (rp[i] < low)
+      c++;
+    rp[i] = (n256) (rp[i] - low);
+  }
+  return c;
+}
 
-  uint32_t val = 0;
-  for (size_t i = 0; i < a->digits.len; i++)
-    val |= ((uint32_t) sldigits_get(SLDIGITS_ARR_PTR(a), i) << ((i * 8)));
+// rp[0..n) += ap[0..n), returns the carry
+static unsigned digits_add_n(n256* rp, const n256* ap, size_t n) {
+  unsigned carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    carry += (unsigned) rp[i] + ap[i];
+    rp[i] = (n256) carry;
+    carry >>= 8;
+  }
+  return carry;
+}
 
-  if (val > b)
-    return 1;
-  if (val < b)
-    return -1;
-  return 0;
+// rp[0..n) -= ap[0..n), returns the borrow
+static unsigned digits_sub_n(n256* rp, const n256* ap, size_t n) {
+  unsigned borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    unsigned sub = (unsigned) ap[i] + borrow;
+    borrow = rp[i] < sub;
+    rp[i] = (n256) (rp[i] - sub);
+  }
+  return borrow;
+}
+
+// rp[0..n) += ap[0..n) * k, returns the carry (< 2^32)
+static uint64_t digits_addmul_1(n256* rp, const n256* ap, size_t n, uint32_t k) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    carry += (uint64_t) ap[i] * k + rp[i];
+    rp[i] = (n256) carry;
+    carry >>= 8;
+  }
+  return carry;
+}
+
+// rp[0..n) -= ap[0..n) * k, returns the borrow (< 2^32)
+static uint64_t digits_submul_1(n256* rp, const n256* ap, size_t n, uint32_t k) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    borrow += (uint64_t) ap[i] * k;
+    n256 low = (n256) borrow;
+    borrow >>= 8;
+    if (rp[i] < low)
+      borrow++;
+    rp[i] = (n256) (rp[i] - low);
+  }
+  return borrow;
+}
+
+// two's complement negation of rp[0..n), returns 1 if rp was zero
+static unsigned digits_neg(n256* rp, size_t n) {
+  unsigned carry = 1;
+  for (size_t i = 0; i < n; i++) {
+    carry += (n256) ~rp[i];
+    rp[i] = (n256) carry;
+    carry >>= 8;
+  }
+  return carry;
+}
+
+// up to four digits starting at `i` as one 32-bit multiplier
+static uint32_t digits_load_u32(const n256* ap, size_t n, size_t i) {
+  uint32_t k = 0;
+  for (size_t j = 0; j < 4 && i + j < n; j++)
+    k |= (uint32_t) ap[i + j] << (8 * j);
+  return k;
+}
+
+// rp[0..la+lb) = ap * bp, four digits of bp per pass; rp must not overlap the inputs
+static void digits_mul_basecase(n256* rp, const n256* ap, size_t la, const n256* bp, size_t lb) {
+  memset(rp, 0, la + lb);
+  for (size_t j = 0; j < lb; j += 4) {
+    uint32_t k = digits_load_u32(bp, lb, j);
+    if (k == 0)
+      continue;
+    uint64_t carry = digits_addmul_1(rp + j, ap, la, k);
+    digits_add_1(rp + j + la, lb - j, carry);
+  }
+}
+
+// (nh * 2^32 + nl) / d for a normalized d and nh < d with the Moller-Granlund reciprocal
+static uint32_t udiv_qrnnd_preinv(uint32_t* r, uint32_t nh, uint32_t nl, uint32_t d, uint32_t inv) {
+  uint64_t p = (uint64_t) inv * nh + (((uint64_t) nh << 32) | nl);
+  uint32_t q = (uint32_t) (p >> 32) + 1;
+  uint32_t rem = nl - q * d;
+  if (rem > (uint32_t) p) {
+    q--;
+    rem += d;
+  }
+  if (rem >= d) {
+    q++;
+    rem -= d;
+  }
+  *r = rem;
+  return q;
+}
+
+static uint32_t digits_load_word(const n256* ap, size_t n, size_t word) { return digits_load_u32(ap, n, word * 4); }
+
+static void digits_store_word(n256* qp, size_t n, size_t word, uint32_t value) {
+  for (size_t j = 0; j < 4 && word * 4 + j < n; j++)
+    qp[word * 4 + j] = (n256) (value >> (8 * j));
 }
 
+// qp[0..n) = ap[0..n) / d 32 bits at a time, returns the remainder; qp may be NULL or ap
+static uint32_t digits_divrem_preinv(n256* qp, const n256* ap, size_t n, const superlong_preinv* inv) {
+  size_t words = (n + 3) / 4;
+  unsigned s = inv->shift;
+  uint32_t rem = 0;
+  if (words == 0)
+    return 0;
+
+  // the dividend is shifted left by the same amount as the divisor on the fly
+  if (s != 0)
+    rem = digits_load_word(ap, n, words - 1) >> (32 - s);
+  for (size_t j = words; j-- > 0;) {
+    uint32_t word = digits_load_word(ap, n, j);
+    if (s != 0)
+      word = (word << s) | ((j > 0) ? digits_load_word(ap, n, j - 1) >> (32 - s) : 0);
+    uint32_t q = udiv_qrnnd_preinv(&rem, rem, word, inv->norm, inv->inv);
+    if (qp)
+      digits_store_word(qp, n, j, q);
+  }
+  return rem >> s;
+}
+
+// qp[0..n) = ap[0..n) / d for an odd d that divides ap exactly, low digits first; qp may be ap
+static void digits_divexact_odd(n256* qp, const n256* ap, size_t n, uint32_t d, n256 dinv) {
+  uint64_t c = 0;
+  for (size_t i = 0; i < n; i++) {
+    n256 a = ap[i];
+    n256 q = (n256) ((n256) (a - (n256) c) * dinv);
+    c = (c + (uint64_t) q * d - a) >> 8;
+    qp[i] = q;
+  }
+}
+
+// zero-extends the digit array to `len` digits
+static void superlong_pad(superlong* num, size_t len) {
+  if (num->digits.len >= len)
+    return;
+  sldigits_ensure_capacity(SLDIGITS_ARR_PTR(num), len);
+  memset(num->digits.arr + num->digits.len, 0, len - num->digits.len);
+  num->digits.len = len;
+}
+
+// replaces the digits of `res` with `out`, taking ownership of its buffer
+static void superlong_set_digits(superlong* res, sldigits out, int sign) {
+  superlong_deinit(res);
+  res->digits = out;
+  res->sign = sign;
+  if (res->digits.len == 0)
+    sldigits_add_tail(SLDIGITS_ARR_PTR(res), 0);
+  superlong_normalize(res);
+}
+
+static void superlong_from_digits(superlong* num, const n256* digits, size_t len) {
+  superlong_clean(num);
+  sldigits_ensure_capacity(SLDIGITS_ARR_PTR(num), len);
+  memcpy(num->digits.arr, digits, len);
+  num->digits.len = len;
+  num->sign = 1;
+  superlong_normalize(num);
+}
+
+// res += tsign * tp[0..tn); tp must not point into res
+static void superlong_accumulate_digits(superlong* res, const n256* tp, size_t tn, int tsign) {
+  if (tsign == 0 || tn == 0)
+    return;
+  if (res->sign == 0) {
+    res->digits.len = 0;
+    res->sign = tsign;
+  }
+  size_t len = ((res->digits.len > tn) ? res->digits.len : tn) + 1;
+  superlong_pad(res, len);
+  n256* rp = res->digits.arr;
+
+  if (res->sign == tsign) {
+    unsigned carry = digits_add_n(rp, tp, tn);
+    digits_add_1(rp + tn, len - tn, carry);
+  } else {
+    uint64_t borrow = digits_sub_n(rp, tp, tn);
+    if (digits_sub_1(rp + tn, len - tn, borrow)) {
+      // |t| > |res|: the wrapped difference is the two's complement of the result
+      digits_neg(rp, len);
+      res->sign = -res->sign;
+    }
+  }
+  superlong_normalize(res);
+}
+
+// res += tsign * ap * bp row by row directly in res; ap and bp must not point into res
+static void superlong_addmul_rows(superlong* res, const n256* ap, size_t la, const n256* bp, size_t lb, int tsign) {
+  if (res->sign == 0) {
+    res->digits.len = 0;
+    res->sign = tsign;
+  }
+  size_t len = ((res->digits.len > la + lb) ? res->digits.len : la + lb) + 1;
+  superlong_pad(res, len);
+  n256* rp = res->digits.arr;
+
+  int add = (res->sign == tsign);
+  uint64_t wrapped = 0;
+  for (size_t j = 0; j < lb; j += 4) {
+    uint32_t k = digits_load_u32(bp, lb, j);
+    if (k == 0)
+      continue;
+    if (add) {
+      uint64_t carry = digits_addmul_1(rp + j, ap, la, k);
+      digits_add_1(rp + j + la, len - j - la, carry);
+    } else {
+      uint64_t borrow = digits_submul_1(rp + j, ap, la, k);
+      wrapped |= digits_sub_1(rp + j + la, len - j - la, borrow);
+    }
+  }
+  if (wrapped) {
+    digits_neg(rp, len);
+    res->sign = -res->sign;
+  }
+  superlong_normalize(res);
+}
+
+// absolute value operations
+
 static int superlong_abs_compare(const superlong* a, const superlong* b) {
   if (a->digits.len != b->digits.len)
     return (a->digits.len > b->digits.len) ? 1 : -1;
@@ -132,160 +409,442 @@ static int superlong_abs_compare(const superlong* a, const superlong* b) {
   return 0;
 }
 
-static void superlong_abs_add_uint(const superlong* a, uint32_t b, superlong* res) {
-  superlong_clean(res);
+int superlong_compare(const superlong* a, const superlong* b) {
+  int sign_a = superlong_is_zero(a) ? 0 : a->sign;
+  int sign_b = superlong_is_zero(b) ? 0 : b->sign;
+  if (sign_a != sign_b)
+    return (sign_a > sign_b) ? 1 : -1;
+  if (sign_a == 0)
+    return 0;
+  return sign_a * superlong_abs_compare(a, b);
+}
 
-  n256plusplusplus carry = b;
-  for (size_t i = 0; i < a->digits.len; i++) {
-    carry += (n256plusplusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i);
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) (carry & 0xFF));
-    carry >>= 8;
+// res = |a| + |b|, adding in place when res is one of the operands
+static void superlong_abs_add(const superlong* a, const superlong* b, superlong* res) {
+  if (b == res) {
+    const superlong* t = a;
+    a = b;
+    b = t;
   }
-  while (carry) {
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) (carry & 0xFF));
-    carry >>= 8;
+  if (a != res)
+    superlong_copy(a, res);
+  size_t lb = b->digits.len;
+  size_t len = ((res->digits.len > lb) ? res->digits.len : lb) + 1;
+  superlong_pad(res, len);
+  unsigned carry = digits_add_n(res->digits.arr, b->digits.arr, lb);
+  digits_add_1(res->digits.arr + lb, len - lb, carry);
+  res->sign = 1;
+  superlong_normalize(res);
+}
+
+// res = |a| - |b| for |a| >= |b|, in place when res is one of the operands
+static void superlong_abs_sub(const superlong* a, const superlong* b, superlong* res) {
+  if (b == res && a != res) {
+    // res = |b| - |a| wraps around; its two's complement is the difference
+    size_t la = a->digits.len;
+    superlong_pad(res, la);
+    uint64_t borrow = digits_sub_n(res->digits.arr, a->digits.arr, la);
+    digits_sub_1(res->digits.arr + la, res->digits.len - la, borrow);
+    digits_neg(res->digits.arr, res->digits.len);
+  } else {
+    if (a != res)
+      superlong_copy(a, res);
+    size_t lb = b->digits.len;
+    superlong_pad(res, lb);
+    uint64_t borrow = digits_sub_n(res->digits.arr, b->digits.arr, lb);
+    digits_sub_1(res->digits.arr + lb, res->digits.len - lb, borrow);
   }
+  res->sign = 1;
   superlong_normalize(res);
 }
 
-static void superlong_abs_add(const superlong* a, const superlong* b, superlong* res) {
-  // Handle pointer aliasing
-  if (a == res || b == res) {
-    superlong temp_a, temp_b;
-    superlong_init(&temp_a);
-    superlong_init(&temp_b);
-    superlong_copy(a, &temp_a);
-    superlong_copy(b, &temp_b);
-    superlong_abs_add(&temp_a, &temp_b, res);
-    superlong_deinit(&temp_a);
-    superlong_deinit(&temp_b);
+// bit operations
+
+static void superlong_abs_incr(superlong* num) {
+  n256* d = num->digits.arr;
+  for (size_t i = 0; i < num->digits.len; i++) {
+    if (++d[i] != 0)
+      return;
+  }
+  sldigits_add_tail(SLDIGITS_ARR_PTR(num), 1);
+}
+
+// magnitude must be non-zero
+static void superlong_abs_decr(superlong* num) {
+  n256* d = num->digits.arr;
+  for (size_t i = 0; i < num->digits.len; i++) {
+    if (d[i]-- != 0)
+      break;
+  }
+}
+
+static void superlong_abs_set_bit(superlong* num, size_t bit, int value) {
+  size_t idx = bit / 8;
+  n256 mask = (n256) (1u << (bit % 8));
+
+  if (idx >= num->digits.len) {
+    if (!value)
+      return;
+    sldigits_fill(SLDIGITS_ARR_PTR(num), idx + 1 - num->digits.len, 0);
+  }
+  if (value)
+    num->digits.arr[idx] |= mask;
+  else
+    num->digits.arr[idx] &= (n256) ~mask;
+}
+
+static int superlong_abs_test_bit(const superlong* num, size_t bit) {
+  size_t idx = bit / 8;
+  if (idx >= num->digits.len)
+    return 0;
+  return (num->digits.arr[idx] >> (bit % 8)) & 1;
+}
+
+static int superlong_abs_low_bits_nonzero(const superlong* num, size_t bits) {
+  size_t bytes = bits / 8;
+  for (size_t i = 0; i < bytes && i < num->digits.len; i++) {
+    if (num->digits.arr[i] != 0)
+      return 1;
+  }
+  if (bytes < num->digits.len && (bits % 8) != 0)
+    return (num->digits.arr[bytes] & ((1u << (bits % 8)) - 1)) != 0;
+  return 0;
+}
+
+void superlong_shl(superlong* num, size_t bits) {
+  if (bits == 0 || superlong_is_zero(num))
     return;
+  size_t bytes = bits / 8;
+  unsigned shift = (unsigned) (bits % 8);
+  size_t len = num->digits.len;
+
+  sldigits_ensure_capacity(SLDIGITS_ARR_PTR(num), len + bytes + 1);
+  n256* d = num->digits.arr;
+
+  if (shift == 0) {
+    memmove(d + bytes, d, len);
+    num->digits.len = len + bytes;
+  } else {
+    d[len + bytes] = (n256) (d[len - 1] >> (8 - shift));
+    for (size_t i = len - 1; i > 0; i--)
+      d[i + bytes] = (n256) ((d[i] << shift) | (d[i - 1] >> (8 - shift)));
+    d[bytes] = (n256) (d[0] << shift);
+    num->digits.len = len + bytes + 1;
   }
-  
-  size_t max_len = (a->digits.len > b->digits.len) ? a->digits.len : b->digits.len;
-  superlong_clean(res);
+  memset(d, 0, bytes);
+  superlong_normalize(num);
+}
+
+// arithmetic shift: rounds towards minus infinity like two's complement
+void superlong_shr(superlong* num, size_t bits) {
+  if (bits == 0 || superlong_is_zero(num))
+    return;
+  size_t bytes = bits / 8;
+  unsigned shift = (unsigned) (bits % 8);
+  size_t len = num->digits.len;
+  n256* d = num->digits.arr;
 
-  n256plus carry = 0;
-  for (size_t i = 0; i < max_len; i++) {
-    n256plus sum = carry;
-    sum += (n256plus) sldigits_get_or(SLDIGITS_ARR_PTR(a), i, 0);
-    sum += (n256plus) sldigits_get_or(SLDIGITS_ARR_PTR(b), i, 0);
+  int round_up = (num->sign < 0) && superlong_abs_low_bits_nonzero(num, bits);
 
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) (sum & 0xFF));
-    carry = sum >> 8;
+  if (bytes >= len) {
+    num->digits.len = 1;
+    d[0] = round_up ? 1 : 0;
+    num->sign = round_up ? -1 : 0;
+    return;
   }
-  if (carry > 0)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) carry);
-  superlong_normalize(res);
+  size_t new_len = len - bytes;
+  if (shift == 0) {
+    memmove(d, d + bytes, new_len);
+  } else {
+    for (size_t i = 0; i + 1 < new_len; i++)
+      d[i] = (n256) ((d[i + bytes] >> shift) | (d[i + bytes + 1] << (8 - shift)));
+    d[new_len - 1] = (n256) (d[len - 1] >> shift);
+  }
+  num->digits.len = new_len;
+
+  if (round_up)
+    superlong_abs_incr(num);
+  superlong_normalize(num);
 }
 
-static void superlong_abs_sub_uint(const superlong* a, uint32_t b, superlong* res) {
-  superlong_clean(res);
+// byte `i` of the infinite two's complement representation
+static n256 superlong_twos_byte(const superlong* num, size_t i, unsigned* borrow) {
+  n256 m = (i < num->digits.len) ? num->digits.arr[i] : 0;
+  if (num->sign >= 0)
+    return m;
+  int v = (int) m - (int) *borrow;
+  *borrow = (v < 0);
+  return (n256) ~(n256) (v & 0xFF);
+}
 
-  int32_t borrow = 0;
-  n256plusplus bval = b;
-  for (size_t i = 0; i < a->digits.len; i++) {
-    n256plusplus digit = (n256plusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i);
-    n256plusplus sub = (i < 4) ? ((bval >> (i * 8)) & 0xFF) : 0;
+enum superlong_bitop { SUPERLONG_BITOP_AND, SUPERLONG_BITOP_OR, SUPERLONG_BITOP_XOR };
 
-    int32_t diff = (int32_t) digit - (int32_t) sub - borrow;
-    if (diff < 0) {
-      diff += 256;
-      borrow = 1;
-    } else
-      borrow = 0;
+static void superlong_bitop(const superlong* a, const superlong* b, superlong* res, enum superlong_bitop op) {
+  size_t len = (a->digits.len > b->digits.len) ? a->digits.len : b->digits.len;
+  int neg_a = a->sign < 0, neg_b = b->sign < 0;
+  int neg;
+  switch (op) {
+  case SUPERLONG_BITOP_AND: neg = neg_a & neg_b; break;
+  case SUPERLONG_BITOP_OR: neg = neg_a | neg_b; break;
+  default: neg = neg_a ^ neg_b; break;
+  }
 
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) (diff & 0xFF));
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, len + 1);
+
+  unsigned borrow_a = 1, borrow_b = 1, carry = 1;
+  for (size_t i = 0; i < len; i++) {
+    n256 x = superlong_twos_byte(a, i, &borrow_a);
+    n256 y = superlong_twos_byte(b, i, &borrow_b);
+    n256 r;
+    switch (op) {
+    case SUPERLONG_BITOP_AND: r = x & y; break;
+    case SUPERLONG_BITOP_OR: r = x | y; break;
+    default: r = x ^ y; break;
+    }
+    if (neg) {
+      unsigned v = (unsigned) (n256) ~r + carry;
+      carry = v >> 8;
+      r = (n256) v;
+    }
+    out.arr[i] = r;
   }
+  out.len = len;
+  if (neg && carry)
+    sldigits_add_tail(&out, 1);
+
+  superlong_deinit(res);
+  res->digits = out;
+  res->sign = neg ? -1 : 1;
   superlong_normalize(res);
 }
 
-static void superlong_abs_uint_sub(uint32_t b, const superlong* a, superlong* res) {
-  superlong_clean(res);
+void superlong_and(const superlong* a, const superlong* b, superlong* res) {
+  superlong_bitop(a, b, res, SUPERLONG_BITOP_AND);
+}
 
-  int32_t borrow = 0;
-  n256plusplus bval = b;
-  for (size_t i = 0; i < a->digits.len; i++) {
-    n256plusplus a_digit = (n256plusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i);
-    n256plusplus b_digit = (i < 4) ? ((bval >> (i * 8)) & 0xFF) : 0;
+void superlong_or(const superlong* a, const superlong* b, superlong* res) {
+  superlong_bitop(a, b, res, SUPERLONG_BITOP_OR);
+}
 
-    int32_t diff = (int32_t) b_digit - (int32_t) a_digit - borrow;
-    if (diff < 0) {
-      diff += 256;
-      borrow = 1;
-    } else
-      borrow = 0;
+void superlong_xor(const superlong* a, const superlong* b, superlong* res) {
+  superlong_bitop(a, b, res, SUPERLONG_BITOP_XOR);
+}
 
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) (diff & 0xFF));
+// ~a == -a - 1
+void superlong_not(const superlong* a, superlong* res) {
+  if (a != res)
+    superlong_copy(a, res);
+  if (res->sign >= 0) {
+    if (res->digits.len == 0)
+      sldigits_add_tail(SLDIGITS_ARR_PTR(res), 0);
+    superlong_abs_incr(res);
+    res->sign = -1;
+  } else {
+    superlong_abs_decr(res);
+    res->sign = 1;
   }
   superlong_normalize(res);
 }
 
-static void superlong_abs_sub(const superlong* a, const superlong* b, superlong* res) {
-  // Handle pointer aliasing
-  if (a == res || b == res) {
-    superlong temp_a, temp_b;
-    superlong_init(&temp_a);
-    superlong_init(&temp_b);
-    superlong_copy(a, &temp_a);
-    superlong_copy(b, &temp_b);
-    superlong_abs_sub(&temp_a, &temp_b, res);
-    superlong_deinit(&temp_a);
-    superlong_deinit(&temp_b);
-    return;
+static size_t popcount64(uint64_t x) {
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (size_t) ((x * 0x0101010101010101ULL) >> 56);
+}
+
+// negative numbers have infinitely many set bits: returns SIZE_MAX
+size_t superlong_popcount(const superlong* num) {
+  if (num->sign < 0)
+    return SIZE_MAX;
+  if (num->sign == 0)
+    return 0;
+
+  size_t count = 0, i = 0;
+  for (; i + 8 <= num->digits.len; i += 8) {
+    uint64_t word;
+    memcpy(&word, num->digits.arr + i, sizeof(word));
+    count += popcount64(word);
   }
-  
-  superlong_clean(res);
+  for (; i < num->digits.len; i++)
+    count += popcount64(num->digits.arr[i]);
+  return count;
+}
 
-  int borrow = 0;
-  for (size_t i = 0; i < a->digits.len; i++) {
-    int da = (int) sldigits_get(SLDIGITS_ARR_PTR(a), i);
-    int db = (int) sldigits_get_or(SLDIGITS_ARR_PTR(b), i, 0);
+// bits in the magnitude, 0 for zero
+size_t superlong_bit_length(const superlong* num) {
+  if (superlong_is_zero(num))
+    return 0;
+  size_t len = num->digits.len;
+  while (len > 0 && num->digits.arr[len - 1] == 0)
+    len--;
+  if (len == 0)
+    return 0;
+
+  size_t bits = (len - 1) * 8;
+  for (n256 top = num->digits.arr[len - 1]; top != 0; top >>= 1)
+    bits++;
+  return bits;
+}
 
-    int diff = da - db - borrow;
-    if (diff < 0) {
-      diff += 256;
-      borrow = 1;
-    } else
-      borrow = 0;
+// index of the lowest set bit, 0 for zero (same for -num)
+size_t superlong_trailing_zeros(const superlong* num) {
+  if (superlong_is_zero(num))
+    return 0;
+  size_t i = 0;
+  while (i < num->digits.len && num->digits.arr[i] == 0)
+    i++;
+  if (i == num->digits.len)
+    return 0;
+
+  size_t bits = i * 8;
+  for (n256 low = num->digits.arr[i]; (low & 1) == 0; low >>= 1)
+    bits++;
+  return bits;
+}
+
+int superlong_test_bit(const superlong* num, size_t bit) {
+  if (num->sign >= 0)
+    return superlong_abs_test_bit(num, bit);
+
+  // two's complement of -m is ~(m - 1): bits below the lowest set bit of m are 0,
+  // that bit is 1 and all higher bits are inverted
+  size_t tz = superlong_trailing_zeros(num);
+  if (bit < tz)
+    return 0;
+  if (bit == tz)
+    return 1;
+  return !superlong_abs_test_bit(num, bit);
+}
 
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), (n256) diff);
+static void superlong_write_bit(superlong* num, size_t bit, int value) {
+  if (num->sign >= 0) {
+    if (num->digits.len == 0)
+      sldigits_add_tail(SLDIGITS_ARR_PTR(num), 0);
+    superlong_abs_set_bit(num, bit, value);
+    num->sign = 1;
+    superlong_normalize(num);
+    return;
   }
-  superlong_normalize(res);
+  // operate on m - 1 whose bits are the inverse of the two's complement form
+  superlong_abs_decr(num);
+  superlong_abs_set_bit(num, bit, !value);
+  superlong_abs_incr(num);
+  superlong_normalize(num);
 }
 
-// operations
+void superlong_set_bit(superlong* num, size_t bit) { superlong_write_bit(num, bit, 1); }
 
-void superlong_add_uint(const superlong* a, uint32_t b, superlong* res) {
-  if (a->sign == 0) {
-    superlong_from_uint(res, b);
+void superlong_clear_bit(superlong* num, size_t bit) { superlong_write_bit(num, bit, 0); }
+
+// execution contexts
+
+#ifndef __STDC_NO_THREADS__
+static _Thread_local superlong_exec* superlong_exec_current = NULL;
+#else
+static superlong_exec* superlong_exec_current = NULL;
+#endif
+
+void superlong_exec_init(superlong_exec* exec, superlong_progress progress, void* ctx) {
+  exec->progress = progress;
+  exec->ctx = ctx;
+  exec->cancelled = 0;
+  exec->op = -1;
+  exec->done = 0;
+  exec->total = 0;
+  exec->reported = 0;
+}
+
+void superlong_exec_cancel(superlong_exec* exec) { __atomic_store_n(&exec->cancelled, 1, __ATOMIC_RELAXED); }
+
+int superlong_exec_cancelled(const superlong_exec* exec) { return __atomic_load_n(&exec->cancelled, __ATOMIC_RELAXED); }
+
+static void superlong_exec_report(superlong_exec* exec, uint64_t done) {
+  if (done > exec->total)
+    done = exec->total;
+  uint64_t reported = __atomic_load_n(&exec->reported, __ATOMIC_RELAXED);
+  // about 256 reports per operation, one thread wins each of them
+  if (done < exec->total && done - reported < exec->total / 256 + 1)
     return;
-  }
-  if (b == 0) {
-    superlong_copy(a, res);
+  if (reported == exec->total ||
+      !__atomic_compare_exchange_n(&exec->reported, &reported, done, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
     return;
+  if (exec->progress(exec->ctx, done, exec->total) != 0)
+    superlong_exec_cancel(exec);
+}
+
+// counts units of op towards the running _ex call and tells whether it was cancelled;
+// polls from nested operations of another kind only check the flag
+int superlong_exec_poll(int op, uint64_t units) {
+  superlong_exec* exec = superlong_exec_current;
+  if (exec == NULL)
+    return 0;
+  if (op == exec->op && units > 0) {
+    uint64_t done = __atomic_add_fetch(&exec->done, units, __ATOMIC_RELAXED);
+    if (exec->progress)
+      superlong_exec_report(exec, done);
   }
-  if (a->sign > 0) {
-    superlong_abs_add_uint(a, b, res);
-    res->sign = 1;
-  } else {
-    int cmp = superlong_abs_compare_uint(a, b);
+  return superlong_exec_cancelled(exec);
+}
 
-    if (cmp == 0) {
-      superlong_clean(res);
-      res->sign = 0;
-    } else if (cmp > 0) {
-      superlong_abs_sub_uint(a, b, res);
-      res->sign = -1;
-    } else {
-      superlong_abs_uint_sub(b, a, res);
-      res->sign = 1;
-    }
+superlong_exec* superlong_exec_begin(superlong_exec* exec, int op, uint64_t total) {
+  superlong_exec* saved = superlong_exec_current;
+  exec->op = op;
+  exec->done = 0;
+  exec->total = total;
+  exec->reported = 0;
+  superlong_exec_current = exec;
+  return saved;
+}
+
+int superlong_exec_finish(superlong_exec* exec, superlong_exec* saved) {
+  superlong_exec_current = saved;
+  if (superlong_exec_cancelled(exec))
+    return -1;
+  if (exec->progress)
+    superlong_exec_report(exec, exec->total);
+  return 0;
+}
+
+// moves out into res unless the call was cancelled
+static int superlong_exec_end(superlong_exec* exec, superlong_exec* saved, superlong* out, superlong* res) {
+  if (superlong_exec_finish(exec, saved) != 0) {
+    superlong_deinit(out);
+    return -1;
   }
-  superlong_normalize(res);
+  superlong_deinit(res);
+  *res = *out;
+  return 0;
+}
+
+// operations
+
+void superlong_add_ui64(const superlong* a, uint64_t b, superlong* res) {
+  if (a != res)
+    superlong_copy(a, res);
+
+  n256 bp[8];
+  for (size_t i = 0; i < 8; i++)
+    bp[i] = (n256) (b >> (8 * i));
+  superlong_accumulate_digits(res, bp, 8, 1);
+}
+
+void superlong_sub_ui64(const superlong* a, uint64_t b, superlong* res) {
+  if (a != res)
+    superlong_copy(a, res);
+
+  n256 bp[8];
+  for (size_t i = 0; i < 8; i++)
+    bp[i] = (n256) (b >> (8 * i));
+  superlong_accumulate_digits(res, bp, 8, -1);
 }
 
+void superlong_add_uint(const superlong* a, uint32_t b, superlong* res) { superlong_add_ui64(a, b, res); }
+
 void superlong_add(const superlong* a, const superlong* b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_ADD, a->digits.len + b->digits.len);
   if (a->sign == 0) {
     superlong_copy(b, res);
     return;
@@ -294,9 +853,11 @@ void superlong_add(const superlong* a, const superlong* b, superlong* res) {
     superlong_copy(a, res);
     return;
   }
-  if (a->sign == b->sign) {
+  // res may alias a or b: keep the signs before it is overwritten
+  int sign_a = a->sign, sign_b = b->sign;
+  if (sign_a == sign_b) {
     superlong_abs_add(a, b, res);
-    res->sign = a->sign;
+    res->sign = sign_a;
   } else {
     int cmp = superlong_abs_compare(a, b);
 
@@ -305,56 +866,19 @@ void superlong_add(const superlong* a, const superlong* b, superlong* res) {
       res->sign = 0;
     } else if (cmp > 0) {
       superlong_abs_sub(a, b, res);
-      res->sign = a->sign;
+      res->sign = sign_a;
     } else {
       superlong_abs_sub(b, a, res);
-      res->sign = b->sign;
+      res->sign = sign_b;
     }
   }
   superlong_normalize(res);
 }
 
-void superlong_sub_uint(const superlong* a, uint32_t b, superlong* res) {
-  // Handle case where a == res by using a temporary
-  if (a == res) {
-    superlong temp;
-    superlong_init(&temp);
-    superlong_copy(a, &temp);
-    superlong_sub_uint(&temp, b, res);
-    superlong_deinit(&temp);
-    return;
-  }
-  
-  if (a->sign == 0) {
-    superlong_from_uint(res, b);
-    res->sign = -1;
-    return;
-  }
-  if (b == 0) {
-    superlong_copy(a, res);
-    return;
-  }
-  if (a->sign > 0) {
-    int cmp = superlong_abs_compare_uint(a, b);
-
-    if (cmp == 0) {
-      superlong_clean(res);
-      res->sign = 0;
-    } else if (cmp > 0) {
-      superlong_abs_sub_uint(a, b, res);
-      res->sign = 1;
-    } else {
-      superlong_abs_uint_sub(b, a, res);
-      res->sign = -1;
-    }
-  } else {
-    superlong_abs_add_uint(a, b, res);
-    res->sign = -1;
-  }
-  superlong_normalize(res);
-}
+void superlong_sub_uint(const superlong* a, uint32_t b, superlong* res) { superlong_sub_ui64(a, b, res); }
 
 void superlong_sub(const superlong* a, const superlong* b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_SUB, a->digits.len + b->digits.len);
   superlong neg_b;
   superlong_init(&neg_b);
   superlong_copy(b, &neg_b);
@@ -367,6 +891,7 @@ void superlong_sub(const superlong* a, const superlong* b, superlong* res) {
 }
 
 void superlong_mul_uint(const superlong* a, uint32_t b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_MUL_UINT, a->digits.len);
   if (a->sign == 0 || b == 0) {
     superlong_clean(res);
     res->sign = 0;
@@ -388,17 +913,13 @@ void superlong_mul_uint(const superlong* a, uint32_t b, superlong* res) {
     return;
   }
   
-  superlong_clean(res);
-  
-  if (b == 256) {
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), 0);
-    for (size_t i = 0; i < a->digits.len; i++) {
-      sldigits_add_tail(SLDIGITS_ARR_PTR(res), sldigits_get(SLDIGITS_ARR_PTR(a), i));
-    }
-    res->sign = a->sign;
-    superlong_normalize(res);
+  if ((b & (b - 1)) == 0) {
+    superlong_copy(a, res);
+    superlong_shl(res, (size_t) __builtin_ctz(b));
     return;
   }
+  superlong_clean(res);
+
   n256plusplusplus carry = 0;
   for (size_t i = 0; i < a->digits.len; i++) {
     n256plusplusplus product = (n256plusplusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i) * (n256plusplusplus) b + carry;
@@ -413,108 +934,77 @@ void superlong_mul_uint(const superlong* a, uint32_t b, superlong* res) {
   superlong_normalize(res);
 }
 
-static void superlong_shift_left_bytes(superlong* num, size_t bytes) {
-  if (bytes == 0 || superlong_is_zero(num))
+void superlong_mul_ui64(const superlong* a, uint64_t b, superlong* res) {
+  if (b <= UINT32_MAX) {
+    superlong_mul_uint(a, (uint32_t) b, res);
     return;
-
-  superlong temp;
-  superlong_init(&temp);
-
-  for (size_t i = 0; i < bytes; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&temp), 0);
-
-  for (size_t i = 0; i < num->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&temp), sldigits_get(SLDIGITS_ARR_PTR(num), i));
-
-  temp.sign = num->sign;
-  superlong_deinit(num);
-  *num = temp;
+  }
+  if (a->sign == 0) {
+    superlong_clean(res);
+    res->sign = 0;
+    return;
+  }
+  n256 bp[8];
+  for (size_t i = 0; i < 8; i++)
+    bp[i] = (n256) (b >> (8 * i));
+
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, a->digits.len + 8);
+  digits_mul_basecase(out.arr, a->digits.arr, a->digits.len, bp, 8);
+  out.len = a->digits.len + 8;
+  superlong_set_digits(res, out, a->sign);
 }
 
-static void superlong_mul_simple(const superlong* a, const superlong* b, superlong* res) {
-  superlong_clean(res);
-  superlong temp_res;
-  superlong_init(&temp_res);
-  superlong_from_uint(&temp_res, 0); // Initialize as zero properly
+static void superlong_shift_left_bytes(superlong* num, size_t bytes) { superlong_shl(num, bytes * 8); }
 
-  for (size_t i = 0; i < a->digits.len; i++) {
-    superlong temp;
-    superlong_init(&temp);
-    superlong_clean(&temp); // Clean to get empty array
-
-    for (size_t k = 0; k < i; k++)
-      sldigits_add_tail(SLDIGITS_ARR_PTR(&temp), 0);
-
-    n256plusplus carry = 0;
-    for (size_t j = 0; j < b->digits.len; j++) {
-      n256plusplus a_digit = (n256plusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i);
-      n256plusplus b_digit = (n256plusplus) sldigits_get(SLDIGITS_ARR_PTR(b), j);
-      n256plusplus product = (n256plusplus) (a_digit * b_digit) + carry;
-      sldigits_add_tail(SLDIGITS_ARR_PTR(&temp), (n256) (product & 0xFF));
-      carry = product >> 8;
-    }
-    while (carry > 0) {
-      sldigits_add_tail(SLDIGITS_ARR_PTR(&temp), (n256) (carry & 0xFF));
-      carry >>= 8;
-    }
-    
-    temp.sign = 1; // Set sign after adding digits
-
-    superlong new_temp_res;
-    superlong_init(&new_temp_res);
-    superlong_add(&temp_res, &temp, &new_temp_res);
-
-    superlong_deinit(&temp_res);
-    superlong_deinit(&temp);
-    temp_res = new_temp_res;
-  }
-  superlong_deinit(res);
-  *res = temp_res;
-  superlong_normalize(res);
+static void superlong_mul_simple(const superlong* a, const superlong* b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_MUL_BASECASE, a->digits.len + b->digits.len);
+  superlong_exec_poll(SUPERLONG_STAT_MUL, (uint64_t) a->digits.len * b->digits.len);
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, a->digits.len + b->digits.len);
+  digits_mul_basecase(out.arr, a->digits.arr, a->digits.len, b->digits.arr, b->digits.len);
+  out.len = a->digits.len + b->digits.len;
+  superlong_set_digits(res, out, 1);
 }
 
+static void superlong_mul_abs(const superlong* x, const superlong* y, superlong* res);
+
 static void superlong_mul_karatsuba(const superlong* x, const superlong* y, superlong* res) {
   size_t min_len = (x->digits.len < y->digits.len) ? x->digits.len : y->digits.len;
 
-  if (min_len < 16) {
+  if (min_len < SUPERLONG_KARATSUBA_THRESHOLD) {
     superlong_mul_simple(x, y, res);
     return;
   }
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_MUL_KARATSUBA, x->digits.len + y->digits.len);
+  if (superlong_exec_poll(SUPERLONG_STAT_MUL, 0)) {
+    // cancelled: the caller discards the result, skip the work
+    superlong_clean(res);
+    return;
+  }
   size_t k = min_len / 2;
 
   superlong a, b;
   superlong_init(&a);
   superlong_init(&b);
-
-  for (size_t i = 0; i < k && i < x->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&b), sldigits_get(SLDIGITS_ARR_PTR(x), i));
-
-  for (size_t i = k; i < x->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&a), sldigits_get(SLDIGITS_ARR_PTR(x), i));
-
-  a.sign = 1;
-  b.sign = 1;
+  superlong_from_digits(&b, x->digits.arr, k);
+  superlong_from_digits(&a, x->digits.arr + k, x->digits.len - k);
 
   superlong c, d;
   superlong_init(&c);
   superlong_init(&d);
-
-  for (size_t i = 0; i < k && i < y->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&d), sldigits_get(SLDIGITS_ARR_PTR(y), i));
-
-  for (size_t i = k; i < y->digits.len; i++)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(&c), sldigits_get(SLDIGITS_ARR_PTR(y), i));
-
-  c.sign = 1;
-  d.sign = 1;
+  superlong_from_digits(&d, y->digits.arr, k);
+  superlong_from_digits(&c, y->digits.arr + k, y->digits.len - k);
 
   superlong ac;
   superlong_init(&ac);
-  superlong_mul_karatsuba(&a, &c, &ac);
+  superlong_mul_abs(&a, &c, &ac);
 
   superlong bd;
   superlong_init(&bd);
-  superlong_mul_karatsuba(&b, &d, &bd);
+  superlong_mul_abs(&b, &d, &bd);
 
   superlong a_b, c_d;
   superlong_init(&a_b);
@@ -524,7 +1014,7 @@ static void superlong_mul_karatsuba(const superlong* x, const superlong* y, supe
 
   superlong ad_bc_ac_bd;
   superlong_init(&ad_bc_ac_bd);
-  superlong_mul_karatsuba(&a_b, &c_d, &ad_bc_ac_bd);
+  superlong_mul_abs(&a_b, &c_d, &ad_bc_ac_bd);
 
   superlong temp;
   superlong_init(&temp);
@@ -559,21 +1049,121 @@ static void superlong_mul_karatsuba(const superlong* x, const superlong* y, supe
   superlong_deinit(&temp);
 }
 
+// read-only superlong over existing digits, never deinit'ed
+static superlong superlong_digits_shell(const n256* digits, size_t len) {
+  while (len > 0 && digits[len - 1] == 0)
+    len--;
+  superlong shell = {{(n256*) digits, len, len}, (len > 0) ? 1 : 0};
+  return shell;
+}
+
+// cuts the long operand into chunks as long as the short one and accumulates the balanced products in place
+static void superlong_mul_unbalanced(const superlong* x, const superlong* y, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_MUL_UNBALANCED, x->digits.len + y->digits.len);
+  size_t chunk_len = y->digits.len;
+  size_t total = x->digits.len + y->digits.len;
+
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, total);
+  memset(out.arr, 0, total);
+  out.len = total;
+
+  superlong part;
+  superlong_init(&part);
+  for (size_t off = 0; off < x->digits.len; off += chunk_len) {
+    size_t len = (x->digits.len - off < chunk_len) ? x->digits.len - off : chunk_len;
+    superlong chunk = superlong_digits_shell(x->digits.arr + off, len);
+    if (chunk.sign == 0)
+      continue;
+    if (superlong_exec_poll(SUPERLONG_STAT_MUL, 0))
+      break;
+
+    superlong_mul_abs(&chunk, y, &part);
+    unsigned carry = digits_add_n(out.arr + off, part.digits.arr, part.digits.len);
+    digits_add_1(out.arr + off + part.digits.len, total - off - part.digits.len, carry);
+  }
+  superlong_deinit(&part);
+  superlong_set_digits(res, out, 1);
+}
+
+// |x| * |y|, picks the multiplication algorithm from the operand lengths
+static void superlong_mul_abs(const superlong* x, const superlong* y, superlong* res) {
+  const superlong* longer = (x->digits.len >= y->digits.len) ? x : y;
+  const superlong* shorter = (longer == x) ? y : x;
+
+  if (shorter->digits.len < SUPERLONG_KARATSUBA_THRESHOLD)
+    superlong_mul_simple(longer, shorter, res);
+  else if (longer->digits.len >= 2 * shorter->digits.len)
+    superlong_mul_unbalanced(longer, shorter, res);
+  else
+    superlong_mul_karatsuba(x, y, res);
+}
+
 void superlong_mul(const superlong* a, const superlong* b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_MUL, a->digits.len + b->digits.len);
   if ((a->sign == 0) || (b->sign == 0)) {
     superlong_clean(res);
     res->sign = 0;
     return;
   }
-  superlong_mul_karatsuba(a, b, res);
-  res->sign = (a->sign == b->sign) ? 1 : -1;
+  int sign = (a->sign == b->sign) ? 1 : -1;
+  superlong_mul_abs(a, b, res);
+  res->sign = sign;
   superlong_normalize(res);
 }
 
+static void superlong_addmul_signed(const superlong* a, const superlong* b, superlong* res, int sign) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_ADDMUL, a->digits.len + b->digits.len);
+  if (a->sign == 0 || b->sign == 0)
+    return;
+  int tsign = sign * a->sign * b->sign;
+  const superlong* longer = (a->digits.len >= b->digits.len) ? a : b;
+  const superlong* shorter = (longer == a) ? b : a;
+
+  if (a == res || b == res || shorter->digits.len >= SUPERLONG_KARATSUBA_THRESHOLD) {
+    superlong prod;
+    superlong_init(&prod);
+    superlong_mul(a, b, &prod);
+    superlong_accumulate_digits(res, prod.digits.arr, prod.digits.len, tsign);
+    superlong_deinit(&prod);
+    return;
+  }
+  superlong_addmul_rows(res, longer->digits.arr, longer->digits.len, shorter->digits.arr, shorter->digits.len, tsign);
+}
+
+void superlong_addmul(const superlong* a, const superlong* b, superlong* res) { superlong_addmul_signed(a, b, res, 1); }
+
+void superlong_submul(const superlong* a, const superlong* b, superlong* res) { superlong_addmul_signed(a, b, res, -1); }
+
+static void superlong_addmul_uint_signed(const superlong* a, uint32_t b, superlong* res, int sign) {
+  if (a->sign == 0 || b == 0)
+    return;
+  if (a == res) {
+    // res += res * b == res * (b + 1), res -= res * b == -(res * (b - 1))
+    if (sign > 0) {
+      superlong_mul_ui64(res, (uint64_t) b + 1, res);
+    } else {
+      superlong_mul_uint(res, b - 1, res);
+      superlong_negate(res);
+    }
+    return;
+  }
+  n256 bp[4];
+  for (size_t i = 0; i < 4; i++)
+    bp[i] = (n256) (b >> (8 * i));
+  superlong_addmul_rows(res, a->digits.arr, a->digits.len, bp, 4, sign * a->sign);
+}
+
+void superlong_addmul_ui(const superlong* a, uint32_t b, superlong* res) { superlong_addmul_uint_signed(a, b, res, 1); }
+
+void superlong_submul_ui(const superlong* a, uint32_t b, superlong* res) { superlong_addmul_uint_signed(a, b, res, -1); }
+
 static n256 bin_find_digit(const superlong* remainder, const superlong* divisor) {
-  n256 left = 1, right = 255, best = 0;
+  // wider than a digit so left can step past 255
+  unsigned left = 1, right = 255, best = 0;
   while (left <= right) {
-    n256 mid = (n256) (left + (right - left) / 2);
+    unsigned mid = left + (right - left) / 2;
 
     superlong prod;
     superlong_init(&prod);
@@ -588,65 +1178,144 @@ static n256 bin_find_digit(const superlong* remainder, const superlong* divisor)
 
     superlong_deinit(&prod);
   }
-  return best;
+  return (n256) best;
+}
+
+void superlong_preinv_init(superlong_preinv* inv, uint32_t d) {
+  if (d == 0) {
+    perror("Division by zero\n");
+    exit(1);
+  }
+  inv->d = d;
+  inv->shift = (unsigned) __builtin_clz(d);
+  inv->norm = d << inv->shift;
+  inv->inv = (uint32_t) (UINT64_MAX / inv->norm - ((uint64_t) 1 << 32));
+}
+
+uint32_t superlong_divrem_preinv(const superlong* a, const superlong_preinv* inv, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_DIVREM_PREINV, a->digits.len);
+  if (a->sign == 0) {
+    superlong_clean(res);
+    res->sign = 0;
+    return 0;
+  }
+  superlong_copy(a, res);
+  uint32_t rem = digits_divrem_preinv(res->digits.arr, res->digits.arr, res->digits.len, inv);
+  superlong_normalize(res);
+  return rem;
+}
+
+uint32_t superlong_mod_preinv(const superlong* a, const superlong_preinv* inv) {
+  if (a->sign == 0)
+    return 0;
+  return digits_divrem_preinv(NULL, a->digits.arr, a->digits.len, inv);
+}
+
+uint32_t superlong_mod_ui(const superlong* a, uint32_t b) {
+  superlong_preinv inv;
+  superlong_preinv_init(&inv, b);
+  return superlong_mod_preinv(a, &inv);
 }
 
 void superlong_div_uint(const superlong* a, uint32_t b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_DIV_UINT, a->digits.len);
   if (b == 0) {
     perror("Division by zero\n");
     exit(1);
   }
-  
-  // Handle case where a == res by using a temporary
-  if (a == res) {
-    superlong temp;
-    superlong_init(&temp);
-    superlong_copy(a, &temp);
-    superlong_div_uint(&temp, b, res);
-    superlong_deinit(&temp);
+  if (a->sign == 0) {
+    superlong_clean(res);
+    res->sign = 0;
     return;
   }
-  
+  int sign = a->sign;
+  if ((b & (b - 1)) == 0) {
+    // truncating division: shift the magnitude and restore the sign
+    superlong_copy(a, res);
+    res->sign = 1;
+    superlong_shr(res, (size_t) __builtin_ctz(b));
+    if (res->sign != 0)
+      res->sign = sign;
+    return;
+  }
+  superlong_preinv inv;
+  superlong_preinv_init(&inv, b);
+  superlong_divrem_preinv(a, &inv, res);
+}
+
+void superlong_divexact_uint(const superlong* a, uint32_t b, superlong* res) {
+  if (b == 0) {
+    perror("Division by zero\n");
+    exit(1);
+  }
   if (a->sign == 0) {
     superlong_clean(res);
     res->sign = 0;
     return;
   }
-  if (b == 1) {
+  int sign = a->sign;
+  superlong_copy(a, res);
+  res->sign = 1;
+  unsigned twos = (unsigned) __builtin_ctz(b);
+  superlong_shr(res, twos);
+  b >>= twos;
+
+  if (b > 1) {
+    // inverse of b modulo 256 by Newton iteration: 3, 6, 12 correct bits
+    n256 dinv = (n256) b;
+    for (int i = 0; i < 2; i++)
+      dinv = (n256) (dinv * (n256) (2 - (n256) (b * dinv)));
+    digits_divexact_odd(res->digits.arr, res->digits.arr, res->digits.len, b, dinv);
+  }
+  res->sign = sign;
+  superlong_normalize(res);
+}
+
+void superlong_divexact_by3(const superlong* a, superlong* res) {
+  if (a != res)
     superlong_copy(a, res);
+  if (res->sign == 0)
+    return;
+  // 3 * 0xAB == 1 (mod 256)
+  digits_divexact_odd(res->digits.arr, res->digits.arr, res->digits.len, 3, 0xAB);
+  superlong_normalize(res);
+}
+
+void superlong_div_ui64(const superlong* a, uint64_t b, superlong* res) {
+  if (b <= UINT32_MAX) {
+    superlong_div_uint(a, (uint32_t) b, res);
     return;
   }
-  if (b == 256) {
+  if (a->sign == 0) {
     superlong_clean(res);
-    if (a->digits.len > 1) {
-      for (size_t i = 1; i < a->digits.len; i++) {
-        sldigits_add_tail(SLDIGITS_ARR_PTR(res), sldigits_get(SLDIGITS_ARR_PTR(a), i));
-      }
-    }
-    res->sign = a->sign;
-    superlong_normalize(res);
+    res->sign = 0;
     return;
   }
-  superlong_clean(res);
-
-  n256plusplusplus remaind = 0;
-  n256* q_digits = nc_malloc(a->digits.len * sizeof(n256));
-  size_t q_len = 0;
+  // remainder * 256 no longer fits in 64 bits: restoring division one bit at a time
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, a->digits.len);
+  uint64_t remaind = 0;
   for (size_t i = a->digits.len; i-- > 0;) {
-    n256plusplusplus cur = ((n256plusplusplus) sldigits_get(SLDIGITS_ARR_PTR(a), i) + remaind * 256);
-    n256plusplusplus q_digit = cur / b;
-    remaind = cur % b;
-    q_digits[q_len++] = (n256) q_digit;
+    n256 digit = a->digits.arr[i];
+    n256 q_digit = 0;
+    for (int bit = 7; bit >= 0; bit--) {
+      uint64_t overflow = remaind >> 63;
+      remaind = (remaind << 1) | ((digit >> bit) & 1);
+      q_digit = (n256) (q_digit << 1);
+      if (overflow || remaind >= b) {
+        remaind -= b;
+        q_digit |= 1;
+      }
+    }
+    out.arr[i] = q_digit;
   }
-  // from big-endian to little-endian
-  for (size_t i = q_len; i > 0; i--)
-    sldigits_add_tail(SLDIGITS_ARR_PTR(res), q_digits[i - 1]);
-  free(q_digits);
-  res->sign = a->sign;
-  superlong_normalize(res);
+  out.len = a->digits.len;
+  superlong_set_digits(res, out, a->sign);
 }
 
 void superlong_div(const superlong* a, const superlong* b, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_DIV, a->digits.len + b->digits.len);
   if (b->sign == 0) {
     perror("Division by zero\n");
     exit(1);
@@ -666,13 +1335,13 @@ void superlong_div(const superlong* a, const superlong* b, superlong* res) {
     }
     if (b_val != 0) {
       superlong_div_uint(a, b_val, res);
-      if (sign < 0 && res->sign != 0) {
-        res->sign = -1;
-      }
+      if (res->sign != 0)
+        res->sign = sign;
       return;
     }
   }
 
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_DIV_LONG, a->digits.len + b->digits.len);
   superlong divid, divis;
   superlong_init(&divid);
   superlong_init(&divis);
@@ -737,12 +1406,14 @@ void superlong_div(const superlong* a, const superlong* b, superlong* res) {
       superlong_deinit(&product);
     }
     q_digits[q_len++] = q_digit;
+    if (superlong_exec_poll(SUPERLONG_STAT_DIV, 1))
+      break;
   }
   // from big-endian to little-endian
   for (size_t i = q_len; i > 0; i--)
     sldigits_add_tail(SLDIGITS_ARR_PTR(&quo), q_digits[i - 1]);
 
-  free(q_digits);
+  nc_free(q_digits);
 
   quo.sign = sign; // Set sign before normalize
   superlong_normalize(&quo);
@@ -756,68 +1427,1092 @@ void superlong_div(const superlong* a, const superlong* b, superlong* res) {
   superlong_deinit(&remaind);
 }
 
-void superlong_factorial(uint32_t n, superlong* res) {
+// product trees
+
+#define SUPERLONG_PROD_LEAF 8
+#define SUPERLONG_PROD_PARALLEL_MIN 64
+
+static unsigned superlong_threads = 1;
+
+void superlong_set_threads(unsigned threads) { superlong_threads = (threads > 0) ? threads : 1; }
+
+unsigned superlong_get_threads(void) { return superlong_threads; }
+
+// factors are either superlongs, an array of uint32 or the consecutive run first, first + 1, ...
+typedef struct {
+  const superlong* const* nums;
+  const uint32_t* vals;
+  uint32_t first;
+} superlong_prod_source;
+
+static uint32_t superlong_prod_source_uint(const superlong_prod_source* src, size_t i) {
+  return src->vals ? src->vals[i] : src->first + (uint32_t) i;
+}
+
+static void superlong_prod_leaf(const superlong_prod_source* src, size_t lo, size_t hi, superlong* res) {
+  superlong_exec_poll(SUPERLONG_STAT_FACTORIAL, hi - lo);
+  if (src->nums) {
+    superlong_copy(src->nums[lo], res);
+    for (size_t i = lo + 1; i < hi; i++)
+      superlong_mul(res, src->nums[i], res);
+    return;
+  }
+  // two uint32 factors always fit in one 64-bit multiplier
   superlong_from_uint(res, 1);
+  for (size_t i = lo; i < hi; i += 2) {
+    uint64_t pair = superlong_prod_source_uint(src, i);
+    if (i + 1 < hi)
+      pair *= superlong_prod_source_uint(src, i + 1);
+    superlong_mul_ui64(res, pair, res);
+  }
+}
 
-  superlong temp;
-  superlong_init(&temp);
+static void superlong_prod_tree(const superlong_prod_source* src, size_t lo, size_t hi, superlong* res, unsigned threads);
+
+#ifndef __STDC_NO_THREADS__
+typedef struct {
+  const superlong_prod_source* src;
+  size_t lo, hi;
+  unsigned threads;
+  superlong* res;
+  superlong_exec* exec;
+} superlong_prod_job;
+
+static int superlong_prod_thread(void* arg) {
+  superlong_prod_job* job = arg;
+  superlong_exec_current = job->exec;
+  superlong_prod_tree(job->src, job->lo, job->hi, job->res, job->threads);
+  return 0;
+}
+#endif
 
-  for (uint32_t i = 2; i <= n; i++) {
-    superlong_mul_uint(res, i, &temp);
-    superlong_copy(&temp, res);
+static void superlong_prod_tree(const superlong_prod_source* src, size_t lo, size_t hi, superlong* res, unsigned threads) {
+  if (superlong_exec_poll(SUPERLONG_STAT_FACTORIAL, 0)) {
+    superlong_from_uint(res, 1);
+    return;
   }
-  superlong_deinit(&temp);
+  if (hi - lo <= SUPERLONG_PROD_LEAF) {
+    superlong_prod_leaf(src, lo, hi, res);
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  superlong left, right;
+  superlong_init(&left);
+  superlong_init(&right);
+
+#ifndef __STDC_NO_THREADS__
+  if (threads > 1 && hi - lo >= SUPERLONG_PROD_PARALLEL_MIN) {
+    // the left half goes to a new thread, the right one stays on this thread
+    superlong_prod_job job = {src, lo, mid, threads / 2, &left, superlong_exec_current};
+    thrd_t thread;
+    if (thrd_create(&thread, superlong_prod_thread, &job) == thrd_success) {
+      superlong_prod_tree(src, mid, hi, &right, threads - threads / 2);
+      thrd_join(thread, NULL);
+    } else {
+      superlong_prod_tree(src, lo, mid, &left, 1);
+      superlong_prod_tree(src, mid, hi, &right, 1);
+    }
+  } else
+#endif
+  {
+    superlong_prod_tree(src, lo, mid, &left, threads);
+    superlong_prod_tree(src, mid, hi, &right, threads);
+  }
+  superlong_mul(&left, &right, res);
+  superlong_deinit(&left);
+  superlong_deinit(&right);
 }
 
-static n256plus superlong_div_uint10(superlong* num) {
-  n256plus remainder = 0;
+void superlong_prod_array(const superlong* const* nums, size_t n, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_PROD_ARRAY, n);
+  if (n == 0) {
+    superlong_from_uint(res, 1);
+    return;
+  }
+  // res may be one of the factors: build the product aside
+  superlong_prod_source src = {nums, NULL, 0};
+  superlong prod;
+  superlong_init(&prod);
+  superlong_prod_tree(&src, 0, n, &prod, superlong_threads);
+  superlong_deinit(res);
+  *res = prod;
+}
 
-  for (size_t i = num->digits.len; i > 0; i--) {
-    size_t idx = i - 1;
-    n256plus current = (n256plus) ((n256plus) sldigits_get(SLDIGITS_ARR_PTR(num), idx) + remainder * (n256plus) 256);
-    n256plus new_digit = (n256plus) (current / (n256plus) 10);
-    remainder = (n256plus) (current % (n256plus) 10);
-    sldigits_set(SLDIGITS_ARR_PTR(num), idx, (n256) new_digit);
+void superlong_prod_array_uint(const uint32_t* nums, size_t n, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_PROD_ARRAY, n);
+  if (n == 0) {
+    superlong_from_uint(res, 1);
+    return;
   }
-  superlong_normalize(num);
-  return remainder;
+  superlong_prod_source src = {NULL, nums, 0};
+  superlong_prod_tree(&src, 0, n, res, superlong_threads);
+}
+
+void superlong_prod_range(uint32_t first, size_t count, superlong* res) {
+  if (count == 0) {
+    superlong_from_uint(res, 1);
+    return;
+  }
+  superlong_prod_source src = {NULL, NULL, first};
+  superlong_prod_tree(&src, 0, count, res, superlong_threads);
 }
 
-char* superlong_to_decimal_str(const superlong* num) {
+// carry-save accumulation
+
+// each add puts less than 2^32 into a lane, so an int64 lane survives 2^30 of them
+#define SUPERLONG_ACCUMULATOR_SPAN ((size_t) 1 << 30)
+
+void superlong_accumulator_init(superlong_accumulator* acc) {
+  sllanes_init(&acc->lanes);
+  acc->pending = 0;
+}
+
+void superlong_accumulator_deinit(superlong_accumulator* acc) { sllanes_deinit(&acc->lanes); }
+
+// moves everything above 32 bits into the next lane; the top lane keeps the sign
+static void superlong_accumulator_propagate(superlong_accumulator* acc) {
+  int64_t carry = 0;
+  for (size_t i = 0; i < acc->lanes.len; i++) {
+    int64_t v = acc->lanes.arr[i] + carry;
+    acc->lanes.arr[i] = v & 0xFFFFFFFF;
+    carry = (v - acc->lanes.arr[i]) / ((int64_t) 1 << 32);
+  }
+  if (carry != 0)
+    sllanes_add_tail(&acc->lanes, carry);
+  acc->pending = 0;
+}
+
+static void superlong_accumulator_put(superlong_accumulator* acc, const superlong* num, int sign) {
+  if (superlong_is_zero(num))
+    return;
+  if (acc->pending == SUPERLONG_ACCUMULATOR_SPAN)
+    superlong_accumulator_propagate(acc);
+  size_t n = num->digits.len;
+  size_t words = (n + 3) / 4;
+  if (acc->lanes.len < words) {
+    sllanes_ensure_capacity(&acc->lanes, words);
+    memset(acc->lanes.arr + acc->lanes.len, 0, (words - acc->lanes.len) * sizeof(int64_t));
+    acc->lanes.len = words;
+  }
+  int64_t* lanes = acc->lanes.arr;
+  if (sign * num->sign > 0)
+    for (size_t w = 0; w < words; w++)
+      lanes[w] += digits_load_u32(num->digits.arr, n, 4 * w);
+  else
+    for (size_t w = 0; w < words; w++)
+      lanes[w] -= digits_load_u32(num->digits.arr, n, 4 * w);
+  acc->pending++;
+}
+
+void superlong_accumulator_add(superlong_accumulator* acc, const superlong* num) { superlong_accumulator_put(acc, num, 1); }
+
+void superlong_accumulator_sub(superlong_accumulator* acc, const superlong* num) { superlong_accumulator_put(acc, num, -1); }
+
+void superlong_accumulator_finish(superlong_accumulator* acc, superlong* res) {
+  superlong_accumulator_propagate(acc);
+  size_t n = acc->lanes.len;
+  int negative = n > 0 && acc->lanes.arr[n - 1] < 0;
+
+  // all lanes below the top are 32-bit words; the top one fits in two more
+  sldigits out;
+  sldigits_init(&out);
+  sldigits_ensure_capacity(&out, 4 * n + 8);
+  for (size_t i = 0; i < n; i++)
+    for (int b = 0; b < 8 && (b < 4 || i == n - 1); b++)
+      out.arr[4 * i + b] = (n256) ((uint64_t) acc->lanes.arr[i] >> (8 * b));
+  out.len = (n > 0) ? 4 * n + 4 : 0;
+  if (negative)
+    digits_neg(out.arr, out.len);
+  superlong_set_digits(res, out, negative ? -1 : 1);
+
+  acc->lanes.len = 0;
+  acc->pending = 0;
+}
+
+// copy-on-write sharing
+
+struct superlong_shared_rep {
+  atomic_size_t refs;
+  superlong value;
+};
+
+static const superlong superlong_shared_zero = {{NULL, 0, 0}, 0};
+
+static superlong_shared_rep* superlong_shared_rep_new(void) {
+  superlong_shared_rep* rep = nc_malloc(sizeof(*rep));
+  atomic_init(&rep->refs, 1);
+  superlong_init(&rep->value);
+  return rep;
+}
+
+static void superlong_shared_release(superlong_shared_rep* rep) {
+  if (rep && atomic_fetch_sub_explicit(&rep->refs, 1, memory_order_release) == 1) {
+    // the last owner must see every write made through the other handles
+    atomic_thread_fence(memory_order_acquire);
+    superlong_deinit(&rep->value);
+    nc_free(rep);
+  }
+}
+
+void superlong_shared_init(superlong_shared* sh) { sh->rep = NULL; }
+
+void superlong_shared_deinit(superlong_shared* sh) {
+  superlong_shared_release(sh->rep);
+  sh->rep = NULL;
+}
+
+void superlong_shared_set(superlong_shared* sh, superlong* num) {
+  superlong_shared_rep* rep = superlong_shared_rep_new();
+  superlong_deinit(&rep->value);
+  rep->value = *num;
+  superlong_init(num);
+  superlong_shared_release(sh->rep);
+  sh->rep = rep;
+}
+
+void superlong_shared_copy(const superlong_shared* src, superlong_shared* dst) {
+  superlong_shared_rep* rep = src->rep;
+  if (rep)
+    atomic_fetch_add_explicit(&rep->refs, 1, memory_order_relaxed);
+  superlong_shared_release(dst->rep);
+  dst->rep = rep;
+}
+
+const superlong* superlong_shared_get(const superlong_shared* sh) {
+  return sh->rep ? &sh->rep->value : &superlong_shared_zero;
+}
+
+int superlong_shared_is_shared(const superlong_shared* sh) {
+  return sh->rep && atomic_load_explicit(&sh->rep->refs, memory_order_acquire) > 1;
+}
+
+superlong* superlong_shared_mut(superlong_shared* sh) {
+  superlong_shared_rep* rep = sh->rep;
+  if (rep && atomic_load_explicit(&rep->refs, memory_order_acquire) == 1)
+    return &rep->value;
+  superlong_shared_rep* own = superlong_shared_rep_new();
+  if (rep) {
+    superlong_copy(&rep->value, &own->value);
+    superlong_shared_release(rep);
+  }
+  sh->rep = own;
+  return &own->value;
+}
+
+superlong* superlong_shared_res(superlong_shared* sh) {
+  superlong_shared_rep* rep = sh->rep;
+  if (rep && atomic_load_explicit(&rep->refs, memory_order_acquire) == 1)
+    return &rep->value;
+  // the caller overwrites the value, so a shared one is left to the other handles uncopied
+  superlong_shared_release(rep);
+  sh->rep = superlong_shared_rep_new();
+  return &sh->rep->value;
+}
+
+void superlong_shared_negate(superlong_shared* sh) {
+  if (!superlong_is_zero(superlong_shared_get(sh)))
+    superlong_negate(superlong_shared_mut(sh));
+}
+
+// left-to-right binary powering: squarings on the growing result, multiplications by the base only
+void superlong_pow_ui(const superlong* base, uint64_t exp, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_POW, base->digits.len);
+  superlong acc;
+  superlong_init(&acc);
+  superlong_from_uint(&acc, 1);
+  if (exp != 0) {
+    for (int bit = 63 - __builtin_clzll(exp); bit >= 0; bit--) {
+      superlong_mul(&acc, &acc, &acc);
+      if ((exp >> bit) & 1)
+        superlong_mul(&acc, base, &acc);
+    }
+  }
+  superlong_deinit(res);
+  *res = acc;
+}
+
+void superlong_factorial(uint32_t n, superlong* res) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_FACTORIAL, n);
+  if (n < 2) {
+    superlong_from_uint(res, 1);
+    return;
+  }
+  superlong_prod_source src = {NULL, NULL, 2};
+  superlong_prod_tree(&src, 0, n - 1, res, superlong_threads);
+}
+
+// fast doubling on the pair (F(k), F(k - 1)), two squarings per bit of n:
+//   F(2k + 1) = 4 F(k)^2 - F(k - 1)^2 + 2 (-1)^k, F(2k - 1) = F(k)^2 + F(k - 1)^2, F(2k) = F(2k + 1) - F(2k - 1)
+static void superlong_fib2(uint64_t n, superlong* fn, superlong* fn1) {
+  if (n == 0) {
+    superlong_from_uint(fn, 0);
+    superlong_from_uint(fn1, 1);
+    return;
+  }
+  superlong sq, sq1;
+  superlong_init(&sq);
+  superlong_init(&sq1);
+  superlong_from_uint(fn, 1);
+  superlong_from_uint(fn1, 0);
+  uint64_t k = 1;
+  for (int bit = 62 - __builtin_clzll(n); bit >= 0; bit--) {
+    superlong_mul(fn, fn, &sq);
+    superlong_mul(fn1, fn1, &sq1);
+    superlong_add(&sq, &sq1, fn1); // F(2k - 1)
+    superlong_mul_uint(&sq, 4, fn);
+    superlong_sub(fn, &sq1, fn);
+    if (k & 1)
+      superlong_sub_uint(fn, 2, fn);
+    else
+      superlong_add_uint(fn, 2, fn); // F(2k + 1)
+    if ((n >> bit) & 1) {
+      superlong_sub(fn, fn1, fn1); // F(2k)
+      k = 2 * k + 1;
+    } else {
+      superlong_sub(fn, fn1, fn); // F(2k)
+      k = 2 * k;
+    }
+  }
+  superlong_deinit(&sq);
+  superlong_deinit(&sq1);
+}
+
+void superlong_fib_ui(uint64_t n, superlong* res) {
+  superlong prev;
+  superlong_init(&prev);
+  superlong_fib2(n, res, &prev);
+  superlong_deinit(&prev);
+}
+
+// L(n) = F(n) + 2 F(n - 1)
+void superlong_lucas_ui(uint64_t n, superlong* res) {
+  superlong prev;
+  superlong_init(&prev);
+  superlong_fib2(n, res, &prev);
+  superlong_addmul_ui(&prev, 2, res);
+  superlong_deinit(&prev);
+}
+
+// the sieve up to n pays off while n is within this factor of k
+#define SUPERLONG_BIN_SIEVE_RATIO 16
+
+uint8_t* superlong_sieve(uint64_t limit) {
+  size_t bytes = (size_t) (limit / 16) + 1;
+  uint8_t* composite = nc_malloc(bytes);
+  memset(composite, 0, bytes);
+  for (uint64_t p = 3; p * p <= limit; p += 2) {
+    if (composite[p / 16] & (1u << ((p / 2) % 8)))
+      continue;
+    for (uint64_t m = p * p; m <= limit; m += 2 * p)
+      composite[m / 16] |= (uint8_t) (1u << ((m / 2) % 8));
+  }
+  return composite;
+}
+
+int superlong_sieve_is_prime(const uint8_t* composite, uint64_t p) {
+  return p == 2 || (p > 2 && (p & 1) && !(composite[p / 16] & (1u << ((p / 2) % 8))));
+}
+
+// Legendre's formula: the exponent of p in m! is the sum of floor(m / p^i)
+static uint64_t superlong_legendre(uint64_t m, uint64_t p) {
+  uint64_t e = 0;
+  for (uint64_t pp = p; pp <= m; pp *= p) {
+    e += m / pp;
+    if (pp > m / p)
+      break;
+  }
+  return e;
+}
+
+// C(n, k) from its prime factorization, multiplied by a balanced product tree. For k close to n
+// every prime p <= n gets the exponent e(n) - e(k) - e(n - k) and the prime powers are packed into
+// uint32 factors; for small k the prime factors of k! are cancelled out of n - k + 1, ..., n
+// instead, which only needs the primes up to k
+void superlong_bin_uiui(uint32_t n, uint32_t k, superlong* res) {
+  if (k > n) {
+    superlong_from_uint(res, 0);
+    return;
+  }
+  if (k > n - k)
+    k = n - k;
+  if (k == 0) {
+    superlong_from_uint(res, 1);
+    return;
+  }
+
+  uint32_t* factors;
+  size_t count = 0;
+  if (n / k <= SUPERLONG_BIN_SIEVE_RATIO) {
+    uint8_t* composite = superlong_sieve(n);
+    size_t cap = 64;
+    factors = nc_malloc(cap * sizeof(uint32_t));
+    uint32_t acc = 1;
+    for (uint64_t p = 2; p <= n; p++) {
+      if (!superlong_sieve_is_prime(composite, p))
+        continue;
+      uint64_t e = superlong_legendre(n, p) - superlong_legendre(k, p) - superlong_legendre(n - k, p);
+      for (; e > 0; e--) {
+        if ((uint64_t) acc * p > UINT32_MAX) {
+          if (count == cap) {
+            cap *= 2;
+            factors = nc_realloc(factors, cap * sizeof(uint32_t));
+          }
+          factors[count++] = acc;
+          acc = 1;
+        }
+        acc *= (uint32_t) p;
+      }
+    }
+    if (count == cap)
+      factors = nc_realloc(factors, (cap + 1) * sizeof(uint32_t));
+    factors[count++] = acc;
+    nc_free(composite);
+  } else {
+    uint8_t* composite = superlong_sieve(k);
+    uint32_t first = n - k + 1;
+    factors = nc_malloc(k * sizeof(uint32_t));
+    for (uint32_t i = 0; i < k; i++)
+      factors[i] = first + i;
+    for (uint64_t p = 2; p <= k; p++) {
+      if (!superlong_sieve_is_prime(composite, p))
+        continue;
+      // the run holds at least as many factors p as k! does
+      uint64_t e = superlong_legendre(k, p);
+      for (uint64_t i = (p - first % p) % p; i < k && e > 0; i += p) {
+        while (e > 0 && factors[i] % p == 0) {
+          factors[i] /= (uint32_t) p;
+          e--;
+        }
+      }
+    }
+    count = k;
+    nc_free(composite);
+  }
+  superlong_prod_array_uint(factors, count, res);
+  nc_free(factors);
+}
+
+// radix conversion
+
+static const char superlong_alphabet_36[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+static const char superlong_alphabet_62[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+static const char* superlong_alphabet(int base) { return (base <= 36) ? superlong_alphabet_36 : superlong_alphabet_62; }
+
+uint32_t superlong_radix_chunk(int base, unsigned* digits) {
+  uint32_t big = (uint32_t) base;
+  *digits = 1;
+  while (big <= UINT32_MAX / (uint32_t) base) {
+    big *= (uint32_t) base;
+    (*digits)++;
+  }
+  return big;
+}
+
+// writes the digits of value right-aligned into dst[0..width), zero padded; returns the unpadded length
+static unsigned superlong_render_chunk(char* dst, uint32_t value, unsigned width, int base, const char* alphabet) {
+  unsigned used = 0;
+  for (unsigned i = width; i-- > 0;) {
+    dst[i] = alphabet[value % (uint32_t) base];
+    value /= (uint32_t) base;
+    if (dst[i] != '0')
+      used = width - i;
+  }
+  return used;
+}
+
+#define SUPERLONG_OUT_BUFFER 4096
+
+typedef struct {
+  superlong_sink sink;
+  void* ctx;
+  size_t len;
+  int failed;
+  char buf[SUPERLONG_OUT_BUFFER];
+} superlong_out_buffer;
+
+static void superlong_out_flush(superlong_out_buffer* out) {
+  if (out->len > 0 && !out->failed && out->sink(out->ctx, out->buf, out->len) != 0)
+    out->failed = 1;
+  out->len = 0;
+}
+
+static void superlong_out_write(superlong_out_buffer* out, const char* data, size_t len) {
+  while (len > 0) {
+    if (out->len == SUPERLONG_OUT_BUFFER)
+      superlong_out_flush(out);
+    size_t part = SUPERLONG_OUT_BUFFER - out->len;
+    if (part > len)
+      part = len;
+    memcpy(out->buf + out->len, data, part);
+    out->len += part;
+    data += part;
+    len -= part;
+  }
+}
+
+// dst[0..count) = the base 2^width digits d-1, d-2, ... of ap[0..n), most significant first
+static void digits_render_pow2(char* dst, const n256* ap, size_t n, size_t d, size_t count, unsigned width, const char* alphabet) {
+  while (count > 0) {
+    size_t k = d - 1;
+    if (width == 4 && k % 2 == 1 && count >= 2) {
+      // whole bytes: two hex digits each
+      size_t bytes = count / 2;
+      for (const n256* p = ap + k / 2; bytes-- > 0; p--, dst += 2, d -= 2, count -= 2) {
+        dst[0] = alphabet[*p >> 4];
+        dst[1] = alphabet[*p & 15];
+      }
+      continue;
+    }
+    if (width == 1 && k % 8 == 7 && count >= 8) {
+      size_t bytes = count / 8;
+      for (const n256* p = ap + k / 8; bytes-- > 0; p--, d -= 8, count -= 8)
+        for (int b = 7; b >= 0; b--)
+          *dst++ = (char) ('0' + ((*p >> b) & 1));
+      continue;
+    }
+    size_t pos = k * width;
+    unsigned v = ap[pos / 8];
+    if (pos / 8 + 1 < n)
+      v |= (unsigned) ap[pos / 8 + 1] << 8;
+    *dst++ = alphabet[(v >> (pos % 8)) & ((1u << width) - 1)];
+    d--;
+    count--;
+  }
+}
+
+static size_t superlong_pow2_digits(const superlong* num, unsigned width) {
+  return (superlong_bit_length(num) + width - 1) / width;
+}
+
+// power-of-two bases read their digits straight off the bits, most significant first
+static void superlong_out_pow2(superlong_out_buffer* out, int base, const superlong* num) {
+  unsigned width = (unsigned) __builtin_ctz((unsigned) base);
+  size_t d = superlong_pow2_digits(num, width);
+  while (d > 0 && !out->failed) {
+    if (out->len == SUPERLONG_OUT_BUFFER)
+      superlong_out_flush(out);
+    size_t part = SUPERLONG_OUT_BUFFER - out->len;
+    if (part > d)
+      part = d;
+    digits_render_pow2(out->buf + out->len, num->digits.arr, num->digits.len, d, part, width, superlong_alphabet(base));
+    out->len += part;
+    d -= part;
+  }
+}
+
+// other bases split |num| recursively by the powers big^(2^k) of the chunk radix, emitting the
+// high half first. The magnitude is copied once into 32-bit words and every split divides in
+// place, the remainder staying in the low words and the quotient taking the high ones, so apart
+// from that copy and the powers only leaf blocks of 2^SUPERLONG_RADIX_LEAF_LEVEL chunks are
+// buffered. The largest power is kept near 1/16 of the number: above it the number is cut into
+// blocks of that size by repeated division, which costs as much as halving with schoolbook
+// division and keeps the powers small
+#define SUPERLONG_RADIX_LEAF_LEVEL 5
+#define SUPERLONG_RADIX_TOP_FRACTION 16
+// chunks hold at least 26 bits (base^digits > 2^32 / base), so (1 << LEVEL) words fit in these
+#define SUPERLONG_RADIX_LEAF_CHUNKS (((size_t) 32 << SUPERLONG_RADIX_LEAF_LEVEL) / 26 + 1)
+
+typedef struct {
+  superlong_out_buffer* out;
+  int base;
+  unsigned width;
+  uint32_t big;
+  const char* alphabet;
+  int cancelled;
+  unsigned top; // the level blocks are cut at
+  uint32_t* pow[64];
+  size_t pow_len[64];
+} superlong_radix;
+
+static size_t words_trim(const uint32_t* w, size_t len) {
+  while (len > 0 && w[len - 1] == 0)
+    len--;
+  return len;
+}
+
+static int words_less(const uint32_t* a, size_t n, const uint32_t* b, size_t m) {
+  if (n != m)
+    return n < m;
+  while (n-- > 0)
+    if (a[n] != b[n])
+      return a[n] < b[n];
+  return 0;
+}
+
+// a[0..n) /= d, returns the remainder
+static uint32_t words_divrem_1(uint32_t* a, size_t n, uint32_t d) {
+  uint64_t r = 0;
+  while (n-- > 0) {
+    uint64_t cur = (r << 32) | a[n];
+    a[n] = (uint32_t) (cur / d);
+    r = cur % d;
+  }
+  return (uint32_t) r;
+}
+
+// word i of a shifted left by s bits, taking the bits shifted in from a[i - 1]
+static uint32_t words_shifted(const uint32_t* a, size_t i, unsigned s) {
+  uint32_t w = a[i] << s;
+  if (s > 0 && i > 0)
+    w |= a[i - 1] >> (32 - s);
+  return w;
+}
+
+// quotient digits are estimated from the divisor normalized on the fly, so neither operand has
+// to be shifted
+void superlong_words_divrem(uint32_t* u, size_t n, const uint32_t* v, size_t m) {
+  unsigned s = (unsigned) __builtin_clz(v[m - 1]);
+  uint64_t v1 = words_shifted(v, m - 1, s);
+  uint64_t v2 = (m >= 2) ? words_shifted(v, m - 2, s) : 0;
+  for (size_t j = n - m + 1; j-- > 0;) {
+    // the partial remainder u[j..j + m] is below v 2^32, so shifting it by s loses nothing
+    uint32_t* p = u + j;
+    uint64_t top = ((uint64_t) words_shifted(p, m, s) << 32) | words_shifted(p, m - 1, s);
+    uint64_t u2 = (m >= 2) ? words_shifted(p, m - 2, s) : 0;
+    uint64_t qhat = top / v1;
+    uint64_t rhat = top % v1;
+    while ((qhat >> 32) != 0 || qhat * v2 > ((rhat << 32) | u2)) {
+      qhat--;
+      rhat += v1;
+      if ((rhat >> 32) != 0)
+        break;
+    }
+
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < m; i++) {
+      uint64_t prod = qhat * v[i] + carry;
+      carry = prod >> 32;
+      uint64_t t = (uint64_t) p[i] - (uint32_t) prod - borrow;
+      p[i] = (uint32_t) t;
+      borrow = t >> 63;
+    }
+    uint64_t t = (uint64_t) p[m] - carry - borrow;
+    if ((t >> 63) != 0) {
+      // qhat was one too large
+      qhat--;
+      carry = 0;
+      for (size_t i = 0; i < m; i++) {
+        uint64_t sum = (uint64_t) p[i] + v[i] + carry;
+        p[i] = (uint32_t) sum;
+        carry = sum >> 32;
+      }
+    }
+    p[m] = (uint32_t) qhat;
+  }
+}
+
+// res[0..n + m) = a[0..n) b[0..m)
+static void words_mul(uint32_t* res, const uint32_t* a, size_t n, const uint32_t* b, size_t m) {
+  memset(res, 0, (n + m) * sizeof(uint32_t));
+  for (size_t i = 0; i < n; i++) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < m; j++) {
+      uint64_t t = (uint64_t) a[i] * b[j] + res[i + j] + carry;
+      res[i + j] = (uint32_t) t;
+      carry = t >> 32;
+    }
+    res[i + m] = (uint32_t) carry;
+  }
+}
+
+static void superlong_radix_zeros(superlong_radix* rx, size_t count) {
+  static const char zeros[64] = "0000000000000000000000000000000000000000000000000000000000000000";
+  while (count > 0 && !rx->out->failed) {
+    size_t part = (count < sizeof(zeros)) ? count : sizeof(zeros);
+    superlong_out_write(rx->out, zeros, part);
+    count -= part;
+  }
+}
+
+// w[0..len) below big^(2^k), in chunks; padded writes all width 2^k digits
+static void superlong_radix_leaf(superlong_radix* rx, uint32_t* w, size_t len, unsigned k, int padded) {
+  uint32_t chunks[SUPERLONG_RADIX_LEAF_CHUNKS];
+  size_t count = 0;
+  len = words_trim(w, len);
+  while (len > 0) {
+    chunks[count++] = words_divrem_1(w, len, rx->big);
+    len = words_trim(w, len);
+  }
+  if (superlong_exec_poll(SUPERLONG_STAT_TO_STR, count)) {
+    rx->cancelled = 1;
+    return;
+  }
+
+  char text[32];
+  size_t i = count;
+  if (padded)
+    superlong_radix_zeros(rx, (((size_t) 1 << k) - count) * rx->width);
+  else {
+    unsigned used = superlong_render_chunk(text, chunks[--i], rx->width, rx->base, rx->alphabet);
+    superlong_out_write(rx->out, text + rx->width - used, used);
+  }
+  while (i-- > 0 && !rx->out->failed) {
+    superlong_render_chunk(text, chunks[i], rx->width, rx->base, rx->alphabet);
+    superlong_out_write(rx->out, text, rx->width);
+  }
+}
+
+// w[0..len) below big^(2^k), halved by big^(2^(k - 1)). w[len] and the words above it are free
+static void superlong_radix_split(superlong_radix* rx, uint32_t* w, size_t len, unsigned k, int padded) {
+  if (rx->cancelled || rx->out->failed)
+    return;
+  len = words_trim(w, len);
+  if (k <= SUPERLONG_RADIX_LEAF_LEVEL) {
+    superlong_radix_leaf(rx, w, len, k, padded);
+    return;
+  }
+  const uint32_t* p = rx->pow[k - 1];
+  size_t m = rx->pow_len[k - 1];
+  if (words_less(w, len, p, m)) {
+    // the high half is zero
+    if (padded)
+      superlong_radix_zeros(rx, rx->width << (k - 1));
+    superlong_radix_split(rx, w, len, k - 1, padded);
+    return;
+  }
+  w[len] = 0;
+  superlong_words_divrem(w, len, p, m);
+  superlong_radix_split(rx, w + m, len + 1 - m, k - 1, padded);
+  w[m] = 0;
+  superlong_radix_split(rx, w, m, k - 1, 1);
+}
+
+// the top of the number: blocks below big^(2^top) come off the low end by repeated division,
+// the highest is emitted first
+static void superlong_radix_blocks(superlong_radix* rx, uint32_t* w, size_t len) {
+  if (rx->cancelled || rx->out->failed)
+    return;
+  len = words_trim(w, len);
+  const uint32_t* p = rx->pow[rx->top];
+  size_t m = rx->pow_len[rx->top];
+  if (words_less(w, len, p, m)) {
+    superlong_radix_split(rx, w, len, rx->top, 0);
+    return;
+  }
+  w[len] = 0;
+  superlong_words_divrem(w, len, p, m);
+  superlong_radix_blocks(rx, w + m, len + 1 - m);
+  w[m] = 0;
+  superlong_radix_split(rx, w, m, rx->top, 1);
+}
+
+static void superlong_out_radix(superlong_out_buffer* out, int base, const superlong* num) {
+  superlong_radix rx;
+  rx.out = out;
+  rx.base = base;
+  rx.big = superlong_radix_chunk(base, &rx.width);
+  rx.alphabet = superlong_alphabet(base);
+  rx.cancelled = 0;
+
+  size_t n = num->digits.len;
+  while (n > 0 && num->digits.arr[n - 1] == 0)
+    n--;
+  size_t len = (n + 3) / 4;
+  if (len <= ((size_t) 1 << SUPERLONG_RADIX_LEAF_LEVEL)) {
+    uint32_t w[(size_t) 1 << SUPERLONG_RADIX_LEAF_LEVEL] = {0};
+    for (size_t i = 0; i < n; i++)
+      w[i / 4] |= (uint32_t) num->digits.arr[i] << (8 * (i % 4));
+    superlong_radix_leaf(&rx, w, len, SUPERLONG_RADIX_LEAF_LEVEL, 0);
+    return;
+  }
+
+  // powers up to the block level: at least the leaf level, otherwise within 1/16 of the number
+  rx.pow[0] = nc_malloc(sizeof(uint32_t));
+  rx.pow[0][0] = rx.big;
+  rx.pow_len[0] = 1;
+  unsigned k = 0;
+  while (k < SUPERLONG_RADIX_LEAF_LEVEL || 2 * rx.pow_len[k] <= len / SUPERLONG_RADIX_TOP_FRACTION) {
+    size_t m = rx.pow_len[k];
+    rx.pow[k + 1] = nc_malloc(2 * m * sizeof(uint32_t));
+    words_mul(rx.pow[k + 1], rx.pow[k], m, rx.pow[k], m);
+    rx.pow_len[k + 1] = words_trim(rx.pow[k + 1], 2 * m);
+    k++;
+  }
+  rx.top = k;
+
+  // every division along the top path needs one free word above the number
+  size_t slack = len / rx.pow_len[k] + k + 2;
+  uint32_t* w = nc_malloc((len + slack) * sizeof(uint32_t));
+  memset(w, 0, (len + slack) * sizeof(uint32_t));
+  for (size_t i = 0; i < n; i++)
+    w[i / 4] |= (uint32_t) num->digits.arr[i] << (8 * (i % 4));
+  superlong_radix_blocks(&rx, w, len);
+
+  nc_free(w);
+  for (unsigned i = 0; i <= k; i++)
+    nc_free(rx.pow[i]);
+}
+
+int superlong_out_sink(superlong_sink sink, void* ctx, int base, const superlong* num) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_OUT_STR, num->digits.len);
+  if (base < 2 || base > 62)
+    return -1;
+  superlong_out_buffer out;
+  out.sink = sink;
+  out.ctx = ctx;
+  out.len = 0;
+  out.failed = 0;
+
+  if (superlong_is_zero(num))
+    superlong_out_write(&out, "0", 1);
+  else {
+    if (num->sign < 0)
+      superlong_out_write(&out, "-", 1);
+    if ((base & (base - 1)) == 0)
+      superlong_out_pow2(&out, base, num);
+    else
+      superlong_out_radix(&out, base, num);
+  }
+  superlong_out_flush(&out);
+  return out.failed ? -1 : 0;
+}
+
+static int superlong_file_sink(void* ctx, const char* data, size_t len) {
+  return (fwrite(data, 1, len, (FILE*) ctx) == len) ? 0 : -1;
+}
+
+int superlong_out_str(FILE* file, int base, const superlong* num) {
+  return superlong_out_sink(superlong_file_sink, file, base, num);
+}
+
+typedef struct {
+  char* pos;
+} superlong_str_sink_ctx;
+
+static int superlong_str_sink(void* ctx, const char* data, size_t len) {
+  superlong_str_sink_ctx* str = ctx;
+  memcpy(str->pos, data, len);
+  str->pos += len;
+  return 0;
+}
+
+char* superlong_to_str(const superlong* num, int base) {
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_TO_STR, num->digits.len);
+  if (base < 2 || base > 62)
+    return NULL;
   if (superlong_is_zero(num)) {
     char* result = nc_malloc(2);
     result[0] = '0';
     result[1] = '\0';
+    nc_disown(result);
     return result;
   }
 
-  superlong temp;
-  superlong_init(&temp);
-  superlong_copy(num, &temp);
-  temp.sign = 1;
+  // the exact length is known before the string is allocated
+  const char* alphabet = superlong_alphabet(base);
+  size_t neg = (num->sign < 0) ? 1 : 0;
+  char* result;
+  if ((base & (base - 1)) == 0) {
+    unsigned width = (unsigned) __builtin_ctz((unsigned) base);
+    size_t count = superlong_pow2_digits(num, width);
+    result = nc_malloc(neg + count + 1);
+    digits_render_pow2(result + neg, num->digits.arr, num->digits.len, count, count, width, alphabet);
+    result[neg + count] = '\0';
+  } else {
+    // at most width digits per chunk of chunk_bits bits, trimmed once the digits are out
+    unsigned width;
+    uint32_t big = superlong_radix_chunk(base, &width);
+    size_t bound = (num->digits.len * 8 / (31u - (unsigned) __builtin_clz(big)) + 1) * width;
+    result = nc_malloc(neg + bound + 1);
+    superlong_out_buffer out;
+    superlong_str_sink_ctx ctx = {result + neg};
+    out.sink = superlong_str_sink;
+    out.ctx = &ctx;
+    out.len = 0;
+    out.failed = 0;
+    superlong_out_radix(&out, base, num);
+    superlong_out_flush(&out);
+    *ctx.pos = '\0';
+    result = nc_realloc(result, (size_t) (ctx.pos - result) + 1);
+  }
+  if (neg)
+    result[0] = '-';
+  nc_disown(result);
+  return result;
+}
 
-  size_t max_digits = temp.digits.len * 3 + 10;
-  char* digits = nc_malloc(max_digits);
+char* superlong_to_decimal_str(const superlong* num) { return superlong_to_str(num, 10); }
+
+// digit value + 1 in the base 62 alphabet, 0 for anything else
+static const n256 superlong_digit_table[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16, ['G'] = 17, ['H'] = 18, ['I'] = 19, ['J'] = 20,
+    ['K'] = 21, ['L'] = 22, ['M'] = 23, ['N'] = 24, ['O'] = 25, ['P'] = 26, ['Q'] = 27, ['R'] = 28, ['S'] = 29, ['T'] = 30,
+    ['U'] = 31, ['V'] = 32, ['W'] = 33, ['X'] = 34, ['Y'] = 35, ['Z'] = 36, ['a'] = 37, ['b'] = 38, ['c'] = 39, ['d'] = 40,
+    ['e'] = 41, ['f'] = 42, ['g'] = 43, ['h'] = 44, ['i'] = 45, ['j'] = 46, ['k'] = 47, ['l'] = 48, ['m'] = 49, ['n'] = 50,
+    ['o'] = 51, ['p'] = 52, ['q'] = 53, ['r'] = 54, ['s'] = 55, ['t'] = 56, ['u'] = 57, ['v'] = 58, ['w'] = 59, ['x'] = 60,
+    ['y'] = 61, ['z'] = 62,
+};
+
+// the digit value of c, or base or more when c is not a digit of base
+static unsigned superlong_digit_value(char c, int base) {
+  unsigned v = (unsigned) superlong_digit_table[(unsigned char) c] - 1;
+  // lowercase letters fold onto the uppercase ones up to base 36
+  return v - 26 * ((base <= 36) & (v >= 36) & (v < 62));
+}
 
-  size_t digit_count = 0;
-  while (!superlong_is_zero(&temp)) {
-    n256plus rem = superlong_div_uint10(&temp);
-    digits[digit_count++] = '0' + (char) rem;
+// rp[0..n) = rp[0..n) * k + c, returns the carry out
+static uint64_t digits_mul_1_add(n256* rp, size_t n, uint32_t k, uint64_t c) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t t = (uint64_t) rp[i] * k + c;
+    rp[i] = (n256) t;
+    c = t >> 8;
   }
+  return c;
+}
 
-  size_t result_len = digit_count + (num->sign < 0 ? 1 : 0) + 1;
-  char* result = nc_malloc(result_len);
-  size_t pos = 0;
+int superlong_from_str(superlong* res, const char* str, int base) {
+  if (base < 2 || base > 62)
+    return -1;
+  int sign = 1;
+  if (*str == '-' || *str == '+')
+    sign = (*str++ == '-') ? -1 : 1;
+  size_t count = strlen(str);
+  SUPERLONG_STAT_SCOPE(SUPERLONG_STAT_FROM_STR, count);
+  if (count == 0)
+    return -1;
+  // branch-free validation: random digits would defeat the predictor
+  unsigned bad = 0;
+  for (size_t i = 0; i < count; i++)
+    bad |= superlong_digit_value(str[i], base) >= (unsigned) base;
+  if (bad)
+    return -1;
 
-  if (num->sign < 0)
-    result[pos++] = '-';
+  superlong_clean(res);
+  sldigits* digits = SLDIGITS_ARR_PTR(res);
+  if ((base & (base - 1)) == 0) {
+    // power-of-two bases: each digit lands on its own bits, least significant first
+    unsigned width = (unsigned) __builtin_ctz((unsigned) base);
+    size_t len = (count * width + 7) / 8;
+    sldigits_ensure_capacity(digits, len);
+    memset(digits->arr, 0, len);
+    const char* end = str + count;
+    size_t i = 0;
+    if (width == 4)
+      for (; i + 2 <= count; i += 2, end -= 2)
+        digits->arr[i / 2] = (n256) (superlong_digit_value(end[-2], base) << 4 | superlong_digit_value(end[-1], base));
+    for (; i < count; i++) {
+      size_t pos = i * width;
+      unsigned v = superlong_digit_value(*--end, base) << (pos % 8);
+      digits->arr[pos / 8] |= (n256) v;
+      if (v >> 8)
+        digits->arr[pos / 8 + 1] |= (n256) (v >> 8);
+    }
+    digits->len = len;
+  } else {
+    // a chunk of up to width digits at a time: res = res * base^k + chunk
+    unsigned width;
+    superlong_radix_chunk(base, &width);
+    sldigits_ensure_capacity(digits, (count * (32 - (size_t) __builtin_clz((unsigned) base)) + 7) / 8 + 4);
+    size_t len = 0;
+    size_t i = 0;
+    while (i < count) {
+      size_t k = (i == 0 && count % width != 0) ? count % width : width;
+      uint32_t scale = 1, chunk = 0;
+      for (size_t j = 0; j < k; j++, i++) {
+        scale *= (uint32_t) base;
+        chunk = chunk * (uint32_t) base + superlong_digit_value(str[i], base);
+      }
+      for (uint64_t c = digits_mul_1_add(digits->arr, len, scale, chunk); c != 0; c >>= 8)
+        digits->arr[len++] = (n256) c;
+    }
+    digits->len = len;
+  }
+  if (digits->len == 0)
+    sldigits_add_tail(digits, 0);
+  res->sign = sign;
+  superlong_normalize(res);
+  return 0;
+}
+
+// cancellable variants
 
-  for (size_t i = digit_count; i > 0; i--)
-    result[pos++] = digits[i - 1];
+// digit products superlong_mul_abs is expected to do in the basecase, the unit of mul progress
+static uint64_t superlong_mul_cost(size_t la, size_t lb) {
+  if (la < lb) {
+    size_t t = la;
+    la = lb;
+    lb = t;
+  }
+  if (lb < SUPERLONG_KARATSUBA_THRESHOLD)
+    return (uint64_t) la * lb;
+  if (la >= 2 * lb)
+    return (la / lb) * superlong_mul_cost(lb, lb) + superlong_mul_cost(la % lb, lb);
+  size_t k = lb / 2;
+  return 2 * superlong_mul_cost(la - k, lb - k) + superlong_mul_cost(k, k);
+}
 
-  result[pos] = '\0';
+int superlong_factorial_ex(superlong_exec* exec, uint32_t n, superlong* res) {
+  superlong out;
+  superlong_init(&out);
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_FACTORIAL, (n < 2) ? 0 : n - 1);
+  if (!superlong_exec_cancelled(exec))
+    superlong_factorial(n, &out);
+  return superlong_exec_end(exec, saved, &out, res);
+}
 
-  free(digits);
-  superlong_deinit(&temp);
-  return result;
+int superlong_mul_ex(superlong_exec* exec, const superlong* a, const superlong* b, superlong* res) {
+  superlong out;
+  superlong_init(&out);
+  uint64_t total = (a->sign == 0 || b->sign == 0) ? 0 : superlong_mul_cost(a->digits.len, b->digits.len);
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_MUL, total);
+  if (!superlong_exec_cancelled(exec))
+    superlong_mul(a, b, &out);
+  return superlong_exec_end(exec, saved, &out, res);
+}
+
+int superlong_div_ex(superlong_exec* exec, const superlong* a, const superlong* b, superlong* res) {
+  superlong out;
+  superlong_init(&out);
+  // one unit per quotient digit of the long division
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_DIV, a->digits.len);
+  if (!superlong_exec_cancelled(exec))
+    superlong_div(a, b, &out);
+  return superlong_exec_end(exec, saved, &out, res);
+}
+
+char* superlong_to_str_ex(superlong_exec* exec, const superlong* num, int base) {
+  // one unit per chunk of digits split off by repeated division
+  uint64_t total = 0;
+  if (base >= 2 && base <= 62 && (base & (base - 1)) != 0 && !superlong_is_zero(num)) {
+    unsigned width;
+    uint32_t big = superlong_radix_chunk(base, &width);
+    total = num->digits.len * 8 / (31u - (unsigned) __builtin_clz(big)) + 1;
+  }
+  superlong_exec* saved = superlong_exec_begin(exec, SUPERLONG_STAT_TO_STR, total);
+  char* str = superlong_exec_cancelled(exec) ? NULL : superlong_to_str(num, base);
+  if (superlong_exec_finish(exec, saved) != 0) {
+    free(str);
+    return NULL;
+  }
+  return str;
+}
+
+void superlong_factorial_iter_init(superlong_factorial_iter* it, uint32_t n) {
+  superlong_init(&it->acc);
+  superlong_from_uint(&it->acc, 1);
+  it->next = 2;
+  it->n = n;
+}
+
+void superlong_factorial_iter_deinit(superlong_factorial_iter* it) { superlong_deinit(&it->acc); }
+
+int superlong_factorial_iter_step(superlong_factorial_iter* it, uint32_t count) {
+  if (it->next > it->n || it->next == 0)
+    return 1;
+  uint32_t left = it->n - it->next + 1;
+  if (count > left)
+    count = left;
+  if (count > 0) {
+    // the slice is a balanced product of its own, then one multiplication into acc
+    superlong slice;
+    superlong_init(&slice);
+    superlong_prod_range(it->next, count, &slice);
+    superlong_mul(&it->acc, &slice, &it->acc);
+    superlong_deinit(&slice);
+    it->next += count;
+  }
+  return it->next > it->n || it->next == 0;
 }
@@ -5,6 +5,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef uint8_t n256;
 
 DECLARE_DYN_ARR(n256, sldigits, 16)
@@ -14,6 +18,62 @@ typedef struct {
   int sign;
 } superlong;
 
+// non-owning read-only number over caller memory or a mapped file (little-endian base-256 digits)
+typedef struct {
+  const n256* digits;
+  size_t len;
+  int sign;
+  void* map;
+  size_t map_len;
+} superlong_view;
+
+DECLARE_DYN_ARR(int64_t, sllanes, 16)
+
+// running sum in carry-save form: lane i holds a signed multiple of 2^(32 i), carries wait for finish
+typedef struct {
+  sllanes lanes;
+  size_t pending;
+} superlong_accumulator;
+
+// reference-counted handle to an immutable value: copies share the digits, and
+// superlong_shared_mut duplicates them only while another handle still refers to them.
+// A handle must not be used from two threads at once; distinct handles to one value may.
+typedef struct superlong_shared_rep superlong_shared_rep;
+
+typedef struct {
+  superlong_shared_rep* rep;
+} superlong_shared;
+
+// receives the work done so far and the expected total, in units of the running operation;
+// may be called from worker threads. A nonzero return cancels the operation
+typedef int (*superlong_progress)(void* ctx, uint64_t done, uint64_t total);
+
+// execution context for the _ex variants; op, done, total and reported belong to the library
+typedef struct {
+  superlong_progress progress;
+  void* ctx;
+  int cancelled;
+  int op;
+  uint64_t done;
+  uint64_t total;
+  uint64_t reported;
+} superlong_exec;
+
+// n! built a slice of factors per step: acc holds (next - 1)! until next passes n
+typedef struct {
+  superlong acc;
+  uint32_t next;
+  uint32_t n;
+} superlong_factorial_iter;
+
+// precomputed reciprocal of a 32-bit divisor for repeated division
+typedef struct {
+  uint32_t d;
+  uint32_t norm;
+  uint32_t inv;
+  unsigned shift;
+} superlong_preinv;
+
 // initialization
 void superlong_init(superlong*);
 void superlong_deinit(superlong*);
@@ -21,28 +81,165 @@ superlong* new_superlong();
 void delete_superlong(superlong*);
 void superlong_from_int(superlong*, int16_t n);
 void superlong_from_uint(superlong*, uint32_t n);
+void superlong_from_int64(superlong*, int64_t n);
+void superlong_from_uint64(superlong*, uint64_t n);
 
 // operations
 void superlong_add(const superlong*, const superlong*, superlong* res);
 void superlong_add_uint(const superlong*, uint32_t, superlong* res);
+void superlong_add_ui64(const superlong*, uint64_t, superlong* res);
 
 void superlong_sub(const superlong*, const superlong*, superlong* res);
 void superlong_sub_uint(const superlong*, uint32_t, superlong* res);
+void superlong_sub_ui64(const superlong*, uint64_t, superlong* res);
 
 void superlong_mul(const superlong*, const superlong*, superlong* res);
 void superlong_mul_uint(const superlong*, uint32_t, superlong* res);
+void superlong_mul_ui64(const superlong*, uint64_t, superlong* res);
+
+// res += a * b, res -= a * b
+void superlong_addmul(const superlong*, const superlong*, superlong* res);
+void superlong_submul(const superlong*, const superlong*, superlong* res);
+void superlong_addmul_ui(const superlong*, uint32_t, superlong* res);
+void superlong_submul_ui(const superlong*, uint32_t, superlong* res);
 
 void superlong_div(const superlong*, const superlong*, superlong* res);
 void superlong_div_uint(const superlong*, uint32_t, superlong* res);
+void superlong_div_ui64(const superlong*, uint64_t, superlong* res);
+
+// division by 32-bit constants; remainders are those of the magnitude
+void superlong_preinv_init(superlong_preinv*, uint32_t d);
+uint32_t superlong_divrem_preinv(const superlong*, const superlong_preinv*, superlong* res);
+uint32_t superlong_mod_preinv(const superlong*, const superlong_preinv*);
+uint32_t superlong_mod_ui(const superlong*, uint32_t);
+
+// the divisor must divide the dividend exactly
+void superlong_divexact_uint(const superlong*, uint32_t, superlong* res);
+void superlong_divexact_by3(const superlong*, superlong* res);
+
+// bit operations (two's complement semantics for negative numbers)
+void superlong_shl(superlong*, size_t bits);
+void superlong_shr(superlong*, size_t bits);
+
+void superlong_and(const superlong*, const superlong*, superlong* res);
+void superlong_or(const superlong*, const superlong*, superlong* res);
+void superlong_xor(const superlong*, const superlong*, superlong* res);
+void superlong_not(const superlong*, superlong* res);
+
+size_t superlong_popcount(const superlong*);
+size_t superlong_bit_length(const superlong*);
+size_t superlong_trailing_zeros(const superlong*);
+
+int superlong_test_bit(const superlong*, size_t bit);
+void superlong_set_bit(superlong*, size_t bit);
+void superlong_clear_bit(superlong*, size_t bit);
 
 // other operations
 void superlong_copy(const superlong*, superlong* res);
 
 void superlong_negate(superlong*);
 int superlong_is_zero(const superlong*);
+int superlong_compare(const superlong*, const superlong*);
+int64_t superlong_get_int64(const superlong*);
+int superlong_fits_int64(const superlong*);
+
+// receives the next piece of output; a nonzero return aborts the conversion
+typedef int (*superlong_sink)(void* ctx, const char* data, size_t len);
+
+// stream num in base 2..62, most significant digit first, through a bounded buffer; 0 or -1
+int superlong_out_sink(superlong_sink sink, void* ctx, int base, const superlong* num);
+int superlong_out_str(FILE* file, int base, const superlong* num);
 
 char* superlong_to_decimal_str(const superlong*);
 
+// base 2..62: digits past 9 are a-z up to base 36 (either case when parsing), then A-Z and a-z;
+// to_str returns NULL and from_str -1 for an invalid base or digit
+char* superlong_to_str(const superlong* num, int base);
+int superlong_from_str(superlong* res, const char* str, int base);
+
+// raw words of the magnitude like GMP's mpz_export/mpz_import: order 1/-1 puts the most/least
+// significant word first, endian 1/-1/0 selects big/little/native byte order inside a word
+void* superlong_export(void* out, size_t* countp, int order, size_t size, int endian, const superlong*);
+void superlong_import(superlong* res, size_t count, int order, size_t size, int endian, const void* data);
+
+// self-describing binary format (header with sign, length and checksum followed by the raw digits);
+// return 0 on success and -1 on I/O or format errors
+#define SUPERLONG_FILE_HEADER_SIZE 24
+
+uint64_t superlong_checksum(const void* data, size_t len);
+int superlong_fwrite(FILE*, const superlong*);
+int superlong_fread(FILE*, superlong* res);
+int superlong_write_fd(int fd, const superlong*);
+int superlong_read_fd(int fd, superlong* res);
+
+// zero-copy views; superlong_view_borrow gives a read-only superlong usable as any const input
+// parameter, it must never be written to or deinit'ed
+superlong_view superlong_view_of(const superlong*);
+superlong_view superlong_view_from_buffer(const void* digits, size_t len, int sign);
+int superlong_view_map_file(const char* path, int verify_checksum, superlong_view* view);
+void superlong_view_unmap(superlong_view*);
+superlong superlong_view_borrow(superlong_view);
+
+void superlong_add_view(superlong_view, superlong_view, superlong* res);
+void superlong_sub_view(superlong_view, superlong_view, superlong* res);
+void superlong_mul_view(superlong_view, superlong_view, superlong* res);
+void superlong_div_view(superlong_view, superlong_view, superlong* res);
+int superlong_compare_view(superlong_view, superlong_view);
+char* superlong_to_decimal_str_view(superlong_view);
+
+// finish stores the sum and resets the accumulator to zero
+void superlong_accumulator_init(superlong_accumulator*);
+void superlong_accumulator_deinit(superlong_accumulator*);
+void superlong_accumulator_add(superlong_accumulator*, const superlong*);
+void superlong_accumulator_sub(superlong_accumulator*, const superlong*);
+void superlong_accumulator_finish(superlong_accumulator*, superlong* res);
+
+// set moves num into the handle and leaves it zero; the pointer from get stays valid
+// until the handle is written to; mut returns a value owned by this handle alone, res one
+// to be overwritten as a result, which skips copying a shared value it is about to replace
+void superlong_shared_init(superlong_shared*);
+void superlong_shared_deinit(superlong_shared*);
+void superlong_shared_set(superlong_shared*, superlong* num);
+void superlong_shared_copy(const superlong_shared* src, superlong_shared* dst);
+const superlong* superlong_shared_get(const superlong_shared*);
+superlong* superlong_shared_mut(superlong_shared*);
+superlong* superlong_shared_res(superlong_shared*);
+int superlong_shared_is_shared(const superlong_shared*);
+void superlong_shared_negate(superlong_shared*);
+
 void superlong_factorial(uint32_t, superlong* res);
+void superlong_pow_ui(const superlong* base, uint64_t exp, superlong* res);
+
+// Fibonacci and Lucas numbers by fast doubling, binomial coefficients from their prime factorization
+void superlong_fib_ui(uint64_t n, superlong* res);
+void superlong_lucas_ui(uint64_t n, superlong* res);
+void superlong_bin_uiui(uint32_t n, uint32_t k, superlong* res);
+
+// cancellable operations: the flag is checked at loop and recursion boundaries and stays set
+// until superlong_exec_init; a cancelled call returns -1 (NULL) and leaves res unchanged
+void superlong_exec_init(superlong_exec*, superlong_progress progress, void* ctx);
+void superlong_exec_cancel(superlong_exec*);
+int superlong_exec_cancelled(const superlong_exec*);
+
+int superlong_factorial_ex(superlong_exec*, uint32_t, superlong* res);
+int superlong_mul_ex(superlong_exec*, const superlong*, const superlong*, superlong* res);
+int superlong_div_ex(superlong_exec*, const superlong*, const superlong*, superlong* res);
+char* superlong_to_str_ex(superlong_exec*, const superlong* num, int base);
+
+// step multiplies in up to count more factors and returns 1 once acc holds n!
+void superlong_factorial_iter_init(superlong_factorial_iter*, uint32_t n);
+void superlong_factorial_iter_deinit(superlong_factorial_iter*);
+int superlong_factorial_iter_step(superlong_factorial_iter*, uint32_t count);
+
+// balanced product trees; subtrees run on up to superlong_get_threads() threads
+void superlong_prod_array(const superlong* const*, size_t n, superlong* res);
+void superlong_prod_array_uint(const uint32_t*, size_t n, superlong* res);
+
+void superlong_set_threads(unsigned threads);
+unsigned superlong_get_threads(void);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,265 @@
+#ifndef SUPERLONG_HPP
+#define SUPERLONG_HPP
+
+#include "superlong.h"
+
+#include <cstdlib>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+class SuperLong;
+
+namespace superlong_expr {
+
+// a * b, evaluated straight into its destination
+struct Mul {
+  const SuperLong& a;
+  const SuperLong& b;
+};
+
+// c + sign * a * b, evaluated with one fused addmul/submul
+struct AddMul {
+  const SuperLong& a;
+  const SuperLong& b;
+  const SuperLong& c;
+  int sign;
+};
+
+} // namespace superlong_expr
+
+// RAII value wrapper over superlong; moves steal the digit buffer
+class SuperLong {
+public:
+  SuperLong() { superlong_init(&num); }
+
+  template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+  SuperLong(T n) {
+    superlong_init(&num);
+    if (std::is_signed<T>::value)
+      superlong_from_int64(&num, (int64_t) n);
+    else
+      superlong_from_uint64(&num, (uint64_t) n);
+  }
+
+  explicit SuperLong(const superlong& raw) {
+    superlong_init(&num);
+    superlong_copy(&raw, &num);
+  }
+
+  SuperLong(const SuperLong& other) {
+    superlong_init(&num);
+    superlong_copy(&other.num, &num);
+  }
+
+  SuperLong(SuperLong&& other) noexcept : num(other.num) { other.release(); }
+
+  SuperLong(const superlong_expr::Mul& e) {
+    superlong_init(&num);
+    superlong_mul(&e.a.num, &e.b.num, &num);
+  }
+
+  SuperLong(const superlong_expr::AddMul& e) {
+    superlong_init(&num);
+    assign(e);
+  }
+
+  ~SuperLong() { superlong_deinit(&num); }
+
+  SuperLong& operator=(const SuperLong& other) {
+    superlong_copy(&other.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator=(SuperLong&& other) noexcept {
+    std::swap(num, other.num);
+    return *this;
+  }
+
+  SuperLong& operator=(const superlong_expr::Mul& e) {
+    superlong_mul(&e.a.num, &e.b.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator=(const superlong_expr::AddMul& e) {
+    assign(e);
+    return *this;
+  }
+
+  SuperLong& operator+=(const SuperLong& other) {
+    superlong_add(&num, &other.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator-=(const SuperLong& other) {
+    superlong_sub(&num, &other.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator*=(const SuperLong& other) {
+    superlong_mul(&num, &other.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator/=(const SuperLong& other) {
+    superlong_div(&num, &other.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator+=(const superlong_expr::Mul& e) {
+    superlong_addmul(&e.a.num, &e.b.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator-=(const superlong_expr::Mul& e) {
+    superlong_submul(&e.a.num, &e.b.num, &num);
+    return *this;
+  }
+
+  SuperLong& operator<<=(size_t bits) {
+    superlong_shl(&num, bits);
+    return *this;
+  }
+
+  SuperLong& operator>>=(size_t bits) {
+    superlong_shr(&num, bits);
+    return *this;
+  }
+
+  SuperLong operator-() const {
+    SuperLong r(*this);
+    superlong_negate(&r.num);
+    return r;
+  }
+
+  SuperLong operator~() const {
+    SuperLong r;
+    superlong_not(&num, &r.num);
+    return r;
+  }
+
+  int sign() const { return superlong_is_zero(&num) ? 0 : num.sign; }
+  int compare(const SuperLong& other) const { return superlong_compare(&num, &other.num); }
+
+  std::string str() const {
+    char* s = superlong_to_decimal_str(&num);
+    std::string r(s);
+    free(s);
+    return r;
+  }
+
+  superlong* get() { return &num; }
+  const superlong* get() const { return &num; }
+
+private:
+  superlong num;
+
+  // leaves an empty zero behind; the digit array regrows on the next write
+  void release() {
+    num.digits.arr = nullptr;
+    num.digits.len = 0;
+    num.digits.cap = 0;
+    num.sign = 0;
+  }
+
+  void assign(const superlong_expr::AddMul& e) {
+    if (&e.c != this) {
+      if (&e.a == this || &e.b == this) {
+        SuperLong t(e.c);
+        t.accumulate(e);
+        std::swap(num, t.num);
+        return;
+      }
+      superlong_copy(&e.c.num, &num);
+    }
+    accumulate(e);
+  }
+
+  void accumulate(const superlong_expr::AddMul& e) {
+    if (e.sign > 0)
+      superlong_addmul(&e.a.num, &e.b.num, &num);
+    else
+      superlong_submul(&e.a.num, &e.b.num, &num);
+  }
+};
+
+inline superlong_expr::Mul operator*(const SuperLong& a, const SuperLong& b) { return {a, b}; }
+
+inline superlong_expr::AddMul operator+(const superlong_expr::Mul& m, const SuperLong& c) { return {m.a, m.b, c, 1}; }
+inline superlong_expr::AddMul operator+(const SuperLong& c, const superlong_expr::Mul& m) { return {m.a, m.b, c, 1}; }
+inline superlong_expr::AddMul operator-(const SuperLong& c, const superlong_expr::Mul& m) { return {m.a, m.b, c, -1}; }
+
+inline SuperLong operator+(const superlong_expr::Mul& x, const superlong_expr::Mul& y) {
+  SuperLong r(x);
+  r += y;
+  return r;
+}
+
+inline SuperLong operator+(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_add(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator-(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_sub(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator/(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_div(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator&(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_and(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator|(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_or(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator^(const SuperLong& a, const SuperLong& b) {
+  SuperLong r;
+  superlong_xor(a.get(), b.get(), r.get());
+  return r;
+}
+
+inline SuperLong operator<<(SuperLong a, size_t bits) { return std::move(a <<= bits); }
+inline SuperLong operator>>(SuperLong a, size_t bits) { return std::move(a >>= bits); }
+
+inline bool operator==(const SuperLong& a, const SuperLong& b) { return a.compare(b) == 0; }
+inline bool operator!=(const SuperLong& a, const SuperLong& b) { return a.compare(b) != 0; }
+inline bool operator<(const SuperLong& a, const SuperLong& b) { return a.compare(b) < 0; }
+inline bool operator<=(const SuperLong& a, const SuperLong& b) { return a.compare(b) <= 0; }
+inline bool operator>(const SuperLong& a, const SuperLong& b) { return a.compare(b) > 0; }
+inline bool operator>=(const SuperLong& a, const SuperLong& b) { return a.compare(b) >= 0; }
+
+inline std::ostream& operator<<(std::ostream& out, const SuperLong& a) { return out << a.str(); }
+
+namespace std {
+template <> struct hash<SuperLong> {
+  size_t operator()(const SuperLong& a) const noexcept {
+    // FNV-1a over the normalized digits and the sign
+    const superlong* num = a.get();
+    uint64_t h = 1469598103934665603ULL ^ (uint64_t) (a.sign() + 1);
+    if (a.sign() != 0) {
+      for (size_t i = 0; i < num->digits.len; i++) {
+        h ^= num->digits.arr[i];
+        h *= 1099511628211ULL;
+      }
+    }
+    return (size_t) h;
+  }
+};
+} // namespace std
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Test suite for the C++ wrapper header (superlong.hpp)
+ * Compiled with -O0 and all sanitizers like the C test suite
+ */
+
+#include "superlong.hpp"
+
+#include <cstdio>
+#include <unordered_set>
+#include <utility>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define COLOR_GREEN "\033[0;32m"
+#define COLOR_RED "\033[0;31m"
+#define COLOR_YELLOW "\033[0;33m"
+#define COLOR_RESET "\033[0m"
+
+#define TEST_ASSERT(condition, test_name) do { \
+    if (condition) { \
+        printf(COLOR_GREEN "✓ PASS" COLOR_RESET " - %s\n", test_name); \
+        tests_passed++; \
+    } else { \
+        printf(COLOR_RED "✗ FAIL" COLOR_RESET " - %s\n", test_name); \
+        tests_failed++; \
+    } \
+} while(0)
+
+void test_value_semantics() {
+    printf(COLOR_YELLOW "\n=== Testing Value Semantics ===" COLOR_RESET "\n");
+    
+    SuperLong a = 12345;
+    SuperLong b = a;
+    TEST_ASSERT(b.str() == "12345", "Copy construction");
+    
+    const n256* buffer = a.get()->digits.arr;
+    SuperLong c = std::move(a);
+    TEST_ASSERT(c.get()->digits.arr == buffer && c.str() == "12345", "Move construction steals the buffer");
+    TEST_ASSERT(a.sign() == 0 && a.str() == "0", "Moved-from value is zero");
+    a = 7;
+    TEST_ASSERT(a.str() == "7", "Moved-from value can be reassigned");
+    
+    SuperLong d = -5;
+    TEST_ASSERT(d < a && a > d && d != a && SuperLong(7) == a, "Comparisons");
+    TEST_ASSERT(std::hash<SuperLong>()(SuperLong(42)) == std::hash<SuperLong>()(SuperLong(40) + SuperLong(2)),
+                "Equal values hash equally");
+    std::unordered_set<SuperLong> set = {SuperLong(1), SuperLong(2), SuperLong(1)};
+    TEST_ASSERT(set.size() == 2, "SuperLong as unordered_set key");
+}
+
+void test_expressions() {
+    printf(COLOR_YELLOW "\n=== Testing Expressions ===" COLOR_RESET "\n");
+    
+    SuperLong a = 1000, b = 2000, c = 5;
+    SuperLong r = a * b + c;
+    TEST_ASSERT(r.str() == "2000005", "a * b + c");
+    r = c - a * b;
+    TEST_ASSERT(r.str() == "-1999995", "c - a * b");
+    
+    SuperLong x = 3, y = 7;
+    x = x * y;
+    TEST_ASSERT(x.str() == "21", "x = x * y");
+    x += a * b;
+    TEST_ASSERT(x.str() == "2000021", "x += a * b");
+    x -= x * y;
+    TEST_ASSERT(x.str() == "-12000126", "x -= x * y");
+    x = a * x + x;
+    TEST_ASSERT(x.str() == "-12012126126", "x = a * x + x");
+    
+    SuperLong big = SuperLong(1) << 200;
+    TEST_ASSERT(((big >> 199) == SuperLong(2)) && ((big - SuperLong(1)) & big) == SuperLong(0), "Shifts and bit operations");
+    TEST_ASSERT((big / (SuperLong(1) << 100)) == (SuperLong(1) << 100), "Division");
+}
+
+int main() {
+    test_value_semantics();
+    test_expressions();
+    
+    printf("\nC++ wrapper: %d passed, %d failed\n", tests_passed, tests_failed);
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -5,10 +5,22 @@
  */
 
 #include "superlong.h"
+#include "superlong-batch.h"
+#include "superlong-checkpoint.h"
+#include "superlong-ooc.h"
+#include "superlong-series.h"
+#include "superlong-mod.h"
+#include "superlong-rns.h"
+#include "superlong-fixed.h"
+#include "superlong-stats.h"
+#include "safe-alloc.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
 
 // Test counter
 static int tests_passed = 0;
@@ -287,6 +299,22 @@ void test_division() {
     superlong_div(&a, &b, &result);
     TEST_ASSERT(compare_with_string(&result, "-10"), "-100 / 10 = -10");
     
+    superlong_from_int(&b, -10);
+    superlong_div(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "10"), "-100 / -10 = 10");
+    
+    // Multi-digit divisor: the remainder carries between quotient digits
+    superlong_from_str(&a, "1000000000000000000000000000000", 10);
+    superlong_from_str(&b, "12345678901", 10);
+    superlong_div(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "81000000730539006588"), "10^30 / 12345678901");
+    
+    // Quotient digits of 255
+    superlong_from_str(&a, "ffffffffffffffffffffffff", 16);
+    superlong_from_str(&b, "1000000001", 16);
+    superlong_div(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "1152921504590069760"), "Quotient with 0xff digits");
+    
     superlong_deinit(&a);
     superlong_deinit(&b);
     superlong_deinit(&result);
@@ -318,6 +346,15 @@ void test_utilities() {
     superlong_negate(&a);
     TEST_ASSERT(compare_with_string(&a, "0"), "Negate zero remains zero");
     
+    // Compare
+    superlong_from_int(&a, -5);
+    superlong_from_uint(&b, 3);
+    TEST_ASSERT(superlong_compare(&a, &b) < 0 && superlong_compare(&b, &a) > 0, "Compare -5 < 3");
+    superlong_from_int(&b, -7);
+    TEST_ASSERT(superlong_compare(&a, &b) > 0, "Compare -5 > -7");
+    superlong_copy(&a, &b);
+    TEST_ASSERT(superlong_compare(&a, &b) == 0, "Compare equal values");
+    
     superlong_deinit(&a);
     superlong_deinit(&b);
 }
@@ -460,6 +497,1555 @@ void test_string_conversion() {
     superlong_deinit(&num);
 }
 
+// Test bit-level shifts and bitwise operations
+void test_bit_operations() {
+    printf(COLOR_YELLOW "\n=== Testing Bit Operations ===" COLOR_RESET "\n");
+    
+    superlong a, b, result;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&result);
+    
+    // Shifts
+    superlong_from_uint(&a, 12345);
+    superlong_shl(&a, 77);
+    superlong_shr(&a, 77);
+    TEST_ASSERT(compare_with_string(&a, "12345"), "(12345 << 77) >> 77 = 12345");
+    
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 64);
+    TEST_ASSERT(compare_with_string(&a, "18446744073709551616"), "1 << 64 = 2^64");
+    TEST_ASSERT(superlong_bit_length(&a) == 65, "bit_length(2^64) = 65");
+    TEST_ASSERT(superlong_trailing_zeros(&a) == 64, "trailing_zeros(2^64) = 64");
+    
+    superlong_from_int(&a, -7);
+    superlong_shr(&a, 1);
+    TEST_ASSERT(compare_with_string(&a, "-4"), "-7 >> 1 = -4 (floor)");
+    
+    superlong_from_int(&a, -1);
+    superlong_shr(&a, 100);
+    TEST_ASSERT(compare_with_string(&a, "-1"), "-1 >> 100 = -1");
+    
+    // Bitwise operations with two's complement semantics
+    superlong_from_uint(&a, 0xF0F0);
+    superlong_from_uint(&b, 0x0FF0);
+    superlong_and(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "240"), "0xF0F0 & 0x0FF0 = 0xF0");
+    superlong_or(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "65520"), "0xF0F0 | 0x0FF0 = 0xFFF0");
+    superlong_xor(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "65280"), "0xF0F0 ^ 0x0FF0 = 0xFF00");
+    
+    superlong_from_int(&a, -12);
+    superlong_from_uint(&b, 10);
+    superlong_and(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "0"), "-12 & 10 = 0");
+    superlong_or(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "-2"), "-12 | 10 = -2");
+    superlong_from_int(&b, -10);
+    superlong_xor(&a, &b, &result);
+    TEST_ASSERT(compare_with_string(&result, "2"), "-12 ^ -10 = 2");
+    superlong_not(&a, &a);
+    TEST_ASSERT(compare_with_string(&a, "11"), "~(-12) = 11");
+    superlong_not(&a, &result);
+    TEST_ASSERT(compare_with_string(&result, "-12"), "~11 = -12");
+    
+    // Counting and single-bit access
+    superlong_from_uint(&a, 0xFF00FF);
+    TEST_ASSERT(superlong_popcount(&a) == 16, "popcount(0xFF00FF) = 16");
+    superlong_from_int(&a, -8);
+    TEST_ASSERT(superlong_test_bit(&a, 3) && !superlong_test_bit(&a, 2) && superlong_test_bit(&a, 100),
+                "test_bit on -8");
+    superlong_clear_bit(&a, 3);
+    TEST_ASSERT(compare_with_string(&a, "-16"), "clear bit 3 of -8 = -16");
+    superlong_set_bit(&a, 0);
+    TEST_ASSERT(compare_with_string(&a, "-15"), "set bit 0 of -16 = -15");
+    superlong_from_uint(&a, 0);
+    superlong_set_bit(&a, 40);
+    TEST_ASSERT(compare_with_string(&a, "1099511627776"), "set bit 40 of 0 = 2^40");
+    superlong_clear_bit(&a, 40);
+    TEST_ASSERT(superlong_is_zero(&a), "clear bit 40 of 2^40 = 0");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&result);
+}
+
+// Test fused multiply-accumulate and 64-bit scalar operations
+void test_fused_and_64bit() {
+    printf(COLOR_YELLOW "\n=== Testing Fused Multiply-Accumulate and 64-bit Scalars ===" COLOR_RESET "\n");
+    
+    superlong a, b, acc;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&acc);
+    
+    superlong_from_uint(&a, 1000);
+    superlong_from_uint(&b, 2000);
+    superlong_from_uint(&acc, 5);
+    superlong_addmul(&a, &b, &acc);
+    TEST_ASSERT(compare_with_string(&acc, "2000005"), "5 + 1000 * 2000 = 2000005");
+    
+    superlong_submul(&a, &b, &acc);
+    superlong_submul(&a, &b, &acc);
+    TEST_ASSERT(compare_with_string(&acc, "-1999995"), "2000005 - 2 * 1000 * 2000 = -1999995");
+    
+    superlong_from_int(&acc, -10);
+    superlong_addmul_ui(&a, 3, &acc);
+    TEST_ASSERT(compare_with_string(&acc, "2990"), "-10 + 1000 * 3 = 2990");
+    superlong_submul_ui(&acc, 2, &acc);
+    TEST_ASSERT(compare_with_string(&acc, "-2990"), "acc -= acc * 2 (aliased)");
+    
+    // Karatsuba-sized operands
+    superlong_factorial(40, &a);
+    superlong_factorial(45, &b);
+    superlong_mul(&a, &b, &acc);
+    TEST_ASSERT(compare_with_string(&acc, "97601598220200855406862080626319653687095027127240868009509734628173016946912757022720000000000000000000"),
+                "40! * 45! (Karatsuba)");
+    superlong_submul(&a, &b, &acc);
+    TEST_ASSERT(superlong_is_zero(&acc), "40! * 45! - 40! * 45! = 0");
+    
+    // 64-bit scalars
+    superlong_from_int64(&a, INT64_MIN);
+    TEST_ASSERT(compare_with_string(&a, "-9223372036854775808"), "from_int64(INT64_MIN)");
+    TEST_ASSERT(superlong_fits_int64(&a) && superlong_get_int64(&a) == INT64_MIN, "INT64_MIN round trip");
+    superlong_sub_ui64(&a, 1, &a);
+    TEST_ASSERT(!superlong_fits_int64(&a), "INT64_MIN - 1 does not fit");
+    
+    superlong_from_uint64(&a, UINT64_MAX);
+    superlong_add_ui64(&a, UINT64_MAX, &b);
+    TEST_ASSERT(compare_with_string(&b, "36893488147419103230"), "UINT64_MAX + UINT64_MAX");
+    superlong_mul_ui64(&a, UINT64_MAX, &b);
+    TEST_ASSERT(compare_with_string(&b, "340282366920938463426481119284349108225"), "UINT64_MAX * UINT64_MAX");
+    superlong_div_ui64(&b, 10000000000000000000ULL, &b);
+    TEST_ASSERT(compare_with_string(&b, "34028236692093846342"), "UINT64_MAX^2 / 10^19");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&acc);
+}
+
+// Test balanced product trees
+void test_product_tree() {
+    printf(COLOR_YELLOW "\n=== Testing Product Trees ===" COLOR_RESET "\n");
+    
+    superlong result, expected;
+    superlong_init(&result);
+    superlong_init(&expected);
+    
+    uint32_t vals[100];
+    for (uint32_t i = 0; i < 100; i++)
+        vals[i] = i + 1;
+    superlong_prod_array_uint(vals, 100, &result);
+    superlong_factorial(100, &expected);
+    char* s1 = superlong_to_decimal_str(&result);
+    char* s2 = superlong_to_decimal_str(&expected);
+    TEST_ASSERT(strcmp(s1, s2) == 0 && strlen(s1) == 158, "prod(1..100) = 100! (158 digits)");
+    free(s1);
+    free(s2);
+    
+    superlong_prod_array_uint(vals, 0, &result);
+    TEST_ASSERT(compare_with_string(&result, "1"), "Empty product = 1");
+    
+    superlong nums[20];
+    const superlong* ptrs[20];
+    for (int i = 0; i < 20; i++) {
+        superlong_init(&nums[i]);
+        superlong_from_int(&nums[i], (i % 2) ? -(i + 1) : (i + 1));
+        ptrs[i] = &nums[i];
+    }
+    superlong_prod_array(ptrs, 20, &result);
+    TEST_ASSERT(compare_with_string(&result, "2432902008176640000"), "prod(+-1..+-20) = 20!");
+    superlong_prod_array(ptrs, 3, &nums[2]);
+    TEST_ASSERT(compare_with_string(&nums[2], "-6"), "Product into one of the factors");
+    
+    superlong_set_threads(4);
+    superlong_factorial(300, &result);
+    superlong_set_threads(1);
+    superlong_factorial(300, &expected);
+    s1 = superlong_to_decimal_str(&result);
+    s2 = superlong_to_decimal_str(&expected);
+    TEST_ASSERT(strcmp(s1, s2) == 0, "300! with 4 threads matches 1 thread");
+    free(s1);
+    free(s2);
+    
+    for (int i = 0; i < 20; i++)
+        superlong_deinit(&nums[i]);
+    superlong_deinit(&result);
+    superlong_deinit(&expected);
+}
+
+// Test multiplication of operands with very different lengths
+void test_unbalanced_multiplication() {
+    printf(COLOR_YELLOW "\n=== Testing Unbalanced Multiplication ===" COLOR_RESET "\n");
+    
+    superlong a, b, result, expected;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&result);
+    superlong_init(&expected);
+    
+    // (2^1600 - 1) * (2^160 - 1) = 2^1760 - 2^1600 - 2^160 + 1
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 1600);
+    superlong_sub_uint(&a, 1, &a);
+    superlong_from_uint(&b, 1);
+    superlong_shl(&b, 160);
+    superlong_sub_uint(&b, 1, &b);
+    superlong_mul(&a, &b, &result);
+    
+    superlong_from_uint(&expected, 1);
+    superlong_shl(&expected, 1760);
+    superlong_sub(&expected, &a, &expected);
+    superlong_sub(&expected, &b, &expected);
+    superlong_sub_uint(&expected, 1, &expected);
+    superlong_sub(&result, &expected, &expected);
+    TEST_ASSERT(superlong_is_zero(&expected), "(2^1600 - 1) * (2^160 - 1)");
+    
+    superlong_negate(&b);
+    superlong_mul(&b, &a, &b);
+    superlong_add(&b, &result, &b);
+    TEST_ASSERT(superlong_is_zero(&b), "Aliased short * long with sign");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&result);
+    superlong_deinit(&expected);
+}
+
+// Test division by small constants with precomputed reciprocals
+void test_division_by_constants() {
+    printf(COLOR_YELLOW "\n=== Testing Division by Constants ===" COLOR_RESET "\n");
+    
+    superlong a, result;
+    superlong_init(&a);
+    superlong_init(&result);
+    
+    superlong_factorial(30, &a); // 265252859812191058636308480000000
+    superlong_preinv inv;
+    superlong_preinv_init(&inv, 1000003);
+    uint32_t rem = superlong_divrem_preinv(&a, &inv, &result);
+    TEST_ASSERT(compare_with_string(&result, "265252064055998890639636561") && rem == 90317,
+                "30! divrem 1000003 with reciprocal");
+    TEST_ASSERT(superlong_mod_preinv(&a, &inv) == 90317, "30! mod 1000003 with reciprocal");
+    TEST_ASSERT(superlong_mod_ui(&a, 4294967291U) == 4282168768U, "30! mod 4294967291");
+    TEST_ASSERT(superlong_mod_ui(&a, 29) == 0, "30! mod 29 = 0");
+    
+    superlong_divexact_uint(&a, 3628800, &result);
+    TEST_ASSERT(compare_with_string(&result, "73096577329197271449600000"), "30! / 10! (exact)");
+    superlong_negate(&result);
+    superlong_divexact_by3(&result, &result);
+    TEST_ASSERT(compare_with_string(&result, "-24365525776399090483200000"), "-(30! / 10!) / 3 (exact)");
+    
+    superlong_from_int(&a, -1000);
+    superlong_div_uint(&a, 7, &a);
+    TEST_ASSERT(compare_with_string(&a, "-142"), "-1000 / 7 = -142 (aliased)");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&result);
+}
+
+// Test raw word import/export and binary serialization
+void test_serialization() {
+    printf(COLOR_YELLOW "\n=== Testing Serialization ===" COLOR_RESET "\n");
+    
+    superlong a, b;
+    superlong_init(&a);
+    superlong_init(&b);
+    
+    // 2^64 + 0x0102 as big-endian 32-bit words, most significant first
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 64);
+    superlong_add_uint(&a, 0x0102, &a);
+    size_t count = 0;
+    unsigned char* words = superlong_export(NULL, &count, 1, 4, 1, &a);
+    const unsigned char expected[12] = {0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 2};
+    TEST_ASSERT(count == 3 && memcmp(words, expected, 12) == 0, "Export big-endian words, most significant first");
+    superlong_import(&b, count, 1, 4, 1, words);
+    TEST_ASSERT(compare_with_string(&b, "18446744073709551874"), "Import big-endian words");
+    free(words);
+    
+    uint16_t halves[5];
+    superlong_factorial(20, &a);
+    superlong_export(halves, &count, -1, sizeof(uint16_t), 0, &a);
+    superlong_import(&b, count, -1, sizeof(uint16_t), 0, halves);
+    TEST_ASSERT(count == 4 && compare_with_string(&b, "2432902008176640000"), "Native 16-bit words round trip");
+    
+    // File format
+    FILE* file = tmpfile();
+    superlong_factorial(100, &a);
+    superlong_negate(&a);
+    superlong_from_uint(&b, 0);
+    TEST_ASSERT(superlong_fwrite(file, &a) == 0 && superlong_fwrite(file, &b) == 0, "Write numbers to a file");
+    rewind(file);
+    superlong c;
+    superlong_init(&c);
+    TEST_ASSERT(superlong_fread(file, &c) == 0 && superlong_compare(&a, &c) == 0, "Read -100! back");
+    TEST_ASSERT(superlong_fread(file, &c) == 0 && superlong_is_zero(&c), "Read zero back");
+    TEST_ASSERT(superlong_fread(file, &c) == -1, "Read past the end fails");
+    
+    // flip a payload byte: the checksum must catch it
+    fseek(file, SUPERLONG_FILE_HEADER_SIZE + 10, SEEK_SET);
+    fputc(0x5A, file);
+    rewind(file);
+    TEST_ASSERT(superlong_fread(file, &c) == -1, "Corrupted payload is rejected");
+    fclose(file);
+    
+    file = tmpfile();
+    TEST_ASSERT(superlong_write_fd(fileno(file), &a) == 0, "writev to a file descriptor");
+    rewind(file);
+    TEST_ASSERT(superlong_read_fd(fileno(file), &c) == 0 && superlong_compare(&a, &c) == 0, "Read from a file descriptor");
+    
+    // a header claiming 2^60 digits, then one digit more than the payload holds
+    const unsigned char huge[8] = {0, 0, 0, 0, 0, 0, 0, 0x10};
+    fseek(file, 8, SEEK_SET);
+    fwrite(huge, 1, sizeof(huge), file);
+    fflush(file);
+    rewind(file);
+    TEST_ASSERT(superlong_fread(file, &c) == -1, "Oversized header length is rejected by fread");
+    rewind(file);
+    TEST_ASSERT(superlong_read_fd(fileno(file), &c) == -1, "Oversized header length is rejected by read_fd");
+    unsigned char longer[8];
+    size_t claimed = a.digits.len + 1;
+    for (int i = 0; i < 8; i++)
+        longer[i] = (unsigned char) (claimed >> (8 * i));
+    fseek(file, 8, SEEK_SET);
+    fwrite(longer, 1, sizeof(longer), file);
+    fflush(file);
+    rewind(file);
+    TEST_ASSERT(superlong_fread(file, &c) == -1, "Truncated payload is rejected by fread");
+    rewind(file);
+    TEST_ASSERT(superlong_read_fd(fileno(file), &c) == -1 && superlong_is_zero(&c), "Truncated payload is rejected by read_fd");
+    fclose(file);
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&c);
+}
+
+void test_views() {
+    printf(COLOR_YELLOW "\n=== Testing Read-Only Views ===" COLOR_RESET "\n");
+    
+    superlong a, b;
+    superlong_init(&a);
+    superlong_init(&b);
+    
+    // caller-owned buffer with padding zeros on top
+    const unsigned char raw[6] = {0x02, 0x01, 0, 0, 0, 0};
+    superlong_view v = superlong_view_from_buffer(raw, sizeof(raw), -1);
+    TEST_ASSERT(v.len == 2 && v.sign == -1, "View trims leading zero digits");
+    char* str = superlong_to_decimal_str_view(v);
+    TEST_ASSERT(strcmp(str, "-258") == 0, "View to decimal string");
+    free(str);
+    
+    superlong_factorial(30, &a);
+    superlong_view w = superlong_view_of(&a);
+    superlong_mul_view(w, v, &b);
+    TEST_ASSERT(compare_with_string(&b, "-68435237831545293128167587840000000"), "Multiply views");
+    superlong_add_view(w, v, &b);
+    TEST_ASSERT(compare_with_string(&b, "265252859812191058636308479999742"), "Add views");
+    superlong_sub_view(v, w, &b);
+    TEST_ASSERT(compare_with_string(&b, "-265252859812191058636308480000258"), "Subtract views");
+    superlong_div_view(w, v, &b);
+    TEST_ASSERT(compare_with_string(&b, "-1028111859737174645877164651162"), "Divide views");
+    TEST_ASSERT(superlong_compare_view(v, w) < 0 && superlong_compare_view(w, w) == 0, "Compare views");
+    
+    superlong_view zero = superlong_view_from_buffer(raw + 2, 4, 1);
+    superlong_add_view(zero, v, &b);
+    TEST_ASSERT(zero.sign == 0 && compare_with_string(&b, "-258"), "All-zero buffer is a zero view");
+    
+    // map a written file without reading it into memory
+    const char* path = "build/test-view.slng";
+    FILE* file = fopen(path, "wb");
+    superlong_fwrite(file, &a);
+    fclose(file);
+    superlong_view m;
+    TEST_ASSERT(superlong_view_map_file(path, 1, &m) == 0 && superlong_compare_view(m, w) == 0, "Map a number file");
+    superlong shell = superlong_view_borrow(m);
+    superlong_mul(&shell, &shell, &b);
+    TEST_ASSERT(compare_with_string(&b, "70359079638545882374689246780656119576032161719910400000000000000"), "Borrowed shell as an operand");
+    superlong_view_unmap(&m);
+    TEST_ASSERT(m.digits == NULL && m.len == 0, "Unmap resets the view");
+    
+    file = fopen(path, "r+b");
+    fseek(file, SUPERLONG_FILE_HEADER_SIZE + 3, SEEK_SET);
+    fputc(0x5A, file);
+    fclose(file);
+    TEST_ASSERT(superlong_view_map_file(path, 1, &m) == -1, "Checksum mismatch is rejected");
+    TEST_ASSERT(superlong_view_map_file(path, 0, &m) == 0, "Unverified mapping skips the checksum");
+    superlong_view_unmap(&m);
+    remove(path);
+    TEST_ASSERT(superlong_view_map_file(path, 0, &m) == -1, "Missing file fails to map");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+}
+
+typedef struct {
+    char text[8192];
+    size_t len;
+    size_t calls;
+    size_t largest;
+} test_sink_state;
+
+static int test_sink(void* ctx, const char* data, size_t len) {
+    test_sink_state* state = ctx;
+    if (state->len + len >= sizeof(state->text))
+        return -1;
+    memcpy(state->text + state->len, data, len);
+    state->len += len;
+    state->text[state->len] = '\0';
+    state->calls++;
+    if (len > state->largest)
+        state->largest = len;
+    return 0;
+}
+
+// keeps the first 16 characters and counts the rest
+typedef struct {
+    char head[17];
+    size_t len;
+} test_count_state;
+
+static int test_count_sink(void* ctx, const char* data, size_t len) {
+    test_count_state* state = ctx;
+    for (size_t i = 0; i < len && state->len + i < 16; i++)
+        state->head[state->len + i] = data[i];
+    state->len += len;
+    return 0;
+}
+
+void test_streaming_output() {
+    printf(COLOR_YELLOW "\n=== Testing Streaming Output ===" COLOR_RESET "\n");
+    
+    superlong a;
+    superlong_init(&a);
+    test_sink_state state = {{0}, 0, 0, 0};
+    
+    superlong_from_int(&a, -255);
+    TEST_ASSERT(superlong_out_sink(test_sink, &state, 16, &a) == 0 && strcmp(state.text, "-ff") == 0, "Hexadecimal output");
+    state.len = 0;
+    superlong_out_sink(test_sink, &state, 2, &a);
+    TEST_ASSERT(strcmp(state.text, "-11111111") == 0, "Binary output");
+    state.len = 0;
+    superlong_from_uint(&a, 3844);
+    superlong_out_sink(test_sink, &state, 62, &a);
+    TEST_ASSERT(strcmp(state.text, "100") == 0, "Base 62 output");
+    state.len = 0;
+    superlong_from_uint(&a, 0);
+    superlong_out_sink(test_sink, &state, 7, &a);
+    TEST_ASSERT(strcmp(state.text, "0") == 0, "Zero output");
+    TEST_ASSERT(superlong_out_sink(test_sink, &state, 63, &a) == -1, "Invalid base is rejected");
+    
+    // 2000! has 5736 decimal digits: it arrives in several bounded pieces
+    superlong_factorial(2000, &a);
+    state.len = 0;
+    state.calls = 0;
+    TEST_ASSERT(superlong_out_sink(test_sink, &state, 10, &a) == 0 && state.calls > 1 && state.largest <= 4096,
+                "Large output is streamed in chunks");
+    char* str = superlong_to_decimal_str(&a);
+    TEST_ASSERT(state.len == 5736 && strcmp(state.text, str) == 0, "Stream matches the decimal string");
+    free(str);
+    
+    superlong_shl(&a, 16384);
+    TEST_ASSERT(superlong_out_sink(test_sink, &state, 10, &a) == -1, "Sink failure aborts the output");
+    
+    // decimal output needs one working copy of the magnitude and a table of small powers
+    superlong_from_uint(&a, 3);
+    superlong_pow_ui(&a, 60000, &a);
+    test_count_state count = {{0}, 0};
+    nc_alloc_profile before, after;
+    nc_alloc_profile_reset();
+    nc_alloc_profile_snapshot(&before);
+    superlong_out_sink(test_count_sink, &count, 10, &a);
+    nc_alloc_profile_snapshot(&after);
+    TEST_ASSERT(count.len == 28628 && strcmp(count.head, "1884877714847478") == 0, "3^60000 streams in decimal");
+    if (nc_alloc_profile_enabled())
+        TEST_ASSERT(after.peak_bytes - before.live_bytes <= a.digits.len + a.digits.len / 4 + 1024,
+                    "Decimal streaming peak stays near the size of the number");
+    str = superlong_to_decimal_str(&a);
+    TEST_ASSERT(strlen(str) == 28628 && strcmp(str + 28612, "8503839313200001") == 0, "3^60000 as a decimal string");
+    free(str);
+    
+    FILE* file = tmpfile();
+    superlong_from_int(&a, -1000);
+    TEST_ASSERT(superlong_out_str(file, 36, &a) == 0, "Write to a FILE");
+    rewind(file);
+    char buf[16] = {0};
+    TEST_ASSERT(fgets(buf, sizeof(buf), file) && strcmp(buf, "-rs") == 0, "FILE contains the base 36 digits");
+    fclose(file);
+    
+    superlong_deinit(&a);
+}
+
+void test_radix_conversion() {
+    printf(COLOR_YELLOW "\n=== Testing Radix Conversion ===" COLOR_RESET "\n");
+    
+    superlong a, b;
+    superlong_init(&a);
+    superlong_init(&b);
+    
+    superlong_from_int64(&a, -3735928559);
+    char* str = superlong_to_str(&a, 16);
+    TEST_ASSERT(strcmp(str, "-deadbeef") == 0, "Hexadecimal string");
+    free(str);
+    str = superlong_to_str(&a, 8);
+    TEST_ASSERT(strcmp(str, "-33653337357") == 0, "Octal string");
+    free(str);
+    str = superlong_to_str(&a, 32);
+    TEST_ASSERT(strcmp(str, "-3farfnf") == 0, "Base 32 string");
+    free(str);
+    str = superlong_to_str(&a, 62);
+    TEST_ASSERT(strcmp(str, "-44pZgF") == 0, "Base 62 string");
+    free(str);
+    TEST_ASSERT(superlong_to_str(&a, 1) == NULL, "Invalid base gives NULL");
+    
+    TEST_ASSERT(superlong_from_str(&b, "-DeadBeef", 16) == 0 && superlong_compare(&a, &b) == 0, "Parse mixed-case hex");
+    TEST_ASSERT(superlong_from_str(&b, "-44pZgF", 62) == 0 && superlong_compare(&a, &b) == 0, "Parse base 62");
+    TEST_ASSERT(superlong_from_str(&b, "+0001010", 2) == 0 && compare_with_string(&b, "10"), "Parse binary with sign and leading zeros");
+    TEST_ASSERT(superlong_from_str(&b, "-000", 7) == 0 && superlong_is_zero(&b), "Parse negative zero");
+    TEST_ASSERT(superlong_from_str(&b, "12a", 10) == -1, "Reject a digit outside the base");
+    TEST_ASSERT(superlong_from_str(&b, "-", 10) == -1, "Reject a missing number");
+    
+    // long round trips through every kind of base
+    superlong_factorial(500, &a);
+    superlong_negate(&a);
+    int bases[] = {2, 3, 10, 16, 32, 36, 37, 62};
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        str = superlong_to_str(&a, bases[i]);
+        ok &= superlong_from_str(&b, str, bases[i]) == 0 && superlong_compare(&a, &b) == 0;
+        free(str);
+    }
+    TEST_ASSERT(ok, "500! round trips in bases 2 to 62");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+}
+
+void test_batch_operations() {
+    printf(COLOR_YELLOW "\n=== Testing Batch Operations ===" COLOR_RESET "\n");
+    
+    superlong x, y;
+    superlong_init(&x);
+    superlong_init(&y);
+    
+    // 11 lanes: two full AVX2 vectors plus a scalar tail
+    superlong_batch a, b, r;
+    superlong_batch_init(&a, 11, 128);
+    superlong_batch_init(&b, 11, 128);
+    superlong_batch_init(&r, 11, 128);
+    TEST_ASSERT(a.width == 4, "128-bit lanes use four limbs");
+    for (size_t i = 0; i < 11; i++) {
+        superlong_factorial(20 + (uint32_t) i, &x);
+        superlong_from_uint64(&y, 1000003ULL * (i + 1));
+        superlong_batch_set(&a, i, &x);
+        superlong_batch_set(&b, i, &y);
+    }
+    
+    superlong_batch_add(&a, &b, &r);
+    superlong_batch_get(&r, 10, &x);
+    TEST_ASSERT(compare_with_string(&x, "265252859812191058636308491000033"), "Lane-wise addition");
+    superlong_batch_mul(&a, &b, &r);
+    superlong_batch_get(&r, 3, &x);
+    TEST_ASSERT(compare_with_string(&x, "103408377179740773179719680000"), "Lane-wise multiplication");
+    // 30! * 11000033 needs more than 128 bits: the product wraps
+    superlong_batch_get(&r, 10, &x);
+    TEST_ASSERT(compare_with_string(&x, "195531275910967739597331418725694308352"), "Multiplication wraps at the lane width");
+    
+    uint32_t rems[11];
+    superlong_batch_mod_ui(&a, 1000000007u, rems);
+    superlong_factorial(25, &x);
+    TEST_ASSERT(rems[5] == superlong_mod_ui(&x, 1000000007u), "Lane-wise remainder");
+    superlong_batch_mod_ui(&a, 7, rems);
+    TEST_ASSERT(rems[0] == 0 && rems[10] == 0, "Remainder by a small divisor");
+    
+    superlong_from_int(&x, -1);
+    superlong_batch_set(&a, 0, &x);
+    superlong_batch_get(&a, 0, &y);
+    TEST_ASSERT(compare_with_string(&y, "340282366920938463463374607431768211455"), "Negative values wrap to two's complement");
+    superlong_from_uint(&x, 1);
+    superlong_batch_set(&b, 0, &x);
+    superlong_batch_add(&a, &b, &a);
+    superlong_batch_get(&a, 0, &y);
+    TEST_ASSERT(superlong_is_zero(&y), "In-place addition carries out of the top limb");
+    
+    superlong_batch_deinit(&a);
+    superlong_batch_deinit(&b);
+    superlong_batch_deinit(&r);
+    superlong_deinit(&x);
+    superlong_deinit(&y);
+}
+
+void test_fixed_width() {
+    printf(COLOR_YELLOW "\n=== Testing Fixed-Width Types ===" COLOR_RESET "\n");
+    
+    superlong x;
+    superlong_init(&x);
+    superlong_fixed256 a, b, q, r;
+    
+    superlong_factorial(50, &x);
+    superlong_fixed256_from_superlong(&a, &x);
+    superlong_fixed256_from_uint64(&b, 1000000007ULL * 998244353ULL);
+    superlong_fixed256_divmod(&q, &r, &a, &b);
+    superlong_fixed256_to_superlong(&q, &x);
+    TEST_ASSERT(compare_with_string(&x, "30467583310050266942917049802432632098736908137"), "256-bit divide by a two-word divisor");
+    superlong_fixed256_to_superlong(&r, &x);
+    TEST_ASSERT(compare_with_string(&x, "85912775919997473"), "256-bit remainder");
+    
+    superlong_fixed256_mul(&q, &q, &b);
+    superlong_fixed256_add(&q, &q, &r);
+    TEST_ASSERT(superlong_fixed256_compare(&q, &a) == 0, "Quotient times divisor plus remainder gives the dividend back");
+    superlong_fixed256_from_uint64(&b, 1);
+    TEST_ASSERT(superlong_fixed256_sub(&r, &b, &a) == 1, "Subtraction reports the borrow");
+    TEST_ASSERT(superlong_fixed256_add(&r, &r, &a) == 1 && superlong_fixed256_compare(&r, &b) == 0, "Addition wraps with a carry");
+    
+    superlong_from_int(&x, -2);
+    superlong_fixed256_from_superlong(&a, &x);
+    superlong_fixed256_to_superlong(&a, &x);
+    TEST_ASSERT(compare_with_string(&x, "115792089237316195423570985008687907853269984665640564039457584007913129639934"), "Negative value wraps to 2^256 - 2");
+    
+    superlong_fixed4096 big, divisor, rem;
+    superlong_factorial(450, &x);
+    superlong_fixed4096_from_superlong(&big, &x);
+    superlong_factorial(449, &x);
+    superlong_fixed4096_from_superlong(&divisor, &x);
+    superlong_fixed4096_divmod(&big, &rem, &big, &divisor);
+    superlong_fixed4096_to_superlong(&big, &x);
+    TEST_ASSERT(compare_with_string(&x, "450") && superlong_fixed4096_is_zero(&rem), "4096-bit exact division in place");
+    
+    superlong_deinit(&x);
+}
+
+void test_accumulator() {
+    printf(COLOR_YELLOW "\n=== Testing Carry-Save Accumulator ===" COLOR_RESET "\n");
+    
+    superlong x, sum, expected;
+    superlong_init(&x);
+    superlong_init(&sum);
+    superlong_init(&expected);
+    superlong_accumulator acc;
+    superlong_accumulator_init(&acc);
+    
+    // 2^64 - 1 a thousand times: every add overflows the low lanes
+    superlong_from_uint64(&x, UINT64_MAX);
+    for (int i = 0; i < 1000; i++)
+        superlong_accumulator_add(&acc, &x);
+    superlong_accumulator_finish(&acc, &sum);
+    TEST_ASSERT(compare_with_string(&sum, "18446744073709551615000"), "Sum of a thousand 64-bit maxima");
+    
+    // the accumulator is empty again after finish
+    superlong_accumulator_finish(&acc, &sum);
+    TEST_ASSERT(superlong_is_zero(&sum), "Finish resets the accumulator");
+    
+    superlong_from_uint(&expected, 0);
+    for (uint32_t i = 1; i <= 60; i++) {
+        superlong_factorial(i, &x);
+        if (i % 3 == 0) {
+            superlong_accumulator_sub(&acc, &x);
+            superlong_sub(&expected, &x, &expected);
+        } else {
+            superlong_negate(&x);
+            superlong_accumulator_add(&acc, &x);
+            superlong_add(&expected, &x, &expected);
+        }
+    }
+    superlong_accumulator_finish(&acc, &sum);
+    TEST_ASSERT(sum.sign < 0 && superlong_compare(&sum, &expected) == 0, "Negative running sum of mixed signs");
+    
+    superlong_from_int(&x, 7);
+    superlong_accumulator_add(&acc, &x);
+    superlong_accumulator_sub(&acc, &x);
+    superlong_accumulator_finish(&acc, &sum);
+    TEST_ASSERT(superlong_is_zero(&sum) && sum.sign == 0, "Cancelling terms give zero");
+    
+    superlong_accumulator_deinit(&acc);
+    superlong_deinit(&x);
+    superlong_deinit(&sum);
+    superlong_deinit(&expected);
+}
+
+#ifndef __STDC_NO_THREADS__
+static int test_stats_thread(void* arg) {
+    superlong* operands = arg;
+    superlong res;
+    superlong_init(&res);
+    superlong_mul(&operands[0], &operands[1], &res);
+    superlong_deinit(&res);
+    return 0;
+}
+#endif
+
+void test_stats() {
+    printf(COLOR_YELLOW "\n=== Testing Operation Counters ===" COLOR_RESET "\n");
+    
+    superlong a, b, res;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&res);
+    superlong_factorial(60, &a);
+    superlong_factorial(55, &b);
+    
+    superlong_stats stats;
+    superlong_stats_reset();
+    superlong_mul(&a, &b, &res);
+    superlong_div(&res, &b, &res);
+    superlong_stats_snapshot(&stats);
+    TEST_ASSERT(superlong_compare(&res, &a) == 0, "Instrumented operations still compute correctly");
+    TEST_ASSERT(strcmp(superlong_stats_name(SUPERLONG_STAT_MUL_KARATSUBA), "mul_karatsuba") == 0, "Operation names");
+    
+    if (superlong_stats_enabled()) {
+        // 60! and 55! have 35 and 31 digits: one 66-digit multiplication on the Karatsuba tier
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL].calls == 1, "Top-level multiplication counted once");
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL].sizes[7] == 1, "Operand size lands in the [64, 128) bucket");
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL_KARATSUBA].calls >= 1, "Karatsuba tier counted");
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_DIV].calls == 1 && stats.ops[SUPERLONG_STAT_DIV_LONG].calls == 1,
+                    "Long division tier counted");
+        
+        superlong_stats_reset();
+        superlong_stats_snapshot(&stats);
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL].calls == 0 && stats.ops[SUPERLONG_STAT_MUL].cycles == 0,
+                    "Reset clears the counters");
+        
+#ifndef __STDC_NO_THREADS__
+        // exited threads keep their counts, and later threads reuse their blocks
+        superlong operands[2] = {a, b};
+        thrd_t thread;
+        thrd_create(&thread, test_stats_thread, operands);
+        thrd_join(thread, NULL);
+        nc_alloc_profile before, after;
+        nc_alloc_profile_snapshot(&before);
+        for (int i = 0; i < 8; i++) {
+            thrd_create(&thread, test_stats_thread, operands);
+            thrd_join(thread, NULL);
+        }
+        nc_alloc_profile_snapshot(&after);
+        superlong_stats_snapshot(&stats);
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL].calls == 9, "Counts of exited threads survive");
+        TEST_ASSERT(after.live_bytes == before.live_bytes, "Thread churn reuses counter blocks");
+#endif
+    } else {
+        TEST_ASSERT(stats.ops[SUPERLONG_STAT_MUL].calls == 0, "Counters stay zero without SUPERLONG_STATS");
+    }
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&res);
+}
+
+void test_alloc_profile() {
+    printf(COLOR_YELLOW "\n=== Testing Allocation Profile ===" COLOR_RESET "\n");
+    
+    superlong a, b;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_factorial(300, &a);
+    superlong_factorial(250, &b);
+    
+    nc_alloc_profile before, after;
+    nc_alloc_profile_reset();
+    nc_alloc_profile_snapshot(&before);
+    
+    superlong res;
+    superlong_init(&res);
+    superlong_mul(&a, &b, &res);
+    char* str = superlong_to_str(&res, 16);
+    free(str);
+    superlong_deinit(&res);
+    nc_alloc_profile_snapshot(&after);
+    
+    if (nc_alloc_profile_enabled()) {
+        TEST_ASSERT(after.allocs > 0 && after.bytes_requested > 0, "Allocations counted");
+        TEST_ASSERT(after.frees > 0, "Frees counted");
+        TEST_ASSERT(after.live_bytes == before.live_bytes, "Live bytes return to the baseline");
+        TEST_ASSERT(after.peak_bytes > after.live_bytes, "Peak covers the temporaries");
+        // attribution needs no STATS=1
+        TEST_ASSERT(after.tag_allocs[SUPERLONG_STAT_MUL_KARATSUBA] > 0, "Karatsuba temporaries attributed");
+    } else {
+        TEST_ASSERT(after.allocs == 0 && after.peak_bytes == 0, "Profile stays zero without NC_ALLOC_PROFILE");
+    }
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+}
+
+void test_shared_values() {
+    printf(COLOR_YELLOW "\n=== Testing Shared Values ===" COLOR_RESET "\n");
+    
+    superlong num;
+    superlong_init(&num);
+    superlong_factorial(100, &num);
+    const n256* digits = num.digits.arr;
+    
+    superlong_shared a, b, c;
+    superlong_shared_init(&a);
+    superlong_shared_init(&b);
+    superlong_shared_init(&c);
+    TEST_ASSERT(superlong_is_zero(superlong_shared_get(&a)), "Empty handle reads as zero");
+    
+    superlong_shared_set(&a, &num);
+    TEST_ASSERT(superlong_is_zero(&num) && superlong_shared_get(&a)->digits.arr == digits, "Set moves the digits");
+    
+    superlong_shared_copy(&a, &b);
+    superlong_shared_copy(&b, &c);
+    TEST_ASSERT(superlong_shared_get(&c)->digits.arr == digits && superlong_shared_is_shared(&a),
+                "Copies share one buffer");
+    
+    superlong_shared_negate(&b);
+    TEST_ASSERT(superlong_shared_get(&b)->digits.arr != digits, "Writing a shared value detaches it");
+    TEST_ASSERT(superlong_shared_get(&b)->sign < 0 && superlong_shared_get(&a)->sign > 0, "Other handles keep the old value");
+    
+    superlong* mut = superlong_shared_mut(&b);
+    TEST_ASSERT(mut == superlong_shared_get(&b), "A detached value is written in place");
+    superlong_add_uint(mut, 1, mut);
+    superlong_negate(mut);
+    superlong_factorial(100, &num);
+    superlong_sub_uint(&num, 1, &num);
+    TEST_ASSERT(superlong_compare(superlong_shared_get(&b), &num) == 0, "Mutation through mut");
+    
+    superlong_shared_deinit(&a);
+    TEST_ASSERT(!superlong_shared_is_shared(&c) && superlong_shared_mut(&c)->digits.arr == digits,
+                "The last handle owns the buffer without copying");
+    
+    superlong_shared_copy(&c, &c);
+    TEST_ASSERT(superlong_shared_get(&c)->digits.arr == digits, "Self-copy keeps the value");
+    
+    superlong_shared_copy(&c, &a);
+    superlong* out = superlong_shared_res(&a);
+    TEST_ASSERT(superlong_is_zero(out) && out->digits.cap < superlong_shared_get(&c)->digits.len,
+                "A shared result is detached without copying");
+    TEST_ASSERT(superlong_shared_get(&c)->digits.arr == digits && !superlong_shared_is_shared(&c),
+                "The other handle keeps the old value");
+    superlong_mul(superlong_shared_get(&c), superlong_shared_get(&c), out);
+    TEST_ASSERT(superlong_shared_res(&a) == out, "An unshared result is written in place");
+    superlong_factorial(100, &num);
+    superlong_mul(&num, &num, &num);
+    TEST_ASSERT(superlong_compare(superlong_shared_get(&a), &num) == 0, "Overwriting through res");
+    
+    superlong_shared_deinit(&a);
+    superlong_shared_deinit(&b);
+    superlong_shared_deinit(&c);
+    superlong_deinit(&num);
+}
+
+typedef struct {
+    int calls;
+    int cancel_after;
+    uint64_t last_done;
+    uint64_t last_total;
+} test_progress_state;
+
+static int test_progress(void* ctx, uint64_t done, uint64_t total) {
+    test_progress_state* state = ctx;
+    state->calls++;
+    state->last_done = done;
+    state->last_total = total;
+    return state->cancel_after > 0 && state->calls >= state->cancel_after;
+}
+
+// cancels once the operation is half done, recording how far it got like test_progress
+static int test_progress_halfway(void* ctx, uint64_t done, uint64_t total) {
+    test_progress(ctx, done, total);
+    return done * 2 > total;
+}
+
+void test_cancellable_operations() {
+    printf(COLOR_YELLOW "\n=== Testing Cancellable Operations ===" COLOR_RESET "\n");
+    
+    superlong a, b, res, expected;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&res);
+    superlong_init(&expected);
+    
+    test_progress_state state = {0, 0, 0, 0};
+    superlong_exec exec;
+    superlong_exec_init(&exec, test_progress, &state);
+    
+    TEST_ASSERT(superlong_factorial_ex(&exec, 2000, &res) == 0, "Factorial runs to completion");
+    superlong_factorial(2000, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Factorial result");
+    TEST_ASSERT(state.calls > 1 && state.last_done == 1999 && state.last_total == 1999, "Factorial reports every factor");
+    
+    superlong_exec_init(&exec, test_progress, &state);
+    state.calls = 0;
+    state.cancel_after = 2;
+    superlong_from_uint(&res, 7);
+    TEST_ASSERT(superlong_factorial_ex(&exec, 5000, &res) == -1 && state.calls == 2, "Progress callback cancels");
+    TEST_ASSERT(compare_with_string(&res, "7"), "Cancelled call leaves res unchanged");
+    TEST_ASSERT(superlong_mul_ex(&exec, &expected, &expected, &res) == -1, "Cancellation is sticky");
+    
+    superlong_factorial(900, &a);
+    superlong_factorial(700, &b);
+    superlong_exec_init(&exec, test_progress, &state);
+    state.calls = 0;
+    state.cancel_after = 0;
+    TEST_ASSERT(superlong_mul_ex(&exec, &a, &b, &res) == 0, "Multiplication runs to completion");
+    superlong_mul(&a, &b, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0 && state.last_done == state.last_total && state.calls > 1,
+                "Multiplication result and final report");
+    
+    TEST_ASSERT(superlong_div_ex(&exec, &expected, &b, &res) == 0 && superlong_compare(&res, &a) == 0, "Division result");
+    superlong_exec_init(&exec, test_progress, &state);
+    state.calls = 0;
+    state.cancel_after = 1;
+    superlong_from_uint(&res, 7);
+    TEST_ASSERT(superlong_div_ex(&exec, &expected, &b, &res) == -1 && compare_with_string(&res, "7"), "Division cancels");
+    
+    // cancelled halfway through: the callback's report is the last one and the work stops there
+    superlong_factorial(3000, &a);
+    superlong_factorial(2500, &b);
+    superlong_exec_init(&exec, test_progress_halfway, &state);
+    state.calls = 0;
+    superlong_from_uint(&res, 7);
+    TEST_ASSERT(superlong_mul_ex(&exec, &a, &b, &res) == -1 && compare_with_string(&res, "7"),
+                "Karatsuba multiplication cancels partway");
+    TEST_ASSERT(state.last_done > 0 && state.last_done < state.last_total, "Multiplication stopped before the end");
+    
+    superlong_mul(&a, &b, &expected);
+    superlong_exec_init(&exec, test_progress_halfway, &state);
+    state.calls = 0;
+    TEST_ASSERT(superlong_div_ex(&exec, &expected, &b, &res) == -1 && compare_with_string(&res, "7"),
+                "Long division cancels partway");
+    TEST_ASSERT(state.last_done > 0 && state.last_done < state.last_total, "Division stopped before the end");
+    
+    // the string is the caller's to free with free(), the cancelled one is released the same way
+    nc_alloc_profile before, after;
+    nc_alloc_profile_snapshot(&before);
+    superlong_exec_init(&exec, test_progress_halfway, &state);
+    state.calls = 0;
+    TEST_ASSERT(superlong_to_str_ex(&exec, &expected, 10) == NULL && state.last_done < state.last_total,
+                "String conversion cancels partway");
+    nc_alloc_profile_snapshot(&after);
+    TEST_ASSERT(after.live_bytes == before.live_bytes, "Cancelled conversion releases its string");
+    superlong_factorial(900, &a);
+    
+    superlong_exec_init(&exec, NULL, NULL);
+    char* str = superlong_to_str_ex(&exec, &a, 10);
+    char* plain = superlong_to_str(&a, 10);
+    TEST_ASSERT(str != NULL && strcmp(str, plain) == 0, "String conversion without a callback");
+    free(str);
+    free(plain);
+    superlong_exec_cancel(&exec);
+    TEST_ASSERT(superlong_to_str_ex(&exec, &a, 10) == NULL && superlong_exec_cancelled(&exec), "String conversion cancels");
+    
+    superlong_factorial_iter it;
+    superlong_factorial_iter_init(&it, 1000);
+    int steps = 0;
+    while (!superlong_factorial_iter_step(&it, 64))
+        steps++;
+    superlong_factorial(1000, &expected);
+    TEST_ASSERT(steps == 15 && superlong_compare(&it.acc, &expected) == 0, "Step-wise factorial");
+    TEST_ASSERT(superlong_factorial_iter_step(&it, 64) == 1, "Finished iterator stays finished");
+    superlong_factorial_iter_deinit(&it);
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&res);
+    superlong_deinit(&expected);
+}
+
+static int test_cancel_halfway(void* ctx, uint64_t done, uint64_t total) {
+    (void) ctx;
+    return done * 2 > total;
+}
+
+// writes a factorial checkpoint of n by hand: count records of value, tagged by tags
+static void test_write_factorial_ckpt(const char* path, uint32_t n, uint64_t progress, uint32_t count,
+                                      const uint32_t* tags, const superlong* value) {
+    unsigned char header[40] = {'S', 'L', 'C', 'K', 1, 1};
+    for (int i = 0; i < 8; i++) {
+        header[8 + i] = (unsigned char) ((uint64_t) n >> (8 * i));
+        header[24 + i] = (unsigned char) (progress >> (8 * i));
+    }
+    for (int i = 0; i < 4; i++)
+        header[32 + i] = (unsigned char) (count >> (8 * i));
+    FILE* file = fopen(path, "wb");
+    fwrite(header, 1, sizeof(header), file);
+    for (uint32_t i = 0; i < count; i++) {
+        unsigned char tag[4] = {(unsigned char) tags[i], 0, 0, 0};
+        fwrite(tag, 1, sizeof(tag), file);
+        superlong_fwrite(file, value);
+    }
+    fclose(file);
+}
+
+// p(k) = k + 1 + shift, q(k) = 2k + 3 and a(k) = k, with shift read from ctx
+static void test_ratio_term(void* ctx, uint64_t k, superlong* p, superlong* q, superlong* a) {
+    superlong_from_uint64(p, k + 1 + *(const uint64_t*) ctx);
+    superlong_from_uint64(q, 2 * k + 3);
+    superlong_from_uint64(a, k);
+}
+
+void test_checkpoints() {
+    printf(COLOR_YELLOW "\n=== Testing Powers and Checkpoints ===" COLOR_RESET "\n");
+    
+    superlong base, res, expected;
+    superlong_init(&base);
+    superlong_init(&res);
+    superlong_init(&expected);
+    
+    superlong_from_uint(&base, 3);
+    superlong_pow_ui(&base, 40, &res);
+    TEST_ASSERT(compare_with_string(&res, "12157665459056928801"), "3^40");
+    superlong_from_int(&base, -2);
+    superlong_pow_ui(&base, 3, &res);
+    TEST_ASSERT(compare_with_string(&res, "-8"), "(-2)^3");
+    superlong_from_uint(&base, 0);
+    superlong_pow_ui(&base, 0, &res);
+    TEST_ASSERT(compare_with_string(&res, "1"), "0^0 = 1");
+    
+    const char* path = "build/test-factorial.ckpt";
+    remove(path);
+    superlong_exec exec;
+    superlong_exec_init(&exec, test_cancel_halfway, NULL);
+    superlong_from_uint(&res, 7);
+    TEST_ASSERT(superlong_factorial_checkpoint(&exec, 4000, path, 0, &res) == -1, "Interrupted factorial");
+    FILE* file = fopen(path, "rb");
+    TEST_ASSERT(file != NULL && compare_with_string(&res, "7"), "Interrupted run leaves a checkpoint");
+    if (file)
+        fclose(file);
+    
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4001, path, 0, &res) == -1, "Checkpoint of another task is refused");
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4000, path, 0, &res) == 0, "Resumed factorial completes");
+    superlong_factorial(4000, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Resumed factorial result");
+    file = fopen(path, "rb");
+    TEST_ASSERT(file == NULL, "Checkpoint removed after completion");
+    if (file)
+        fclose(file);
+    
+    // damaged checkpoints are refused and left alone
+    const uint32_t tags[2] = {0, 0};
+    superlong_from_uint(&expected, 720);
+    superlong_from_uint(&res, 7);
+    test_write_factorial_ckpt(path, 4000, 4002, 0, tags, &expected);
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4000, path, 0, &res) == -1, "Progress beyond n is refused");
+    test_write_factorial_ckpt(path, 4000, 3000, 0, tags, &expected);
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4000, path, 0, &res) == -1, "Progress without products is refused");
+    test_write_factorial_ckpt(path, 4000, 3000, 2, tags, &expected);
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4000, path, 0, &res) == -1, "Equal counter levels are refused");
+    test_write_factorial_ckpt(path, 4000, 3000, 1, tags, &expected);
+    file = fopen(path, "r+b");
+    fseek(file, 40 + 4 + 15, SEEK_SET); // top byte of the record's digit count
+    fputc(0x10, file);
+    fclose(file);
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 4000, path, 0, &res) == -1 && compare_with_string(&res, "7"),
+                "Corrupted record is refused");
+    file = fopen(path, "rb");
+    TEST_ASSERT(file != NULL, "Damaged checkpoint is left in place");
+    if (file)
+        fclose(file);
+    test_write_factorial_ckpt(path, 10, 7, 1, tags, &expected); // 2 * 3 * ... * 6 = 720 done
+    TEST_ASSERT(superlong_factorial_checkpoint(NULL, 10, path, 0, &res) == 0 && compare_with_string(&res, "3628800"),
+                "Hand-written checkpoint resumes");
+    
+    path = "build/test-pow.ckpt";
+    remove(path);
+    superlong_from_uint(&base, 12345);
+    superlong_exec_init(&exec, test_cancel_halfway, NULL);
+    TEST_ASSERT(superlong_pow_ui_checkpoint(&exec, &base, 301, path, 0, &res) == -1, "Interrupted power");
+    superlong_from_uint(&base, 12346);
+    TEST_ASSERT(superlong_pow_ui_checkpoint(NULL, &base, 301, path, 0, &res) == -1, "Checkpoint of another base is refused");
+    superlong_from_uint(&base, 12345);
+    TEST_ASSERT(superlong_pow_ui_checkpoint(NULL, &base, 301, path, 0, &res) == 0, "Resumed power completes");
+    superlong_pow_ui(&base, 301, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Resumed power result");
+    
+    path = "build/test-series.ckpt";
+    remove(path);
+    uint64_t shift = 0, other = 1;
+    superlong_series s, plain;
+    superlong_series_init(&s);
+    superlong_series_init(&plain);
+    superlong_exec_init(&exec, test_cancel_halfway, NULL);
+    TEST_ASSERT(superlong_series_eval_checkpoint(&exec, test_ratio_term, &shift, 5, 3000, path, 0, &s) == -1 &&
+                    superlong_is_zero(&s.q),
+                "Interrupted series");
+    file = fopen(path, "rb");
+    TEST_ASSERT(file != NULL, "Interrupted series leaves a checkpoint");
+    if (file)
+        fclose(file);
+    TEST_ASSERT(superlong_series_eval_checkpoint(NULL, test_ratio_term, &shift, 6, 3000, path, 0, &s) == -1,
+                "Checkpoint of another range is refused");
+    TEST_ASSERT(superlong_series_eval_checkpoint(NULL, test_ratio_term, &other, 5, 3000, path, 0, &s) == -1,
+                "Checkpoint of another series is refused");
+    TEST_ASSERT(superlong_series_eval_checkpoint(NULL, test_ratio_term, &shift, 5, 3000, path, 0, &s) == 0,
+                "Resumed series completes");
+    superlong_series_eval(test_ratio_term, &shift, 5, 3000, &plain);
+    TEST_ASSERT(superlong_compare(&s.p, &plain.p) == 0 && superlong_compare(&s.q, &plain.q) == 0 &&
+                    superlong_compare(&s.t, &plain.t) == 0,
+                "Resumed series matches the in-memory P, Q and T");
+    file = fopen(path, "rb");
+    TEST_ASSERT(file == NULL, "Series checkpoint removed after completion");
+    if (file)
+        fclose(file);
+    superlong_series_deinit(&s);
+    superlong_series_deinit(&plain);
+    
+    path = "build/test-pi.ckpt";
+    remove(path);
+    superlong_exec_init(&exec, test_cancel_halfway, NULL);
+    superlong_from_uint(&res, 7);
+    TEST_ASSERT(superlong_const_pi_checkpoint(&exec, 3000, path, 0, &res) == -1 && compare_with_string(&res, "7"),
+                "Interrupted pi");
+    TEST_ASSERT(superlong_const_pi_checkpoint(NULL, 3000, path, 0, &res) == 0, "Resumed pi completes");
+    superlong_const_pi(3000, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Resumed pi digits");
+    
+    superlong_deinit(&base);
+    superlong_deinit(&res);
+    superlong_deinit(&expected);
+}
+
+static int test_collect(void* ctx, const char* data, size_t len) {
+    char* out = ctx;
+    strncat(out, data, len);
+    return 0;
+}
+
+void test_out_of_core() {
+    printf(COLOR_YELLOW "\n=== Testing Out-of-Core Operands ===" COLOR_RESET "\n");
+    
+    size_t budget = superlong_ooc_get_budget();
+    superlong_ooc_set_budget(8 * 4096); // one-page blocks and windows split the operands
+    
+    superlong a, b, res, expected;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&res);
+    superlong_init(&expected);
+    uint8_t bytes[5000];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        seed = seed * 1103515245u + 12345u;
+        bytes[i] = (uint8_t) (seed >> 16);
+    }
+    superlong_import(&a, sizeof(bytes), -1, 1, 0, bytes);
+    superlong_import(&b, 3000, -1, 1, 0, bytes + 1000);
+    superlong_negate(&b);
+    
+    superlong_ooc fa, fb, fr;
+    TEST_ASSERT(superlong_ooc_open(&fa, "build/test-ooc-a.bin", 1) == 0, "Create out-of-core files");
+    superlong_ooc_open(&fb, "build/test-ooc-b.bin", 1);
+    superlong_ooc_open(&fr, "build/test-ooc-r.bin", 1);
+    superlong_ooc_set(&fa, &a);
+    superlong_ooc_set(&fb, &b);
+    superlong_ooc_get(&fb, &res);
+    TEST_ASSERT(superlong_compare(&res, &b) == 0, "Out-of-core round trip");
+    
+    superlong_ooc_add(&fa, &fb, &fr);
+    superlong_ooc_get(&fr, &res);
+    superlong_add(&a, &b, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Out-of-core add");
+    
+    superlong_ooc_sub(&fb, &fa, &fr);
+    superlong_ooc_get(&fr, &res);
+    superlong_sub(&b, &a, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Out-of-core sub");
+    
+    superlong_ooc_sub(&fa, &fa, &fa);
+    TEST_ASSERT(fa.sign == 0 && fa.len == 0, "Out-of-core a - a in place");
+    superlong_ooc_set(&fa, &a);
+    
+    TEST_ASSERT(superlong_ooc_mul(&fa, &fb, &fr) == 0, "Out-of-core mul");
+    superlong_ooc_get(&fr, &res);
+    superlong_mul(&a, &b, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Out-of-core mul result");
+    
+    superlong_ooc_set(&fb, &a);
+    superlong_import(&b, 700, -1, 1, 0, bytes + 3000);
+    superlong_ooc_set(&fa, &b);
+    TEST_ASSERT(superlong_ooc_mul(&fb, &fa, &fr) == 0, "Out-of-core mul by a short operand");
+    superlong_ooc_get(&fr, &res);
+    superlong_mul(&a, &b, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Out-of-core short mul result");
+    superlong_import(&b, 3000, -1, 1, 0, bytes + 1000);
+    superlong_negate(&b);
+    superlong_ooc_set(&fa, &a);
+    superlong_ooc_set(&fb, &b);
+    superlong_ooc_mul(&fa, &fb, &fr);
+    superlong_mul(&a, &b, &expected);
+    
+    char* bin = superlong_to_str(&expected, 2);
+    char* out = calloc(strlen(bin) + 1, 1);
+    TEST_ASSERT(superlong_ooc_out_sink(test_collect, out, 2, &fr) == 0 && strcmp(out, bin) == 0,
+                "Out-of-core binary output");
+    free(bin);
+    free(out);
+    
+    superlong_ooc_set_budget(4 * 4096); // the product is past a quarter of the budget
+    char* dec = superlong_to_str(&expected, 10);
+    out = calloc(strlen(dec) + 1, 1);
+    TEST_ASSERT(superlong_ooc_out_sink(test_collect, out, 10, &fr) == 0 && strcmp(out, dec) == 0,
+                "Out-of-core decimal output");
+    free(dec);
+    free(out);
+    
+    superlong_ooc_close(&fa);
+    superlong_ooc_close(&fb);
+    superlong_ooc_close(&fr);
+    remove("build/test-ooc-a.bin");
+    remove("build/test-ooc-b.bin");
+    remove("build/test-ooc-r.bin");
+    superlong_ooc_set_budget(budget);
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&res);
+    superlong_deinit(&expected);
+}
+
+static void test_halves_term(void* ctx, uint64_t k, superlong* p, superlong* q, superlong* a) {
+    (void) ctx;
+    (void) k;
+    superlong_from_uint(p, 1);
+    superlong_from_uint(q, 2);
+    superlong_from_uint(a, 1);
+}
+
+void test_series() {
+    printf(COLOR_YELLOW "\n=== Testing Series and Constants ===" COLOR_RESET "\n");
+    
+    superlong a, b, res, expected;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&res);
+    superlong_init(&expected);
+    
+    // sum of 2^-(n + 1) for n < 100 = (2^100 - 1) / 2^100, split over two threads
+    unsigned threads = superlong_get_threads();
+    superlong_set_threads(2);
+    superlong_series s;
+    superlong_series_init(&s);
+    superlong_series_eval(test_halves_term, NULL, 0, 100, &s);
+    superlong_from_uint(&expected, 1);
+    superlong_shl(&expected, 100);
+    TEST_ASSERT(superlong_compare(&s.q, &expected) == 0, "Series Q = 2^100");
+    superlong_sub_uint(&expected, 1, &expected);
+    TEST_ASSERT(superlong_compare(&s.t, &expected) == 0, "Series T = 2^100 - 1");
+    TEST_ASSERT(compare_with_string(&s.p, "1"), "Series P = 1");
+    superlong_series_deinit(&s);
+    superlong_set_threads(threads);
+    
+    uint8_t bytes[900];
+    uint32_t seed = 777;
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        seed = seed * 1103515245u + 12345u;
+        bytes[i] = (uint8_t) (seed >> 16);
+    }
+    superlong_import(&a, 900, -1, 1, 0, bytes);
+    superlong_import(&b, 300, -1, 1, 0, bytes + 500);
+    superlong_negate(&b);
+    superlong_div_newton(&a, &b, &res);
+    superlong_div(&a, &b, &expected);
+    TEST_ASSERT(superlong_compare(&res, &expected) == 0, "Newton division matches long division");
+    
+    superlong_mul(&b, &b, &a);
+    superlong_sqrt(&a, &res);
+    superlong_negate(&b);
+    TEST_ASSERT(superlong_compare(&res, &b) == 0, "Square root of a perfect square");
+    superlong_sub_uint(&a, 1, &a);
+    superlong_sqrt(&a, &res);
+    superlong_sub_uint(&b, 1, &b);
+    TEST_ASSERT(superlong_compare(&res, &b) == 0, "Square root rounds down");
+    superlong_from_uint(&a, 99);
+    superlong_sqrt(&a, &res);
+    TEST_ASSERT(compare_with_string(&res, "9"), "sqrt(99) = 9");
+    
+    superlong_const_pi(60, &res);
+    TEST_ASSERT(compare_with_string(&res, "3141592653589793238462643383279502884197169399375105820974944"),
+                "Pi to 60 digits");
+    superlong_const_e(60, &res);
+    TEST_ASSERT(compare_with_string(&res, "2718281828459045235360287471352662497757247093699959574966967"),
+                "e to 60 digits");
+    superlong_const_pi(1000, &res);
+    char* str = superlong_to_str(&res, 10);
+    TEST_ASSERT(strlen(str) == 1001 && strcmp(str + 991, "2164201989") == 0, "Pi to 1000 digits");
+    free(str);
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&res);
+    superlong_deinit(&expected);
+}
+
+void test_fibonacci_binomial() {
+    printf(COLOR_YELLOW "\n=== Testing Fibonacci and Binomial Coefficients ===" COLOR_RESET "\n");
+    
+    superlong a, b, c;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&c);
+    
+    superlong_fib_ui(0, &a);
+    TEST_ASSERT(compare_with_string(&a, "0"), "F(0) = 0");
+    superlong_fib_ui(1, &a);
+    TEST_ASSERT(compare_with_string(&a, "1"), "F(1) = 1");
+    superlong_fib_ui(100, &a);
+    TEST_ASSERT(compare_with_string(&a, "354224848179261915075"), "F(100)");
+    superlong_lucas_ui(0, &a);
+    TEST_ASSERT(compare_with_string(&a, "2"), "L(0) = 2");
+    superlong_lucas_ui(100, &a);
+    TEST_ASSERT(compare_with_string(&a, "792070839848372253127"), "L(100)");
+    
+    // F(2n) = F(n) L(n)
+    superlong_fib_ui(1001, &a);
+    superlong_lucas_ui(1001, &b);
+    superlong_mul(&a, &b, &a);
+    superlong_fib_ui(2002, &b);
+    TEST_ASSERT(superlong_compare(&a, &b) == 0, "F(2002) = F(1001) L(1001)");
+    
+    superlong_bin_uiui(5, 6, &a);
+    TEST_ASSERT(compare_with_string(&a, "0"), "C(5, 6) = 0");
+    superlong_bin_uiui(7, 7, &a);
+    TEST_ASSERT(compare_with_string(&a, "1"), "C(7, 7) = 1");
+    superlong_bin_uiui(100, 50, &a);
+    TEST_ASSERT(compare_with_string(&a, "100891344545564193334812497256"), "C(100, 50)");
+    superlong_bin_uiui(1000000, 3, &a);
+    TEST_ASSERT(compare_with_string(&a, "166666166667000000"), "C(1000000, 3)");
+    
+    // C(n, k) k! (n - k)! = n!
+    superlong_bin_uiui(600, 250, &a);
+    superlong_factorial(250, &b);
+    superlong_mul(&a, &b, &a);
+    superlong_factorial(350, &b);
+    superlong_mul(&a, &b, &a);
+    superlong_factorial(600, &c);
+    TEST_ASSERT(superlong_compare(&a, &c) == 0, "C(600, 250) 250! 350! = 600!");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&c);
+}
+
+void test_primes() {
+    printf(COLOR_YELLOW "\n=== Testing Modular Powers and Primes ===" COLOR_RESET "\n");
+    
+    superlong a, b, c;
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&c);
+    
+    superlong_from_uint(&a, 4);
+    superlong_from_uint(&b, 13);
+    superlong_from_uint(&c, 497);
+    superlong_powmod(&a, &b, &c, &a);
+    TEST_ASSERT(compare_with_string(&a, "445"), "4^13 mod 497 = 445");
+    superlong_from_int(&a, -2);
+    superlong_from_uint(&b, 5);
+    superlong_from_uint(&c, 7);
+    superlong_powmod(&a, &b, &c, &a);
+    TEST_ASSERT(compare_with_string(&a, "3"), "(-2)^5 mod 7 = 3");
+    superlong_from_uint(&a, 7);
+    superlong_from_uint(&b, 1000);
+    superlong_from_str(&c, "1000000000000", 10);
+    superlong_powmod(&a, &b, &c, &a);
+    TEST_ASSERT(compare_with_string(&a, "731280600001"), "7^1000 mod 10^12 (even modulus)");
+    
+    // Fermat's little theorem for the Mersenne prime 2^127 - 1
+    superlong_from_uint(&c, 1);
+    superlong_shl(&c, 127);
+    superlong_sub_uint(&c, 1, &c);
+    superlong_sub_uint(&c, 1, &b);
+    superlong_from_uint(&a, 3);
+    superlong_powmod(&a, &b, &c, &a);
+    TEST_ASSERT(compare_with_string(&a, "1"), "3^(p - 1) mod p = 1 for p = 2^127 - 1");
+    
+    uint32_t d[3] = {7, 1000003, 4294967291u}, r[3];
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 100);
+    superlong_mod_ui_multi(&a, d, 3, r);
+    TEST_ASSERT(r[0] == 2 && r[1] == 253109 && r[2] == 2000, "2^100 mod several divisors at once");
+    
+    superlong_from_uint(&a, 2);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 2, "2 is prime");
+    superlong_from_uint(&a, 1);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 0, "1 is not prime");
+    superlong_from_uint(&a, 561);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 0, "Carmichael number 561 is composite");
+    superlong_from_int(&a, -997);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 2, "-997 is prime");
+    superlong_from_uint64(&a, 3215031751u);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 0, "Strong pseudoprime to bases 2, 3, 5, 7 is composite");
+    superlong_from_uint64(&a, 2305843009213693951u);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 2, "2^61 - 1 is prime");
+    TEST_ASSERT(superlong_probab_prime_p(&c, 25) == 1, "2^127 - 1 is probably prime");
+    
+    // 2^67 - 1 passes the base-2 strong test, the Lucas test has to catch it
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 67);
+    superlong_sub_uint(&a, 1, &a);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 25) == 0, "2^67 - 1 is composite");
+    superlong_mul(&a, &c, &a);
+    TEST_ASSERT(superlong_probab_prime_p(&a, 30) == 0, "(2^67 - 1)(2^127 - 1) is composite");
+    
+    superlong_from_uint(&a, 0);
+    superlong_nextprime(&a, &b);
+    TEST_ASSERT(compare_with_string(&b, "2"), "nextprime(0) = 2");
+    superlong_from_uint(&a, 1000);
+    superlong_nextprime(&a, &b);
+    TEST_ASSERT(compare_with_string(&b, "1009"), "nextprime(1000) = 1009");
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 128);
+    superlong_nextprime(&a, &b);
+    TEST_ASSERT(compare_with_string(&b, "340282366920938463463374607431768211507"), "nextprime(2^128) = 2^128 + 51");
+    
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&c);
+}
+
+void test_multi_exponentiation() {
+    printf(COLOR_YELLOW "\n=== Testing Multi-Exponentiation and Fixed Bases ===" COLOR_RESET "\n");
+    
+    superlong g, h, a, b, m, res;
+    superlong_init(&g);
+    superlong_init(&h);
+    superlong_init(&a);
+    superlong_init(&b);
+    superlong_init(&m);
+    superlong_init(&res);
+    const superlong* bases[2] = {&g, &h};
+    const superlong* exps[2] = {&a, &b};
+    
+    superlong_from_uint(&m, 1);
+    superlong_shl(&m, 127);
+    superlong_sub_uint(&m, 1, &m);
+    superlong_from_uint(&g, 3);
+    superlong_from_uint(&h, 5);
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 100);
+    superlong_add_uint(&a, 7, &a);
+    superlong_from_str(&b, "1000000000000000000000000000000", 10);
+    superlong_powmod_multi(bases, exps, 2, &m, &res);
+    TEST_ASSERT(compare_with_string(&res, "153174241364544871406650502506477028275"),
+                "3^(2^100 + 7) 5^(10^30) mod 2^127 - 1");
+    superlong_powmod_multi(bases, exps, 0, &m, &res);
+    TEST_ASSERT(compare_with_string(&res, "1"), "Empty product is 1");
+    
+    superlong_from_str(&m, "1000000000000", 10);
+    superlong_from_int(&h, -7);
+    superlong_from_uint(&a, 1000000);
+    superlong_from_uint(&b, 999);
+    superlong_powmod_multi(bases, exps, 2, &m, &res);
+    TEST_ASSERT(compare_with_string(&res, "659071342857"), "3^(10^6) (-7)^999 mod 10^12 (even modulus)");
+    
+    superlong_fixed_base fb;
+    superlong_from_uint(&m, 1);
+    superlong_shl(&m, 127);
+    superlong_sub_uint(&m, 1, &m);
+    superlong_from_uint(&g, 7);
+    superlong_fixed_base_init(&fb, &g, &m, 128);
+    superlong_from_uint(&a, 0);
+    superlong_fixed_base_powmod(&fb, &a, &res);
+    TEST_ASSERT(compare_with_string(&res, "1"), "7^0 from the comb table");
+    superlong_from_uint(&a, 12345);
+    superlong_fixed_base_powmod(&fb, &a, &res);
+    TEST_ASSERT(compare_with_string(&res, "113794875448983681802706610934313567341"), "7^12345 from the comb table");
+    superlong_sub_uint(&m, 1, &a);
+    superlong_fixed_base_powmod(&fb, &a, &res);
+    TEST_ASSERT(compare_with_string(&res, "1"), "7^(p - 1) from the comb table");
+    superlong_from_uint(&a, 1);
+    superlong_shl(&a, 200);
+    superlong_fixed_base_powmod(&fb, &a, &res);
+    TEST_ASSERT(compare_with_string(&res, "155307353387656834474547408165620115784"),
+                "Exponents beyond the table fall back to powmod");
+    superlong_fixed_base_deinit(&fb);
+    
+    superlong_deinit(&g);
+    superlong_deinit(&h);
+    superlong_deinit(&a);
+    superlong_deinit(&b);
+    superlong_deinit(&m);
+    superlong_deinit(&res);
+}
+
+void test_rns() {
+    printf(COLOR_YELLOW "\n=== Testing Residue Number System ===" COLOR_RESET "\n");
+    
+    superlong x, y, z, res;
+    superlong_init(&x);
+    superlong_init(&y);
+    superlong_init(&z);
+    superlong_init(&res);
+    
+    superlong_rns_basis basis;
+    superlong_rns a, b, c;
+    superlong_rns_basis_init(&basis, 300);
+    superlong_rns_init(&a, &basis, 3);
+    superlong_rns_init(&b, &basis, 3);
+    superlong_rns_init(&c, &basis, 3);
+    TEST_ASSERT(superlong_bit_length(&basis.tree[0]) > 300, "Basis covers 300 bits");
+    
+    superlong_rns_get(&a, 2, &res);
+    TEST_ASSERT(superlong_is_zero(&res), "Lanes start at zero");
+    superlong_from_str(&x, "-1234567890123456789012345678901234567890123456789", 10);
+    superlong_rns_set(&a, 0, &x);
+    superlong_rns_get(&a, 0, &res);
+    TEST_ASSERT(superlong_compare(&res, &x) == 0, "Negative value round trip");
+    superlong_from_str(&y, "98765432109876543210987654321098765432109876543210", 10);
+    superlong_rns_set(&b, 0, &y);
+    superlong_from_uint(&z, 1);
+    superlong_shl(&z, 140);
+    superlong_rns_set(&a, 1, &z);
+    superlong_rns_set(&b, 1, &z);
+    
+    superlong_rns_mul(&a, &b, &c);
+    superlong_rns_get(&c, 0, &res);
+    superlong_mul(&x, &y, &z);
+    TEST_ASSERT(superlong_compare(&res, &z) == 0, "Product of a negative and a positive lane");
+    superlong_rns_add(&c, &a, &c);
+    superlong_rns_sub(&c, &b, &c);
+    superlong_rns_get(&c, 0, &res);
+    superlong_add(&z, &x, &z);
+    superlong_sub(&z, &y, &z);
+    TEST_ASSERT(superlong_compare(&res, &z) == 0, "Aliased add and sub chain");
+    superlong_rns_get(&c, 1, &res);
+    TEST_ASSERT(compare_with_string(&res, "1942668892225729070919461906823518906642406839052139521251812409738904285205208498176"),
+                "2^140 squared");
+    
+    // M / 2 + 1 is out of range and comes back as M / 2 + 1 - M
+    superlong_copy(&basis.tree[0], &x);
+    superlong_shr(&x, 1);
+    superlong_add_uint(&x, 1, &x);
+    superlong_rns_set(&a, 2, &x);
+    superlong_rns_get(&a, 2, &res);
+    superlong_sub(&x, &basis.tree[0], &z);
+    TEST_ASSERT(superlong_compare(&res, &z) == 0, "Values beyond M / 2 wrap around");
+    
+    superlong_rns_deinit(&a);
+    superlong_rns_deinit(&b);
+    superlong_rns_deinit(&c);
+    superlong_rns_basis_deinit(&basis);
+    
+    // enough primes for the remainder and product trees to split above the word-level blocks
+    superlong_rns_basis_init(&basis, 16000);
+    superlong_rns_init(&a, &basis, 2);
+    superlong_rns_init(&c, &basis, 2);
+    superlong_from_uint(&x, 1);
+    superlong_shl(&x, 7800);
+    superlong_add_uint(&x, 12345, &x);
+    superlong_from_str(&y, "-31415926535897932384626433832795028841971693993751", 10);
+    superlong_shl(&y, 7500);
+    superlong_sub_uint(&y, 7, &y);
+    superlong_rns_set(&a, 0, &x);
+    superlong_rns_set(&a, 1, &y);
+    superlong_rns_get(&a, 1, &res);
+    TEST_ASSERT(superlong_compare(&res, &y) == 0, "Round trip through the trees");
+    superlong_rns_mul(&a, &a, &c);
+    superlong_rns_get(&c, 0, &res);
+    superlong_mul(&x, &x, &z);
+    TEST_ASSERT(superlong_compare(&res, &z) == 0, "15600-bit square through the trees");
+    superlong_rns_deinit(&a);
+    superlong_rns_deinit(&c);
+    superlong_rns_basis_deinit(&basis);
+    
+    superlong_deinit(&x);
+    superlong_deinit(&y);
+    superlong_deinit(&z);
+    superlong_deinit(&res);
+}
+
 // Test memory operations (for sanitizer validation)
 void test_memory_operations() {
     printf(COLOR_YELLOW "\n=== Testing Memory Operations ===" COLOR_RESET "\n");
@@ -521,6 +2107,29 @@ int main() {
     test_large_numbers();
     test_edge_cases();
     test_string_conversion();
+    test_bit_operations();
+    test_fused_and_64bit();
+    test_product_tree();
+    test_unbalanced_multiplication();
+    test_division_by_constants();
+    test_serialization();
+    test_views();
+    test_streaming_output();
+    test_radix_conversion();
+    test_batch_operations();
+    test_fixed_width();
+    test_accumulator();
+    test_stats();
+    test_alloc_profile();
+    test_shared_values();
+    test_cancellable_operations();
+    test_checkpoints();
+    test_out_of_core();
+    test_series();
+    test_fibonacci_binomial();
+    test_primes();
+    test_multi_exponentiation();
+    test_rns();
     test_memory_operations();
     
     // Print summary